@@ -0,0 +1,215 @@
+/**
+ * Benchmark for the products with the feature matrix φ(x') needed in every
+ * evaluation of the loss. Compares the naive products on a vector of feature
+ * vectors with the dense kernels of Features for each instruction set
+ * supported by this machine, and with sparse Features.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <util/ProgramOptions.h>
+#include <util/Logger.h>
+
+#include <loss/Features.h>
+#include <loss/FeatureKernels.h>
+
+using namespace logger;
+
+util::ProgramOption optionNumComponents(
+		util::_long_name        = "numComponents",
+		util::_description_text = "The number of components of y, i.e., the number of feature vectors.",
+		util::_default_value    = 20000);
+
+util::ProgramOption optionNumFeatures(
+		util::_long_name        = "numFeatures",
+		util::_description_text = "The number of features per feature vector.",
+		util::_default_value    = 1000);
+
+util::ProgramOption optionFeatureDensity(
+		util::_long_name        = "featureDensity",
+		util::_description_text = "The fraction of non-zero features.",
+		util::_default_value    = 1.0);
+
+util::ProgramOption optionDensity(
+		util::_long_name        = "density",
+		util::_description_text = "The fraction of components of y that are 1.",
+		util::_default_value    = 0.1);
+
+util::ProgramOption optionRepetitions(
+		util::_long_name        = "repetitions",
+		util::_description_text = "How often to repeat each product.",
+		util::_default_value    = 20);
+
+double
+seconds(std::clock_t start) {
+
+	return static_cast<double>(std::clock() - start)/CLOCKS_PER_SEC;
+}
+
+double
+maxDifference(const std::vector<double>& a, const std::vector<double>& b) {
+
+	double diff = 0;
+	for (unsigned int i = 0; i < a.size(); i++)
+		diff = std::max(diff, std::abs(a[i] - b[i]));
+
+	return diff;
+}
+
+int main(int optionc, char** optionv) {
+
+	try {
+
+		util::ProgramOptions::init(optionc, optionv);
+		LogManager::init();
+
+		unsigned int numComponents  = optionNumComponents;
+		unsigned int numFeatures    = optionNumFeatures;
+		double       featureDensity = optionFeatureDensity;
+		double       density        = optionDensity;
+		unsigned int repetitions    = optionRepetitions;
+
+		std::srand(42);
+
+		// the same features as vector of vectors, dense, and sparse Features
+		std::vector<std::vector<double> > naive(numComponents, std::vector<double>(numFeatures, 0.0));
+		Features features;
+		Features sparseFeatures;
+
+		for (unsigned int i = 0; i < numComponents; i++) {
+
+			std::vector<unsigned int> indices;
+			std::vector<double>       values;
+
+			for (unsigned int j = 0; j < numFeatures; j++) {
+
+				if (static_cast<double>(std::rand())/RAND_MAX >= featureDensity)
+					continue;
+
+				naive[i][j] = static_cast<double>(std::rand())/RAND_MAX - 0.5;
+				indices.push_back(j);
+				values.push_back(naive[i][j]);
+			}
+
+			features.addFeatureVector(naive[i]);
+			sparseFeatures.addSparseFeatureVector(indices, values);
+		}
+
+		sparseFeatures.setNumFeatures(numFeatures);
+
+		std::vector<double> w(numFeatures);
+		for (unsigned int j = 0; j < numFeatures; j++)
+			w[j] = static_cast<double>(std::rand())/RAND_MAX - 0.5;
+
+		std::vector<double> y(numComponents);
+		for (unsigned int i = 0; i < numComponents; i++)
+			y[i] = (static_cast<double>(std::rand())/RAND_MAX < density ? 1.0 : 0.0);
+
+		LOG_USER(out)
+				<< "[main] " << numComponents << " feature vectors with "
+				<< numFeatures << " features (" << sparseFeatures.numEntries() << " non-zeros), "
+				<< repetitions << " repetitions" << std::endl;
+
+		// naive products as reference
+
+		std::vector<double> fNaive(numComponents);
+		std::vector<double> eNaive(numFeatures);
+
+		std::clock_t start = std::clock();
+		for (unsigned int r = 0; r < repetitions; r++) {
+
+			std::fill(fNaive.begin(), fNaive.end(), 0.0);
+			for (unsigned int i = 0; i < numComponents; i++)
+				for (unsigned int j = 0; j < numFeatures; j++)
+					fNaive[i] += w[j]*naive[i][j];
+		}
+		double coefficientsNaive = seconds(start);
+
+		start = std::clock();
+		for (unsigned int r = 0; r < repetitions; r++) {
+
+			std::fill(eNaive.begin(), eNaive.end(), 0.0);
+			for (unsigned int i = 0; i < numComponents; i++)
+				for (unsigned int j = 0; j < numFeatures; j++)
+					eNaive[j] += y[i]*naive[i][j];
+		}
+		double combineNaive = seconds(start);
+
+		LOG_USER(out)
+				<< "[main] naive:\twφ(x') " << coefficientsNaive/repetitions*1000 << "ms"
+				<< "\tφ(x')y " << combineNaive/repetitions*1000 << "ms" << std::endl;
+
+		FeatureKernels::InstructionSet instructionSets[] = {
+
+				FeatureKernels::Scalar,
+				FeatureKernels::Avx2,
+				FeatureKernels::Avx512
+		};
+
+		std::vector<double> f(numComponents);
+		std::vector<double> e(numFeatures);
+
+		for (unsigned int k = 0; k < 3; k++) {
+
+			FeatureKernels::InstructionSet instructionSet = instructionSets[k];
+
+			if (!FeatureKernels::supported(instructionSet)) {
+
+				LOG_USER(out) << "[main] " << FeatureKernels::name(instructionSet) << ":\tnot supported" << std::endl;
+				continue;
+			}
+
+			start = std::clock();
+			for (unsigned int r = 0; r < repetitions; r++)
+				FeatureKernels::coefficients(
+						features.getFeatureVector(0), numComponents, numFeatures, features.getStride(),
+						&w[0], &f[0], instructionSet);
+			double coefficients = seconds(start);
+
+			start = std::clock();
+			for (unsigned int r = 0; r < repetitions; r++) {
+
+				std::fill(e.begin(), e.end(), 0.0);
+				FeatureKernels::accumulate(
+						features.getFeatureVector(0), numComponents, numFeatures, features.getStride(),
+						&y[0], &e[0], instructionSet);
+			}
+			double combine = seconds(start);
+
+			LOG_USER(out)
+					<< "[main] " << FeatureKernels::name(instructionSet) << ":"
+					<< "\twφ(x') " << coefficients/repetitions*1000 << "ms"
+					<< " (" << coefficientsNaive/coefficients << "x)"
+					<< "\tφ(x')y " << combine/repetitions*1000 << "ms"
+					<< " (" << combineNaive/combine << "x)"
+					<< "\tmax error " << std::max(maxDifference(f, fNaive), maxDifference(e, eNaive))
+					<< std::endl;
+		}
+
+		start = std::clock();
+		for (unsigned int r = 0; r < repetitions; r++)
+			sparseFeatures.getCoefficients(w, f);
+		double coefficientsSparse = seconds(start);
+
+		start = std::clock();
+		for (unsigned int r = 0; r < repetitions; r++)
+			sparseFeatures.combineFeatures(y, e);
+		double combineSparse = seconds(start);
+
+		LOG_USER(out)
+				<< "[main] sparse:"
+				<< "\twφ(x') " << coefficientsSparse/repetitions*1000 << "ms"
+				<< " (" << coefficientsNaive/coefficientsSparse << "x)"
+				<< "\tφ(x')y " << combineSparse/repetitions*1000 << "ms"
+				<< " (" << combineNaive/combineSparse << "x)"
+				<< "\tmax error " << std::max(maxDifference(f, fNaive), maxDifference(e, eNaive))
+				<< std::endl;
+
+	} catch (Exception& e) {
+
+		handleException(e, std::cerr);
+	}
+}
@@ -0,0 +1,152 @@
+/**
+ * Benchmark for the loss-augmented inference, i.e., the binary linear
+ * programs solved in every evaluation of the loss. Generates problems with
+ * "at most one" constraints on groups of variables and conflicting pairs of
+ * variables, and solves them repeatedly with slightly changed objectives, like
+ * the bundle method does. The backend is selected with --inference.backend.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <time.h>
+#include <boost/scoped_ptr.hpp>
+#include <util/ProgramOptions.h>
+#include <util/Logger.h>
+
+#include <inference/DefaultFactory.h>
+#include <inference/LinearSolverBackend.h>
+
+using namespace logger;
+
+util::ProgramOption optionNumVariables(
+		util::_long_name        = "numVariables",
+		util::_description_text = "The number of binary variables, i.e., the number of components of y.",
+		util::_default_value    = 2000);
+
+util::ProgramOption optionGroupSize(
+		util::_long_name        = "groupSize",
+		util::_description_text = "The number of variables per \"at most one\" constraint.",
+		util::_default_value    = 10);
+
+util::ProgramOption optionNumConflicts(
+		util::_long_name        = "numConflicts",
+		util::_description_text = "The number of random pairs of variables that can not both be 1.",
+		util::_default_value    = 500);
+
+util::ProgramOption optionPerturbation(
+		util::_long_name        = "perturbation",
+		util::_description_text = "The magnitude of the changes of the objective between repetitions.",
+		util::_default_value    = 0.01);
+
+util::ProgramOption optionRepetitions(
+		util::_long_name        = "repetitions",
+		util::_description_text = "How often to solve with a changed objective.",
+		util::_default_value    = 20);
+
+// the wall-clock time in seconds, std::clock() would add up the CPU time of
+// all threads of the backend
+double
+now() {
+
+	timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+
+	return t.tv_sec + t.tv_nsec*1e-9;
+}
+
+double
+uniform(double min, double max) {
+
+	return min + (max - min)*static_cast<double>(std::rand())/RAND_MAX;
+}
+
+int main(int optionc, char** optionv) {
+
+	try {
+
+		util::ProgramOptions::init(optionc, optionv);
+		LogManager::init();
+
+		unsigned int numVariables = optionNumVariables;
+		unsigned int groupSize    = std::max(1, optionGroupSize.as<int>());
+		unsigned int numConflicts = optionNumConflicts;
+		double       perturbation = optionPerturbation;
+		unsigned int repetitions  = optionRepetitions;
+
+		std::srand(42);
+
+		LinearConstraints constraints;
+
+		for (unsigned int begin = 0; begin < numVariables; begin += groupSize) {
+
+			for (unsigned int i = begin; i < std::min(begin + groupSize, numVariables); i++)
+				constraints.addCoefficient(i, 1.0);
+			constraints.finishConstraint(LessEqual, 1.0);
+		}
+
+		for (unsigned int k = 0; k < numConflicts && numVariables > 1; k++) {
+
+			unsigned int i = std::rand()%numVariables;
+			unsigned int j = (i + 1 + std::rand()%(numVariables - 1))%numVariables;
+
+			constraints.addCoefficient(i, 1.0);
+			constraints.addCoefficient(j, 1.0);
+			constraints.finishConstraint(LessEqual, 1.0);
+		}
+
+		LinearObjective objective(numVariables);
+		objective.setSense(Maximize);
+		for (unsigned int i = 0; i < numVariables; i++)
+			objective.setCoefficient(i, uniform(-0.5, 1.0));
+
+		LOG_USER(out)
+				<< "[main] " << numVariables << " variables, " << constraints.size()
+				<< " constraints, " << repetitions << " repetitions" << std::endl;
+
+		boost::scoped_ptr<LinearSolverBackend> solver(DefaultFactory().createLinearSolverBackend());
+
+		solver->initialize(numVariables, Binary);
+		solver->setConstraints(constraints);
+		solver->setAbsoluteGap(0);
+
+		Solution    solution;
+		double      value = 0;
+		std::string message;
+
+		double first = 0;
+		double total = 0;
+
+		for (unsigned int r = 0; r <= repetitions; r++) {
+
+			if (r > 0)
+				for (unsigned int i = 0; i < numVariables; i++)
+					objective.setCoefficient(i, objective.getCoefficients()[i] + uniform(-perturbation, perturbation));
+
+			solver->setObjective(objective);
+
+			double start = now();
+			if (!solver->solve(solution, value, message))
+				LOG_ERROR(out) << "[main] " << message << std::endl;
+			double time = now() - start;
+
+			LOG_DEBUG(out) << "[main] value " << value << ", " << message << std::endl;
+
+			if (r == 0)
+				first = time;
+			else
+				total += time;
+		}
+
+		LOG_USER(out)
+				<< "[main] first solve " << first*1000 << "ms"
+				<< "\trepeated solves " << (repetitions > 0 ? total/repetitions*1000 : 0) << "ms"
+				<< "\tlast value " << value << std::endl;
+
+	} catch (Exception& e) {
+
+		handleException(e, std::cerr);
+	}
+}
+
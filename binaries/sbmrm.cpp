@@ -2,22 +2,21 @@
  * structured bmrm main file. Initializes all objects.
  */
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
-#include <pipeline/Process.h>
-#include <pipeline/Value.h>
+#include <limits>
 #include <util/ProgramOptions.h>
 #include <util/Logger.h>
 #include <util/helpers.hpp>
 #include <util/timing.h>
 
 #include <bundle/BundleMethod.h>
-#include <loss/HammingCostFunction.h>
-#include <loss/FileLinearCostFunction.h>
+#include <loss/LabelingGradientStore.h>
 #include <loss/SoftMarginLoss.h>
-#include <loss/io/FeaturesReader.h>
-#include <loss/io/GroundTruthReader.h>
-#include <inference/io/ConstraintsReader.h>
+#include <loss/SoftMarginLossSum.h>
+#include <loss/io/DatasetReader.h>
+#include <loss/io/SampleLoader.h>
 
 using namespace logger;
 
@@ -36,6 +35,32 @@ util::ProgramOption optionConstraintsFile(
 		util::_description_text = "File containing the constraints on the labels.",
 		util::_default_value    = "constraints.txt");
 
+util::ProgramOption optionDatasetFile(
+		util::_long_name        = "datasetFile",
+		util::_description_text = "File listing the labels, features, constraints, and (optionally) linear costs files of "
+		                          "several training samples, one sample per line. If given, the options for the files of a "
+		                          "single sample are ignored.");
+
+util::ProgramOption optionNumThreads(
+		util::_long_name        = "numThreads",
+		util::_description_text = "The number of threads to evaluate the losses of the training samples. The default (0) "
+		                          "uses all available CPUs. The ILP solvers of the samples evaluated concurrently share the "
+		                          "CPUs.",
+		util::_default_value    = 0);
+
+util::ProgramOption optionMultiCut(
+		util::_long_name        = "multiCut",
+		util::_description_text = "Approximate the loss of each training sample by its own lower bound in the bundle method, "
+		                          "instead of approximating the summed loss. This adds one hyperplane per sample and iteration, "
+		                          "but usually needs fewer iterations if there are several samples.");
+
+util::ProgramOption optionCompressBundle(
+		util::_long_name        = "compressBundle",
+		util::_description_text = "Keep the hyperplanes of the bundle as the labelings y* they were found for, instead of as "
+		                          "dense gradients. This needs one bit per component of y instead of one double per feature "
+		                          "and hyperplane, at the cost of computing products with the features whenever a hyperplane "
+		                          "is added. Not supported with the QP backend.");
+
 util::ProgramOption optionWeightsOutFile(
 		util::_long_name	= "weightsOutputFile",
 		util::_description_text = "File the computet optimal weights are written to.",
@@ -59,6 +84,21 @@ util::ProgramOption optionOptimizerGap(
 		util::_description_text = "The optimality criterion for stopping the bundle method.",
 		util::_default_value    = 1e-5);
 
+util::ProgramOption optionCheckpointFile(
+		util::_long_name        = "checkpointFile",
+		util::_description_text = "Periodically write the state of the bundle method to this file, to be able to continue "
+		                          "with --resumeFrom after a crash.");
+
+util::ProgramOption optionCheckpointInterval(
+		util::_long_name        = "checkpointInterval",
+		util::_description_text = "The number of iterations of the bundle method between two checkpoints.",
+		util::_default_value    = 10);
+
+util::ProgramOption optionResumeFrom(
+		util::_long_name        = "resumeFrom",
+		util::_description_text = "Continue the bundle method from a checkpoint file written by a previous run on the same "
+		                          "training samples.");
+
 int main(int optionc, char** optionv) {
 
 	UTIL_TIME_SCOPE("main");
@@ -77,31 +117,133 @@ int main(int optionc, char** optionv) {
 
 		LOG_USER(out) << "[main] starting..." << std::endl;
 
-		pipeline::Process<ConstraintsReader> constraintsReader(optionConstraintsFile.as<std::string>());
-		pipeline::Process<FeaturesReader>    featuresReader(optionFeaturesFile.as<std::string>(), optionNormalizeFeatures.as<bool>());
-		pipeline::Process<GroundTruthReader> groundTruthReader(optionLabelsFile.as<std::string>());
+		std::vector<SampleFiles> sampleFiles;
+
+		if (optionDatasetFile) {
+
+			sampleFiles = DatasetReader(optionDatasetFile.as<std::string>()).getSampleFiles();
 
-		// get them read
-		pipeline::Value<LinearConstraints>    constraints = constraintsReader->getOutput();
-		pipeline::Value<Features>             features    = featuresReader->getOutput();
-		pipeline::Value<std::vector<double> > groundTruth = groundTruthReader->getOutput();
+		} else {
 
-		boost::shared_ptr<LinearCostFunction> costs;
+			SampleFiles files;
+			files.labels      = optionLabelsFile.as<std::string>();
+			files.features    = optionFeaturesFile.as<std::string>();
+			files.constraints = optionConstraintsFile.as<std::string>();
+			if (optionLinearCostsFile)
+				files.linearCosts = optionLinearCostsFile.as<std::string>();
+
+			sampleFiles.push_back(files);
+		}
 
-		if (!optionLinearCostsFile)
-			costs = boost::make_shared<HammingCostFunction>(*groundTruth);
-		else
-			costs = boost::make_shared<FileLinearCostFunction>(optionLinearCostsFile.as<std::string>());
+		if (sampleFiles.size() == 0) {
 
-		SoftMarginLoss loss(*costs, constraints, features, groundTruth);
+			LOG_ERROR(out) << "[main] no training samples given" << std::endl;
+			return 1;
+		}
+
+		// get them read, all files at the same time
+		std::vector<boost::shared_ptr<Sample> > samples = SampleLoader().load(sampleFiles);
+
+		unsigned int numFeatures = 0;
+		foreach (boost::shared_ptr<Sample> sample, samples)
+			numFeatures = std::max(numFeatures, sample->features->numFeatures());
+
+		// sparse features only know their largest index, extend them to the
+		// common number of features
+		foreach (boost::shared_ptr<Sample> sample, samples)
+			if (sample->features->isSparse())
+				sample->features->setNumFeatures(numFeatures);
+
+		foreach (boost::shared_ptr<Sample> sample, samples)
+			if (sample->features->numFeatures() != numFeatures)
+				BOOST_THROW_EXCEPTION(
+						SizeMismatchError() <<
+						error_message("all training samples need to have the same number of features"));
+
+		LOG_USER(out) << "[main] read " << samples.size() << " training samples" << std::endl;
+
+		// all samples have to be normalized in the same way
+		if (optionNormalizeFeatures) {
+
+			std::vector<double> min(numFeatures, std::numeric_limits<double>::max());
+			std::vector<double> max(numFeatures, std::numeric_limits<double>::min());
+
+			foreach (boost::shared_ptr<Sample> sample, samples)
+				sample->features->updateRange(min, max);
+			foreach (boost::shared_ptr<Sample> sample, samples)
+				sample->features->normalize(min, max);
+		}
 
-		BundleMethod::callback_t callback = boost::bind(&SoftMarginLoss::valueAndGradient, &loss, _1, _2, _3);
-		BundleMethod bundleMethod(callback, features->numFeatures(), optionRegularizerWeight, optionOptimizerGap);
+		SoftMarginLossSum loss(optionNumThreads.as<unsigned int>());
+
+		foreach (boost::shared_ptr<Sample> sample, samples)
+			loss.addSample(
+					boost::make_shared<SoftMarginLoss>(
+							boost::ref(*sample->costs),
+							sample->constraints,
+							sample->features,
+							sample->groundTruth));
+
+		double lambda = optionRegularizerWeight;
+		double eps    = optionOptimizerGap;
+
+		boost::shared_ptr<BundleMethod> bundleMethod;
+
+		if (optionMultiCut) {
+
+			BundleMethod::multi_callback_t callback = boost::bind(&SoftMarginLossSum::valuesAndGradients, &loss, _1, _2, _3);
+			bundleMethod = boost::make_shared<BundleMethod>(callback, loss.numSamples(), numFeatures, lambda, eps);
+
+			BundleMethod::inexact_multi_callback_t inexactCallback = boost::bind(&SoftMarginLossSum::inexactValuesAndGradients, &loss, _1, _2, _3, _4, _5);
+			bundleMethod->setInexactCallback(inexactCallback);
+
+			BundleMethod::multi_approximate_callback_t approximateCallback = boost::bind(&SoftMarginLossSum::approximateValuesAndGradients, &loss, _1, _2, _3);
+			bundleMethod->setApproximateCallback(approximateCallback);
+
+		} else {
+
+			BundleMethod::callback_t callback = boost::bind(&SoftMarginLossSum::valueAndGradient, &loss, _1, _2, _3);
+			bundleMethod = boost::make_shared<BundleMethod>(callback, numFeatures, lambda, eps);
+
+			BundleMethod::inexact_callback_t inexactCallback = boost::bind(&SoftMarginLossSum::inexactValueAndGradient, &loss, _1, _2, _3, _4, _5);
+			bundleMethod->setInexactCallback(inexactCallback);
+
+			BundleMethod::approximate_callback_t approximateCallback = boost::bind(&SoftMarginLossSum::approximateValueAndGradient, &loss, _1, _2, _3);
+			bundleMethod->setApproximateCallback(approximateCallback);
+		}
+
+		if (optionCompressBundle)
+			bundleMethod->setGradientStore(boost::make_shared<LabelingGradientStore>(boost::ref(loss), optionMultiCut.as<bool>()));
+
+		if (optionCheckpointFile)
+			bundleMethod->setCheckpointFile(
+					optionCheckpointFile.as<std::string>(),
+					optionCheckpointInterval.as<unsigned int>());
+
+		if (optionResumeFrom)
+			bundleMethod->resumeFrom(optionResumeFrom.as<std::string>());
+
+		std::vector<double> w = bundleMethod->optimize();
+
+		unsigned int numSolvedInClosedForm = 0;
+		unsigned int numSolvedByRelaxation = 0;
+		unsigned int numSolvedByIlp        = 0;
+
+		for (unsigned int s = 0; s < loss.numSamples(); s++) {
+
+			numSolvedInClosedForm += loss.getSample(s).getNumSolvedInClosedForm();
+			numSolvedByRelaxation += loss.getSample(s).getNumSolvedByRelaxation();
+			numSolvedByIlp        += loss.getSample(s).getNumSolvedByIlp();
+		}
 
-		std::vector<double> w = bundleMethod.optimize();
+		if (numSolvedInClosedForm + numSolvedByRelaxation > 0)
+			LOG_USER(out)
+					<< "[main] maximizers found in closed form: " << numSolvedInClosedForm
+					<< ", by the linear relaxation: " << numSolvedByRelaxation
+					<< ", by the ILP: " << numSolvedByIlp << std::endl;
 
 		if (optionNormalizeFeatures)
-			features->normalize(w);
+			samples[0]->features->normalize(w);
 
 		LOG_USER(out) << "[main] optimial w is " << w << std::endl;
 
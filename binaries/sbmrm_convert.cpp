@@ -0,0 +1,133 @@
+/**
+ * Converts the text files of training samples into binary datasets, which
+ * sbmrm can map into memory instead of parsing them (see BinaryDataset).
+ */
+
+#include <iostream>
+#include <fstream>
+#include <boost/lexical_cast.hpp>
+#include <util/ProgramOptions.h>
+#include <util/Logger.h>
+#include <util/helpers.hpp>
+
+#include <io/BinaryDataset.h>
+#include <loss/io/DatasetReader.h>
+#include <loss/io/SampleLoader.h>
+
+using namespace logger;
+
+util::ProgramOption optionLabelsFile(
+		util::_long_name        = "labelsFile",
+		util::_description_text = "File containing the ground truth labels.",
+		util::_default_value    = "labels.txt");
+
+util::ProgramOption optionFeaturesFile(
+		util::_long_name        = "featuresFile",
+		util::_description_text = "File containing the features of the training sample.",
+		util::_default_value    = "features.txt");
+
+util::ProgramOption optionConstraintsFile(
+		util::_long_name        = "constraintsFile",
+		util::_description_text = "File containing the constraints on the labels.",
+		util::_default_value    = "constraints.txt");
+
+util::ProgramOption optionLinearCostsFile(
+		util::_long_name        = "linearCostsFile",
+		util::_description_text = "File with the values for a linear cost function (optional).");
+
+util::ProgramOption optionDatasetFile(
+		util::_long_name        = "datasetFile",
+		util::_description_text = "File listing the files of several training samples, one sample per line (see sbmrm). If "
+		                          "given, each sample is converted into <outputFile>.<line>, and <outputFile> is a manifest "
+		                          "listing them.");
+
+util::ProgramOption optionOutputFile(
+		util::_long_name        = "outputFile",
+		util::_description_text = "The binary dataset to write.",
+		util::_default_value    = "dataset.sbmrm");
+
+void
+convert(const SampleFiles& files, const Sample& sample, const std::string& outputFile) {
+
+	BinaryDatasetWriter writer(outputFile);
+
+	sample.groundTruth->write(writer);
+	sample.features->write(writer);
+	sample.constraints->write(writer);
+
+	// Hamming costs are not stored
+	if (!files.linearCosts.empty()) {
+
+		std::vector<double> coefficients = sample.costs->getCoefficients();
+		double              constant     = sample.costs->getConstantOffset();
+
+		writer.add(BinaryDataset::CostCoefficients, coefficients.empty() ? 0 : &coefficients[0], coefficients.size());
+		writer.add(BinaryDataset::CostConstant, &constant, 1);
+	}
+
+	writer.finish();
+
+	LOG_USER(out)
+			<< "[main] wrote " << sample.groundTruth->size() << " labels, "
+			<< sample.features->numFeatureVectors() << " feature vectors, and "
+			<< sample.constraints->size() << " constraints to " << outputFile << std::endl;
+}
+
+int main(int optionc, char** optionv) {
+
+	try {
+
+		util::ProgramOptions::init(optionc, optionv);
+		LogManager::init();
+
+		std::string outputFile = optionOutputFile.as<std::string>();
+
+		std::vector<SampleFiles> sampleFiles;
+
+		if (optionDatasetFile) {
+
+			sampleFiles = DatasetReader(optionDatasetFile.as<std::string>()).getSampleFiles();
+
+		} else {
+
+			SampleFiles files;
+			files.labels      = optionLabelsFile.as<std::string>();
+			files.features    = optionFeaturesFile.as<std::string>();
+			files.constraints = optionConstraintsFile.as<std::string>();
+			if (optionLinearCostsFile)
+				files.linearCosts = optionLinearCostsFile.as<std::string>();
+
+			sampleFiles.push_back(files);
+		}
+
+		std::vector<boost::shared_ptr<Sample> > samples = SampleLoader().load(sampleFiles);
+
+		if (optionDatasetFile) {
+
+			// the samples are listed relative to the directory of the manifest
+			std::string name = outputFile.substr(outputFile.find_last_of('/') + 1);
+
+			std::ofstream manifest(outputFile.c_str());
+
+			for (unsigned int i = 0; i < samples.size(); i++) {
+
+				std::string suffix = "." + boost::lexical_cast<std::string>(i);
+
+				convert(sampleFiles[i], *samples[i], outputFile + suffix);
+				manifest << name << suffix << std::endl;
+			}
+
+			if (!manifest.good())
+				BOOST_THROW_EXCEPTION(BinaryDatasetError() << error_message("could not write " + outputFile));
+
+		} else {
+
+			convert(sampleFiles[0], *samples[0], outputFile);
+		}
+
+	} catch (Exception& e) {
+
+		handleException(e, std::cerr);
+		return 1;
+	}
+}
@@ -0,0 +1,748 @@
+/**
+ * Test for the bundle method. Generates small random bundles and compares the
+ * solution of the master problem found by the DualBundleSolver (and the
+ * QuadraticBundleSolver, if a quadratic solver is available) to the exact
+ * solution, found by enumerating the sets of active hyperplanes. Also
+ * minimizes random piecewise linear functions with the bundle method, with
+ * and without an interruption and resume from a checkpoint, and compares the
+ * result to the exact minimizer. Returns 1 if any result is wrong.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <boost/bind/bind.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <util/ProgramOptions.h>
+#include <util/Logger.h>
+
+#include <bundle/BundleCheckpoint.h>
+#include <bundle/BundleMethod.h>
+#include <bundle/DualBundleSolver.h>
+#include <bundle/QuadraticBundleSolver.h>
+#include <inference/DefaultFactory.h>
+
+using namespace logger;
+
+util::ProgramOption optionNumProblems(
+		util::_long_name        = "numProblems",
+		util::_description_text = "The number of random problems to solve.",
+		util::_default_value    = 1000);
+
+util::ProgramOption optionSeed(
+		util::_long_name        = "seed",
+		util::_description_text = "The seed of the random problems.",
+		util::_default_value    = 42);
+
+util::ProgramOption optionCheckpointFile(
+		util::_long_name        = "checkpointFile",
+		util::_description_text = "The file to write checkpoints of the bundle method to.",
+		util::_default_value    = "test_bundle.checkpoint");
+
+// the duality gap up to which master problems are solved
+static const double MasterEps = 1e-12;
+
+// the convergence threshold of the bundle method
+static const double BundleEps = 1e-6;
+
+// the tolerance for comparing values and solutions
+static const double Tolerance = 1e-6;
+
+// the tolerance for comparing to solutions of a quadratic solver
+static const double QpTolerance = 1e-4;
+
+// the number of wrong results
+unsigned int numFailures = 0;
+
+/**
+ * A set of hyperplanes <w,a_i> + b_i, each bounding one of numSlacks
+ * functions from below.
+ */
+struct Bundle {
+
+	unsigned int dims;
+	unsigned int numSlacks;
+
+	std::vector<std::vector<double> > a;
+	std::vector<double>               b;
+	std::vector<unsigned int>         slacks;
+};
+
+struct Interrupted {};
+
+double
+uniform(double min, double max) {
+
+	return min + (max - min)*static_cast<double>(std::rand())/RAND_MAX;
+}
+
+int
+integer(int min, int max) {
+
+	return min + std::rand()%(max - min + 1);
+}
+
+double
+dot(const std::vector<double>& a, const std::vector<double>& b) {
+
+	double d = 0;
+	for (unsigned int i = 0; i < a.size(); i++)
+		d += a[i]*b[i];
+
+	return d;
+}
+
+double
+euclideanDistance(const std::vector<double>& a, const std::vector<double>& b) {
+
+	double d = 0;
+	for (unsigned int i = 0; i < a.size(); i++)
+		d += (a[i] - b[i])*(a[i] - b[i]);
+
+	return std::sqrt(d);
+}
+
+void
+addRandomHyperplane(Bundle& bundle, unsigned int slack) {
+
+	std::vector<double> a(bundle.dims);
+	for (unsigned int i = 0; i < bundle.dims; i++)
+		a[i] = uniform(-1, 1);
+
+	bundle.a.push_back(a);
+	bundle.b.push_back(uniform(-1, 1));
+	bundle.slacks.push_back(slack);
+}
+
+/**
+ * The value of each function at w, i.e., the largest value of its
+ * hyperplanes.
+ */
+std::vector<double>
+evaluate(const Bundle& bundle, const std::vector<double>& w) {
+
+	std::vector<double> values(bundle.numSlacks, -std::numeric_limits<double>::infinity());
+
+	for (unsigned int i = 0; i < bundle.a.size(); i++)
+		values[bundle.slacks[i]] = std::max(values[bundle.slacks[i]], dot(w, bundle.a[i]) + bundle.b[i]);
+
+	return values;
+}
+
+/**
+ * The value of the master problem λ½|w|² + Σ_s max_{i∈I_s} <w,a_i> + b_i at w.
+ */
+double
+evaluate(const Bundle& bundle, double lambda, const std::vector<double>& w) {
+
+	std::vector<double> values = evaluate(bundle, w);
+
+	double value = 0.5*lambda*dot(w, w);
+	for (unsigned int s = 0; s < bundle.numSlacks; s++)
+		value += values[s];
+
+	return value;
+}
+
+/**
+ * Solve the optimality conditions of the master problem for the given set of
+ * active hyperplanes,
+ *
+ *   w = -1/λ Σ_{j∈A} α_j a_j,
+ *   <w,a_i> + b_i = ξ_s  ∀i∈A∩I_s,
+ *   Σ_{j∈A∩I_s} α_j = 1 ∀s,
+ *
+ * and check whether α ≥ 0 and no other hyperplane exceeds ξ at w.
+ */
+bool
+solveActive(const Bundle& bundle, double lambda, const std::vector<unsigned int>& active, std::vector<double>& w) {
+
+	unsigned int n = active.size();
+	unsigned int m = n + bundle.numSlacks;
+
+	// the augmented matrix of the system in α and ξ
+	std::vector<std::vector<double> > M(m, std::vector<double>(m + 1, 0.0));
+
+	for (unsigned int k = 0; k < n; k++) {
+
+		unsigned int i = active[k];
+
+		for (unsigned int l = 0; l < n; l++)
+			M[k][l] = -dot(bundle.a[i], bundle.a[active[l]])/lambda;
+		M[k][n + bundle.slacks[i]] = -1;
+		M[k][m] = -bundle.b[i];
+
+		M[n + bundle.slacks[i]][k] = 1;
+	}
+
+	for (unsigned int s = 0; s < bundle.numSlacks; s++)
+		M[n + s][m] = 1;
+
+	// Gaussian elimination with partial pivoting
+	for (unsigned int c = 0; c < m; c++) {
+
+		unsigned int pivot = c;
+		for (unsigned int r = c + 1; r < m; r++)
+			if (std::abs(M[r][c]) > std::abs(M[pivot][c]))
+				pivot = r;
+
+		if (std::abs(M[pivot][c]) < 1e-10)
+			return false;
+
+		std::swap(M[c], M[pivot]);
+
+		for (unsigned int r = 0; r < m; r++) {
+
+			if (r == c || M[r][c] == 0)
+				continue;
+
+			double f = M[r][c]/M[c][c];
+			for (unsigned int k = c; k <= m; k++)
+				M[r][k] -= f*M[c][k];
+		}
+	}
+
+	std::vector<double> x(m);
+	for (unsigned int c = 0; c < m; c++)
+		x[c] = M[c][m]/M[c][c];
+
+	w.assign(bundle.dims, 0.0);
+	for (unsigned int k = 0; k < n; k++) {
+
+		if (x[k] < -1e-9)
+			return false;
+
+		for (unsigned int d = 0; d < bundle.dims; d++)
+			w[d] -= x[k]*bundle.a[active[k]][d]/lambda;
+	}
+
+	for (unsigned int i = 0; i < bundle.a.size(); i++) {
+
+		double xi = x[n + bundle.slacks[i]];
+
+		if (dot(w, bundle.a[i]) + bundle.b[i] > xi + 1e-9*(1 + std::abs(xi)))
+			return false;
+	}
+
+	return true;
+}
+
+/**
+ * Find the exact minimizer of the master problem by trying all sets of active
+ * hyperplanes. Only sets with at most dims + numSlacks hyperplanes need to be
+ * considered, since the multipliers of the optimum can always be chosen such
+ * that the gradients of their hyperplanes (extended by the slack they belong
+ * to) are linearly independent. Returns false if no set satisfies the
+ * optimality conditions, or if a function has no hyperplane.
+ */
+bool
+solveMaster(const Bundle& bundle, double lambda, std::vector<double>& w, double& value) {
+
+	std::vector<std::vector<unsigned int> > members(bundle.numSlacks);
+	for (unsigned int i = 0; i < bundle.a.size(); i++)
+		members[bundle.slacks[i]].push_back(i);
+
+	for (unsigned int s = 0; s < bundle.numSlacks; s++)
+		if (members[s].empty() || members[s].size() > 16)
+			return false;
+
+	bool found = false;
+	value = std::numeric_limits<double>::infinity();
+
+	// a non-empty subset of the members of each slack
+	std::vector<unsigned int> masks(bundle.numSlacks, 1);
+
+	while (true) {
+
+		std::vector<unsigned int> active;
+		for (unsigned int s = 0; s < bundle.numSlacks; s++)
+			for (unsigned int k = 0; k < members[s].size(); k++)
+				if (masks[s] & (1u << k))
+					active.push_back(members[s][k]);
+
+		std::vector<double> candidate;
+		if (active.size() <= bundle.dims + bundle.numSlacks && solveActive(bundle, lambda, active, candidate)) {
+
+			double candidateValue = evaluate(bundle, lambda, candidate);
+
+			if (candidateValue < value) {
+
+				value = candidateValue;
+				w     = candidate;
+				found = true;
+			}
+		}
+
+		unsigned int s = 0;
+		for (; s < bundle.numSlacks; s++) {
+
+			if (++masks[s] < (1u << members[s].size()))
+				break;
+			masks[s] = 1;
+		}
+
+		if (s == bundle.numSlacks)
+			break;
+	}
+
+	return found;
+}
+
+void
+fail(unsigned int problem, const std::string& solver, const std::string& reason) {
+
+	LOG_ERROR(out) << "[main] problem " << problem << ", " << solver << ": " << reason << std::endl;
+	numFailures++;
+}
+
+/**
+ * Compare a solution of a master problem to the exact one. The value has to
+ * be a lower bound within eps of the optimum, and w has to be within eps of
+ * the optimum. Since the master problem is λ-strongly convex, the latter also
+ * bounds the distance of w to the exact minimizer.
+ */
+void
+checkMaster(
+		unsigned int               problem,
+		const std::string&         solver,
+		const Bundle&              bundle,
+		double                     lambda,
+		double                     eps,
+		const std::vector<double>& w,
+		double                     value) {
+
+	std::vector<double> bestW;
+	double              best;
+
+	if (!solveMaster(bundle, lambda, bestW, best)) {
+
+		fail(problem, solver, "no exact solution of the master problem found");
+		return;
+	}
+
+	double tolerance = eps + Tolerance*(1 + std::abs(best));
+
+	if (value > best + tolerance)
+		fail(problem, solver, "value is not a lower bound");
+
+	if (value < best - tolerance)
+		fail(problem, solver, "value is not optimal");
+
+	double suboptimality = evaluate(bundle, lambda, w) - best;
+
+	if (suboptimality > tolerance)
+		fail(problem, solver, "w is not optimal");
+
+	if (euclideanDistance(w, bestW) > std::sqrt(2*eps/lambda) + Tolerance*(1 + std::sqrt(dot(bestW, bestW))))
+		fail(problem, solver, "w is not the minimizer");
+}
+
+/**
+ * Compare the bundle after removing and aggregating hyperplanes to all
+ * hyperplanes that were added. The remaining hyperplanes have to be lower
+ * bounds of the same functions, and no function may have more than maxSize - 1
+ * hyperplanes.
+ */
+void
+checkLimitedBundle(
+		unsigned int       problem,
+		const std::string& solver,
+		const Bundle&      full,
+		const Bundle&      limited,
+		unsigned int       maxSize) {
+
+	if (maxSize > 0) {
+
+		std::vector<unsigned int> sizes(limited.numSlacks, 0);
+		for (unsigned int i = 0; i < limited.slacks.size(); i++)
+			sizes[limited.slacks[i]]++;
+
+		for (unsigned int s = 0; s < limited.numSlacks; s++)
+			if (sizes[s] >= maxSize)
+				fail(problem, solver, "bundle is too large");
+	}
+
+	for (unsigned int k = 0; k < 10; k++) {
+
+		std::vector<double> w(full.dims);
+		for (unsigned int d = 0; d < full.dims; d++)
+			w[d] = uniform(-10, 10);
+
+		std::vector<double> fullValues    = evaluate(full, w);
+		std::vector<double> limitedValues = evaluate(limited, w);
+
+		for (unsigned int s = 0; s < full.numSlacks; s++)
+			if (limitedValues[s] > fullValues[s] + Tolerance*(1 + std::abs(fullValues[s])))
+				fail(problem, solver, "remaining hyperplanes are not lower bounds");
+	}
+}
+
+/**
+ * Add random hyperplanes to a DualBundleSolver one by one, and compare the
+ * solution after each to the exact solution. Removing and aggregating
+ * hyperplanes must not change the minimum of the master problem, which is
+ * therefore compared to the exact solution of the remaining bundle. Finally,
+ * store the bundle in a checkpoint and solve it again after reading it.
+ */
+void
+testDualBundleSolver(unsigned int problem) {
+
+	Bundle full;
+	full.dims      = integer(1, 4);
+	full.numSlacks = integer(1, 3);
+
+	double       lambda      = std::pow(10.0, uniform(-2, 1));
+	unsigned int maxInactive = (std::rand()%2 ? integer(1, 3) : 0);
+	unsigned int maxSize     = (std::rand()%2 ? integer(2, 4) : 0);
+
+	DualBundleSolver solver(full.dims, full.numSlacks, lambda, MasterEps, maxInactive, maxSize);
+
+	std::vector<double> w(full.dims);
+	double              value = 0;
+
+	unsigned int numHyperplanes = integer(full.numSlacks, 10);
+
+	for (unsigned int i = 0; i < numHyperplanes; i++) {
+
+		addRandomHyperplane(full, (i < full.numSlacks ? i : integer(0, full.numSlacks - 1)));
+		solver.addHyperplane(full.a.back(), full.b.back(), full.slacks.back());
+
+		if (i + 1 < full.numSlacks)
+			continue;
+
+		Bundle limited = full;
+		solver.solve(w, value);
+		solver.getHyperplanes(limited.a, limited.b, limited.slacks);
+
+		if (maxInactive == 0 && maxSize == 0) {
+
+			if (limited.a.size() != full.a.size())
+				fail(problem, "DualBundleSolver", "hyperplanes were removed without limits");
+
+			checkMaster(problem, "DualBundleSolver", full, lambda, MasterEps, w, value);
+
+		} else {
+
+			checkMaster(problem, "DualBundleSolver (limited)", limited, lambda, MasterEps, w, value);
+			checkLimitedBundle(problem, "DualBundleSolver (limited)", full, limited, maxSize);
+		}
+	}
+
+	// round trip through a checkpoint
+
+	std::string filename = optionCheckpointFile.as<std::string>();
+
+	BundleCheckpoint checkpoint;
+	checkpoint.dims        = full.dims;
+	checkpoint.numSummands = full.numSlacks;
+	checkpoint.lambda      = lambda;
+	checkpoint.eps         = MasterEps;
+	checkpoint.t           = numHyperplanes;
+	checkpoint.minValue    = value;
+	checkpoint.w_b         = w;
+	checkpoint.g_b         = w;
+	checkpoint.w           = w;
+	solver.getHyperplanes(checkpoint.a, checkpoint.b, checkpoint.slacks);
+	checkpoint.write(filename);
+
+	BundleCheckpoint restored;
+	restored.read(filename, full.dims, full.numSlacks);
+
+	if (restored.dims != checkpoint.dims ||
+	    restored.numSummands != checkpoint.numSummands ||
+	    restored.lambda != checkpoint.lambda ||
+	    restored.eps != checkpoint.eps ||
+	    restored.t != checkpoint.t ||
+	    restored.minValue != checkpoint.minValue ||
+	    restored.w_b != checkpoint.w_b ||
+	    restored.g_b != checkpoint.g_b ||
+	    restored.w != checkpoint.w ||
+	    restored.a != checkpoint.a ||
+	    restored.b != checkpoint.b ||
+	    restored.slacks != checkpoint.slacks)
+		fail(problem, "BundleCheckpoint", "restored checkpoint differs");
+
+	try {
+
+		restored.read(filename, full.dims + 1, full.numSlacks);
+		fail(problem, "BundleCheckpoint", "checkpoint of different size accepted");
+
+	} catch (CheckpointError& e) {}
+
+	DualBundleSolver resumed(full.dims, full.numSlacks, lambda, MasterEps);
+	for (unsigned int i = 0; i < restored.a.size(); i++)
+		resumed.addHyperplane(restored.a[i], restored.b[i], restored.slacks[i]);
+
+	Bundle restoredBundle = full;
+	restoredBundle.a      = restored.a;
+	restoredBundle.b      = restored.b;
+	restoredBundle.slacks = restored.slacks;
+
+	resumed.solve(w, value);
+	checkMaster(problem, "DualBundleSolver (checkpoint)", restoredBundle, lambda, MasterEps, w, value);
+
+	std::remove(filename.c_str());
+}
+
+/**
+ * Same as testDualBundleSolver for the QuadraticBundleSolver, with the
+ * precision of the quadratic solver. Its aggregate hyperplane bounds the sum
+ * of all functions, which the exact solution does not support, so only
+ * inactive hyperplanes are removed.
+ */
+void
+testQuadraticBundleSolver(unsigned int problem) {
+
+	Bundle full;
+	full.dims      = integer(1, 4);
+	full.numSlacks = integer(1, 3);
+
+	double       lambda      = std::pow(10.0, uniform(-1, 1));
+	unsigned int maxInactive = (std::rand()%2 ? integer(1, 3) : 0);
+
+	QuadraticBundleSolver solver(full.dims, full.numSlacks, lambda, maxInactive);
+
+	std::vector<double> w(full.dims);
+	double              value = 0;
+
+	unsigned int numHyperplanes = integer(full.numSlacks, 10);
+
+	for (unsigned int i = 0; i < numHyperplanes; i++) {
+
+		addRandomHyperplane(full, (i < full.numSlacks ? i : integer(0, full.numSlacks - 1)));
+		solver.addHyperplane(full.a.back(), full.b.back(), full.slacks.back());
+
+		if (i + 1 < full.numSlacks)
+			continue;
+
+		Bundle limited = full;
+		solver.solve(w, value);
+		solver.getHyperplanes(limited.a, limited.b, limited.slacks);
+
+		checkMaster(problem, "QuadraticBundleSolver", limited, lambda, QpTolerance, w, value);
+		checkLimitedBundle(problem, "QuadraticBundleSolver", full, limited, 0);
+	}
+}
+
+/**
+ * The value and gradient of each function at w, counting the evaluations.
+ * Throws Interrupted after the given number of evaluations, if it is not 0.
+ */
+void
+evaluateFunctions(
+		const Bundle&                      functions,
+		unsigned int&                      numEvaluations,
+		unsigned int                       maxEvaluations,
+		std::vector<std::vector<double> >& points,
+		const std::vector<double>&         w,
+		std::vector<double>&               values,
+		std::vector<std::vector<double> >& gradients) {
+
+	if (maxEvaluations > 0 && numEvaluations == maxEvaluations)
+		throw Interrupted();
+
+	numEvaluations++;
+	points.push_back(w);
+
+	values = evaluate(functions, w);
+
+	for (unsigned int s = 0; s < functions.numSlacks; s++)
+		for (unsigned int i = 0; i < functions.a.size(); i++)
+			if (functions.slacks[i] == s && dot(w, functions.a[i]) + functions.b[i] == values[s]) {
+
+				gradients[s] = functions.a[i];
+				break;
+			}
+}
+
+/**
+ * Same as above for the sum of all functions.
+ */
+void
+evaluateSum(
+		const Bundle&                      functions,
+		unsigned int&                      numEvaluations,
+		std::vector<std::vector<double> >& points,
+		const std::vector<double>&         w,
+		double&                            value,
+		std::vector<double>&               gradient) {
+
+	std::vector<double>               values(functions.numSlacks);
+	std::vector<std::vector<double> > gradients(functions.numSlacks);
+
+	evaluateFunctions(functions, numEvaluations, 0, points, w, values, gradients);
+
+	value = 0;
+	std::fill(gradient.begin(), gradient.end(), 0.0);
+	for (unsigned int s = 0; s < functions.numSlacks; s++) {
+
+		value += values[s];
+		for (unsigned int d = 0; d < functions.dims; d++)
+			gradient[d] += gradients[s][d];
+	}
+}
+
+/**
+ * Minimize λ½|w|² + Σ_s L_s(w) for random piecewise linear functions L_s with
+ * the bundle method, which has to end within ε of the exact minimizer (the
+ * solution of the master problem with all pieces as hyperplanes). Every
+ * other problem uses one lower bound for the sum. Every fourth problem is
+ * interrupted after a random number of evaluations and resumed from the last
+ * checkpoint, which has to continue at the next point the interrupted run
+ * would have evaluated and end within ε of the minimizer as well.
+ */
+void
+testBundleMethod(unsigned int problem) {
+
+	Bundle functions;
+	functions.dims      = integer(1, 4);
+	functions.numSlacks = integer(1, 3);
+
+	for (unsigned int s = 0; s < functions.numSlacks; s++)
+		for (int k = integer(1, 4); k > 0; k--)
+			addRandomHyperplane(functions, s);
+
+	double lambda = std::pow(10.0, uniform(-1, 1));
+
+	std::vector<double> bestW;
+	double              best;
+
+	if (!solveMaster(functions, lambda, bestW, best)) {
+
+		fail(problem, "BundleMethod", "no exact minimizer found");
+		return;
+	}
+
+	bool multiCut = (problem%2 == 0);
+
+	unsigned int                      numEvaluations = 0;
+	std::vector<std::vector<double> > points;
+
+	boost::scoped_ptr<BundleMethod> bundleMethod;
+	if (multiCut)
+		bundleMethod.reset(new BundleMethod(
+				boost::bind(&evaluateFunctions, boost::cref(functions), boost::ref(numEvaluations), 0, boost::ref(points), _1, _2, _3),
+				functions.numSlacks,
+				functions.dims,
+				lambda,
+				BundleEps));
+	else
+		bundleMethod.reset(new BundleMethod(
+				boost::bind(&evaluateSum, boost::cref(functions), boost::ref(numEvaluations), boost::ref(points), _1, _2, _3),
+				functions.dims,
+				lambda,
+				BundleEps));
+
+	std::vector<double> w = bundleMethod->optimize();
+
+	// the lower bound at w is at most ε below the minimum, and strong
+	// convexity of the lower bound bounds the distance to the minimizer
+	double tolerance = std::sqrt(2*BundleEps/lambda) + Tolerance*(1 + std::sqrt(dot(bestW, bestW)));
+
+	if (euclideanDistance(w, bestW) > tolerance)
+		fail(problem, "BundleMethod", "result is not the minimizer");
+
+	if (!multiCut || problem%4 != 0 || numEvaluations < 2)
+		return;
+
+	std::string filename = optionCheckpointFile.as<std::string>();
+
+	unsigned int interruptAfter = integer(1, numEvaluations - 1);
+
+	numEvaluations = 0;
+	points.clear();
+
+	BundleMethod interrupted(
+			boost::bind(&evaluateFunctions, boost::cref(functions), boost::ref(numEvaluations), interruptAfter, boost::ref(points), _1, _2, _3),
+			functions.numSlacks,
+			functions.dims,
+			lambda,
+			BundleEps);
+	interrupted.setCheckpointFile(filename, 1);
+
+	try {
+
+		interrupted.optimize();
+		fail(problem, "BundleMethod (interrupted)", "was not interrupted");
+		return;
+
+	} catch (Interrupted& i) {}
+
+	BundleCheckpoint checkpoint;
+	checkpoint.read(filename, functions.dims, functions.numSlacks);
+
+	numEvaluations = 0;
+	points.clear();
+
+	BundleMethod resumed(
+			boost::bind(&evaluateFunctions, boost::cref(functions), boost::ref(numEvaluations), 0, boost::ref(points), _1, _2, _3),
+			functions.numSlacks,
+			functions.dims,
+			lambda,
+			BundleEps);
+	resumed.resumeFrom(filename);
+
+	w = resumed.optimize();
+
+	if (points.empty() || points.front() != checkpoint.w)
+		fail(problem, "BundleMethod (resumed)", "did not continue at the point of the checkpoint");
+
+	if (euclideanDistance(w, bestW) > tolerance)
+		fail(problem, "BundleMethod (resumed)", "result is not the minimizer");
+
+	std::remove(filename.c_str());
+}
+
+bool
+haveQuadraticSolver() {
+
+	try {
+
+		boost::scoped_ptr<QuadraticSolverBackend> backend(DefaultFactory().createQuadraticSolverBackend());
+		return true;
+
+	} catch (NoSolverException& e) {
+
+		return false;
+	}
+}
+
+int main(int optionc, char** optionv) {
+
+	try {
+
+		util::ProgramOptions::init(optionc, optionv);
+		LogManager::init();
+
+		unsigned int numProblems = optionNumProblems;
+
+		std::srand(optionSeed.as<unsigned int>());
+
+		bool quadratic = haveQuadraticSolver();
+
+		if (!quadratic)
+			LOG_USER(out) << "[main] no quadratic solver available, QuadraticBundleSolver is not tested" << std::endl;
+
+		for (unsigned int p = 0; p < numProblems; p++) {
+
+			testDualBundleSolver(p);
+
+			if (quadratic)
+				testQuadraticBundleSolver(p);
+
+			testBundleMethod(p);
+		}
+
+		LOG_USER(out) << "[main] " << numProblems << " problems, " << numFailures << " failures" << std::endl;
+
+	} catch (Exception& e) {
+
+		handleException(e, std::cerr);
+		return 1;
+	}
+
+	return (numFailures == 0 ? 0 : 1);
+}
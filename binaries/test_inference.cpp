@@ -0,0 +1,446 @@
+/**
+ * Test for the solvers of binary linear programs. Generates small random
+ * problems, solves them with the dual simplex, the closed form solver,
+ * branch-and-bound, dynamic programming, the decomposition, and the backend
+ * created by the DefaultFactory (see --inference.backend), and compares the
+ * results to the optimum found by enumerating all solutions. Returns 1 if any
+ * result is wrong.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <boost/function.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <util/ProgramOptions.h>
+#include <util/Logger.h>
+
+#include <inference/BranchAndBoundBackend.h>
+#include <inference/ClosedFormSolver.h>
+#include <inference/DecomposingBackend.h>
+#include <inference/DefaultFactory.h>
+#include <inference/DualSimplex.h>
+#include <inference/DynamicProgrammingBackend.h>
+
+using namespace logger;
+
+util::ProgramOption optionNumProblems(
+		util::_long_name        = "numProblems",
+		util::_description_text = "The number of random problems to solve.",
+		util::_default_value    = 2000);
+
+util::ProgramOption optionMaxVariables(
+		util::_long_name        = "maxVariables",
+		util::_description_text = "The largest number of variables of a problem. All 2^n solutions are enumerated.",
+		util::_default_value    = 12);
+
+util::ProgramOption optionSeed(
+		util::_long_name        = "seed",
+		util::_description_text = "The seed of the random problems.",
+		util::_default_value    = 42);
+
+// the tolerance for comparing values of solutions
+static const double Tolerance = 1e-6;
+
+// the number of wrong results
+unsigned int numFailures = 0;
+
+double
+uniform(double min, double max) {
+
+	return min + (max - min)*static_cast<double>(std::rand())/RAND_MAX;
+}
+
+int
+integer(int min, int max) {
+
+	return min + std::rand()%(max - min + 1);
+}
+
+Relation
+randomRelation() {
+
+	switch (std::rand()%3) {
+
+		case 0:  return LessEqual;
+		case 1:  return Equal;
+		default: return GreaterEqual;
+	}
+}
+
+/**
+ * Constraints with random small integer coefficients on random variables.
+ */
+void
+addRandomConstraints(unsigned int n, LinearConstraints& constraints) {
+
+	unsigned int m = integer(0, 6);
+
+	for (unsigned int j = 0; j < m; j++) {
+
+		for (unsigned int i = 0; i < n; i++)
+			if (uniform(0, 1) < 0.4)
+				constraints.addCoefficient(i, integer(-3, 3));
+
+		constraints.finishConstraint(randomRelation(), integer(-1, 3));
+	}
+}
+
+/**
+ * Bounds on the number of ones in disjoint groups of variables, which the
+ * closed form solver handles.
+ */
+void
+addGroupConstraints(unsigned int n, LinearConstraints& constraints) {
+
+	std::vector<unsigned int> variables(n);
+	for (unsigned int i = 0; i < n; i++)
+		variables[i] = i;
+	std::random_shuffle(variables.begin(), variables.end());
+
+	unsigned int begin = 0;
+
+	while (begin < n && std::rand()%4 != 0) {
+
+		unsigned int end   = begin + integer(1, n - begin);
+		double       scale = integer(1, 2)*(std::rand()%2 ? 1 : -1);
+
+		for (unsigned int i = begin; i < end; i++)
+			constraints.addCoefficient(variables[i], scale);
+		constraints.finishConstraint(randomRelation(), scale*integer(0, end - begin));
+
+		begin = end;
+	}
+}
+
+/**
+ * Short constraints on nearby variables, which have a small treewidth and
+ * split into several components.
+ */
+void
+addLocalConstraints(unsigned int n, LinearConstraints& constraints) {
+
+	unsigned int m = integer(0, n);
+
+	for (unsigned int j = 0; j < m; j++) {
+
+		unsigned int first = std::rand()%n;
+		unsigned int size  = integer(1, 3);
+
+		for (unsigned int k = 0; k < size; k++)
+			constraints.addCoefficient((first + k)%n, integer(-2, 2));
+
+		constraints.finishConstraint(randomRelation(), integer(-1, 2));
+	}
+}
+
+bool
+isFeasible(const LinearConstraints& constraints, const std::vector<double>& x) {
+
+	for (unsigned int j = 0; j < constraints.size(); j++) {
+
+		double sum = 0;
+		for (size_t k = constraints.getRowStart(j); k < constraints.getRowStart(j + 1); k++)
+			sum += constraints.getCoefficients()[k]*x[constraints.getVariables()[k]];
+
+		double b = constraints.getValue(j);
+
+		switch (constraints.getRelation(j)) {
+
+			case LessEqual:    if (sum > b + Tolerance) return false; break;
+			case GreaterEqual: if (sum < b - Tolerance) return false; break;
+			case Equal:        if (std::abs(sum - b) > Tolerance) return false; break;
+		}
+	}
+
+	return true;
+}
+
+double
+evaluate(const LinearObjective& objective, const std::vector<double>& x) {
+
+	double value = objective.getConstant();
+	for (unsigned int i = 0; i < x.size(); i++)
+		value += objective.getCoefficients()[i]*x[i];
+
+	return value;
+}
+
+/**
+ * Find the optimal value by enumerating all solutions. Returns false if the
+ * problem is infeasible.
+ */
+bool
+enumerate(unsigned int n, const LinearConstraints& constraints, const LinearObjective& objective, double& best) {
+
+	double sense = (objective.getSense() == Maximize ? 1.0 : -1.0);
+	bool   found = false;
+
+	std::vector<double> x(n);
+
+	for (unsigned long mask = 0; mask < (1ul << n); mask++) {
+
+		for (unsigned int i = 0; i < n; i++)
+			x[i] = (mask >> i)&1;
+
+		if (!isFeasible(constraints, x))
+			continue;
+
+		double value = evaluate(objective, x);
+
+		if (!found || sense*value > sense*best)
+			best = value;
+		found = true;
+	}
+
+	return found;
+}
+
+void
+fail(unsigned int problem, const std::string& solver, const std::string& reason) {
+
+	LOG_ERROR(out) << "[main] problem " << problem << ", " << solver << ": " << reason << std::endl;
+	numFailures++;
+}
+
+/**
+ * The linear relaxation is a bound on the optimum, and equal to it if its
+ * solution is integral.
+ */
+void
+testDualSimplex(
+		unsigned int             problem,
+		unsigned int             n,
+		const LinearConstraints& constraints,
+		const LinearObjective&   objective,
+		bool                     feasible,
+		double                   best) {
+
+	double sense = (objective.getSense() == Maximize ? 1.0 : -1.0);
+
+	// the simplex minimizes
+	std::vector<double> costs(n);
+	for (unsigned int i = 0; i < n; i++)
+		costs[i] = -sense*objective.getCoefficients()[i];
+
+	DualSimplex simplex(n, constraints);
+	simplex.setCosts(costs);
+
+	DualSimplex::Status status = simplex.solve(std::numeric_limits<double>::infinity());
+
+	if (status == DualSimplex::IterationLimit)
+		return;
+
+	if (status != DualSimplex::Optimal) {
+
+		if (feasible)
+			fail(problem, "DualSimplex", "relaxation of a feasible problem not solved");
+		return;
+	}
+
+	std::vector<double> x(n);
+	bool integral = true;
+	for (unsigned int i = 0; i < n; i++) {
+
+		x[i] = simplex.getSolution(i);
+		integral &= (std::abs(x[i] - std::floor(x[i] + 0.5)) <= Tolerance);
+	}
+
+	double value = evaluate(objective, x);
+
+	if (std::abs(value - (objective.getConstant() - sense*simplex.getValue())) > Tolerance)
+		fail(problem, "DualSimplex", "value does not match the solution");
+
+	if (!isFeasible(constraints, x))
+		fail(problem, "DualSimplex", "solution violates the constraints");
+
+	if (feasible && sense*value < sense*best - Tolerance)
+		fail(problem, "DualSimplex", "relaxation is not a bound");
+
+	if (integral && (!feasible || std::abs(value - best) > Tolerance))
+		fail(problem, "DualSimplex", "integral solution is not optimal");
+}
+
+void
+testClosedFormSolver(
+		unsigned int             problem,
+		unsigned int             n,
+		const LinearConstraints& constraints,
+		const LinearObjective&   objective,
+		bool                     feasible,
+		double                   best) {
+
+	ClosedFormSolver solver(n, constraints);
+
+	if (!solver.isApplicable())
+		return;
+
+	if (!feasible) {
+
+		fail(problem, "ClosedFormSolver", "applicable to an infeasible problem");
+		return;
+	}
+
+	std::vector<char> y;
+	double value = solver.solve(objective, y);
+
+	std::vector<double> x(y.begin(), y.end());
+
+	if (!isFeasible(constraints, x))
+		fail(problem, "ClosedFormSolver", "solution violates the constraints");
+
+	if (std::abs(value - evaluate(objective, x)) > Tolerance)
+		fail(problem, "ClosedFormSolver", "value does not match the solution");
+
+	if (std::abs(value - best) > Tolerance)
+		fail(problem, "ClosedFormSolver", "solution is not optimal");
+}
+
+/**
+ * The solution of a backend has to be within the gap of the optimum, and its
+ * bound has to be valid.
+ */
+void
+testBackend(
+		unsigned int             problem,
+		const std::string&       name,
+		LinearSolverBackend&     backend,
+		unsigned int             n,
+		const LinearConstraints& constraints,
+		const LinearObjective&   objective,
+		double                   gap,
+		bool                     feasible,
+		double                   best) {
+
+	double sense = (objective.getSense() == Maximize ? 1.0 : -1.0);
+
+	backend.initialize(n, Binary);
+	backend.setConstraints(constraints);
+	backend.setObjective(objective);
+	backend.setAbsoluteGap(gap);
+
+	Solution    solution;
+	double      value;
+	std::string message;
+
+	if (!backend.solve(solution, value, message)) {
+
+		if (feasible)
+			fail(problem, name, "feasible problem not solved: " + message);
+		return;
+	}
+
+	if (!feasible) {
+
+		fail(problem, name, "infeasible problem solved");
+		return;
+	}
+
+	std::vector<double> x(n);
+	for (unsigned int i = 0; i < n; i++)
+		x[i] = solution[i];
+
+	if (!isFeasible(constraints, x))
+		fail(problem, name, "solution violates the constraints");
+
+	if (std::abs(value - evaluate(objective, x)) > Tolerance)
+		fail(problem, name, "value does not match the solution");
+
+	// the relative gap of the branch-and-bound is at most 1e-4 by default
+	double tolerance = gap + 1e-4*std::abs(best) + Tolerance;
+
+	if (sense*value < sense*best - tolerance)
+		fail(problem, name, "solution is not within the gap");
+
+	if (sense*solution.getBound() < sense*best - Tolerance)
+		fail(problem, name, "bound is not valid");
+}
+
+LinearSolverBackend*
+createBranchAndBound() {
+
+	return new BranchAndBoundBackend();
+}
+
+LinearSolverBackend*
+createDynamicProgramming() {
+
+	return new DynamicProgrammingBackend(new BranchAndBoundBackend());
+}
+
+int main(int optionc, char** optionv) {
+
+	try {
+
+		util::ProgramOptions::init(optionc, optionv);
+		LogManager::init();
+
+		unsigned int numProblems  = optionNumProblems;
+		unsigned int maxVariables = std::min(20, std::max(1, optionMaxVariables.as<int>()));
+
+		std::srand(optionSeed.as<unsigned int>());
+
+		unsigned int numFeasible = 0;
+
+		for (unsigned int p = 0; p < numProblems; p++) {
+
+			unsigned int n = integer(1, maxVariables);
+
+			LinearConstraints constraints;
+
+			switch (p%3) {
+
+				case 0:  addRandomConstraints(n, constraints); break;
+				case 1:  addGroupConstraints(n, constraints); break;
+				default: addLocalConstraints(n, constraints); break;
+			}
+
+			LinearObjective objective(n);
+			objective.setSense(std::rand()%2 ? Maximize : Minimize);
+			objective.setConstant(uniform(-1, 1));
+			for (unsigned int i = 0; i < n; i++)
+				objective.setCoefficient(i, uniform(-1, 1));
+
+			// every other problem with a gap, within which solutions are
+			// accepted
+			double gap = (p%2 ? uniform(0, 1) : 0);
+
+			double best     = 0;
+			bool   feasible = enumerate(n, constraints, objective, best);
+
+			if (feasible)
+				numFeasible++;
+
+			testDualSimplex(p, n, constraints, objective, feasible, best);
+			testClosedFormSolver(p, n, constraints, objective, feasible, best);
+
+			BranchAndBoundBackend     branchAndBound;
+			DynamicProgrammingBackend dynamicProgramming(new BranchAndBoundBackend());
+			DecomposingBackend        decomposition(createBranchAndBound);
+			DecomposingBackend        decomposedDynamicProgramming(createDynamicProgramming);
+
+			testBackend(p, "BranchAndBoundBackend", branchAndBound, n, constraints, objective, gap, feasible, best);
+			testBackend(p, "DynamicProgrammingBackend", dynamicProgramming, n, constraints, objective, gap, feasible, best);
+			testBackend(p, "DecomposingBackend", decomposition, n, constraints, objective, gap, feasible, best);
+			testBackend(p, "DecomposingBackend (dp)", decomposedDynamicProgramming, n, constraints, objective, gap, feasible, best);
+
+			// the selected backend, e.g., Gurobi or HiGHS
+			boost::scoped_ptr<LinearSolverBackend> selected(DefaultFactory().createLinearSolverBackend());
+			testBackend(p, "DefaultFactory", *selected, n, constraints, objective, gap, feasible, best);
+		}
+
+		LOG_USER(out)
+				<< "[main] " << numProblems << " problems (" << numFeasible << " feasible), "
+				<< numFailures << " failures" << std::endl;
+
+	} catch (Exception& e) {
+
+		handleException(e, std::cerr);
+		return 1;
+	}
+
+	return (numFailures == 0 ? 0 : 1);
+}
+
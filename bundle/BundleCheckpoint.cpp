@@ -0,0 +1,189 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include <util/Logger.h>
+#include "BundleCheckpoint.h"
+
+logger::LogChannel bundlecheckpointlog("bundlecheckpointlog", "[BundleCheckpoint] ");
+
+static const char         Magic[8] = { 'S', 'B', 'M', 'R', 'M', 'C', 'K', 'P' };
+static const unsigned int Version  = 1;
+
+template <typename T>
+static void
+writeValue(std::ostream& out, const T& value) {
+
+	out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+static void
+readValue(std::istream& in, T& value) {
+
+	in.read(reinterpret_cast<char*>(&value), sizeof(T));
+}
+
+static void
+writeVector(std::ostream& out, const std::vector<double>& v) {
+
+	if (!v.empty())
+		out.write(reinterpret_cast<const char*>(&v[0]), v.size()*sizeof(double));
+}
+
+static void
+readVector(std::istream& in, std::vector<double>& v, unsigned int size) {
+
+	v.resize(size);
+	if (size > 0)
+		in.read(reinterpret_cast<char*>(&v[0]), size*sizeof(double));
+}
+
+void
+BundleCheckpoint::write(const std::string& filename) const {
+
+	std::string tmpFilename = filename + ".tmp";
+
+	std::ofstream out(tmpFilename.c_str(), std::ios::binary | std::ios::trunc);
+
+	if (!out.good())
+		BOOST_THROW_EXCEPTION(CheckpointError() << error_message(std::string("can not open ") + tmpFilename));
+
+	/*
+	  magic, version
+	  dims, numSummands, λ, ε
+	  t, minValue, w_b, g_b, w
+	  #hyperplanes, [slack, b, a]*
+	*/
+
+	out.write(Magic, sizeof(Magic));
+	writeValue(out, Version);
+
+	writeValue(out, dims);
+	writeValue(out, numSummands);
+	writeValue(out, lambda);
+	writeValue(out, eps);
+
+	writeValue(out, t);
+	writeValue(out, minValue);
+	writeVector(out, w_b);
+	writeVector(out, g_b);
+	writeVector(out, w);
+
+	unsigned int numHyperplanes = a.size();
+	writeValue(out, numHyperplanes);
+	for (unsigned int i = 0; i < numHyperplanes; i++) {
+
+		writeValue(out, slacks[i]);
+		writeValue(out, b[i]);
+		writeVector(out, a[i]);
+	}
+
+	out.close();
+
+	if (out.fail())
+		BOOST_THROW_EXCEPTION(CheckpointError() << error_message(std::string("could not write ") + tmpFilename));
+
+	if (std::rename(tmpFilename.c_str(), filename.c_str()) != 0)
+		BOOST_THROW_EXCEPTION(CheckpointError() << error_message(std::string("could not move ") + tmpFilename + " to " + filename));
+
+	LOG_DEBUG(bundlecheckpointlog)
+			<< "wrote checkpoint of iteration " << t << " with "
+			<< numHyperplanes << " hyperplanes to " << filename << std::endl;
+}
+
+void
+BundleCheckpoint::read(const std::string& filename, unsigned int expectedDims, unsigned int expectedNumSummands) {
+
+	std::ifstream in(filename.c_str(), std::ios::binary);
+
+	if (!in.good())
+		BOOST_THROW_EXCEPTION(CheckpointError() << error_message(std::string("can not open ") + filename));
+
+	in.seekg(0, std::ios::end);
+	std::streamoff fileSize = in.tellg();
+	in.seekg(0, std::ios::beg);
+
+	char         magic[sizeof(Magic)];
+	unsigned int version = 0;
+
+	in.read(magic, sizeof(magic));
+	readValue(in, version);
+
+	if (!in.good() || std::memcmp(magic, Magic, sizeof(Magic)) != 0)
+		BOOST_THROW_EXCEPTION(CheckpointError() << error_message(filename + " is not a checkpoint file"));
+
+	if (version != Version)
+		BOOST_THROW_EXCEPTION(
+				CheckpointError() << error_message(
+						filename + " has version " + boost::lexical_cast<std::string>(version) +
+						", expected " + boost::lexical_cast<std::string>(Version)));
+
+	readValue(in, dims);
+	readValue(in, numSummands);
+	readValue(in, lambda);
+	readValue(in, eps);
+
+	if (!in.good())
+		BOOST_THROW_EXCEPTION(CheckpointError() << error_message(filename + " is truncated"));
+
+	// check the sizes before anything is allocated for them
+	if (dims != expectedDims || numSummands != expectedNumSummands)
+		BOOST_THROW_EXCEPTION(
+				CheckpointError() << error_message(
+						filename + " was written for " +
+						boost::lexical_cast<std::string>(dims) + " dimensions and " +
+						boost::lexical_cast<std::string>(numSummands) + " summands, expected " +
+						boost::lexical_cast<std::string>(expectedDims) + " and " +
+						boost::lexical_cast<std::string>(expectedNumSummands)));
+
+	readValue(in, t);
+	readValue(in, minValue);
+	readVector(in, w_b, dims);
+	readVector(in, g_b, dims);
+	readVector(in, w, dims);
+
+	unsigned int numHyperplanes = 0;
+	readValue(in, numHyperplanes);
+
+	if (!in.good())
+		BOOST_THROW_EXCEPTION(CheckpointError() << error_message(filename + " is truncated"));
+
+	std::streamoff hyperplaneSize = sizeof(unsigned int) + (1 + static_cast<std::streamoff>(dims))*sizeof(double);
+
+	if (numHyperplanes > (fileSize - in.tellg())/hyperplaneSize)
+		BOOST_THROW_EXCEPTION(CheckpointError() << error_message(filename + " is truncated"));
+
+	a.clear();
+	b.clear();
+	slacks.clear();
+
+	a.reserve(numHyperplanes);
+	b.reserve(numHyperplanes);
+	slacks.reserve(numHyperplanes);
+
+	for (unsigned int i = 0; i < numHyperplanes; i++) {
+
+		unsigned int        slack;
+		double              offset;
+		std::vector<double> gradient;
+
+		readValue(in, slack);
+		readValue(in, offset);
+		readVector(in, gradient, dims);
+
+		if (!in.good())
+			break;
+
+		slacks.push_back(slack);
+		b.push_back(offset);
+		a.push_back(gradient);
+	}
+
+	if (a.size() != numHyperplanes)
+		BOOST_THROW_EXCEPTION(CheckpointError() << error_message(filename + " is truncated"));
+
+	LOG_DEBUG(bundlecheckpointlog)
+			<< "read checkpoint of iteration " << t << " with "
+			<< numHyperplanes << " hyperplanes from " << filename << std::endl;
+}
@@ -0,0 +1,60 @@
+#ifndef SBMRM_BUNDLE_BUNDLE_CHECKPOINT_H__
+#define SBMRM_BUNDLE_BUNDLE_CHECKPOINT_H__
+
+#include <string>
+#include <vector>
+
+#include <util/exceptions.h>
+
+struct CheckpointError : virtual Exception {};
+
+/**
+ * The state of a BundleMethod after an iteration, sufficient to continue the
+ * optimization without evaluating the objective at any of the previous
+ * points again.
+ *
+ * Checkpoints are stored in a compact binary format in the native byte order
+ * of the machine. A checkpoint is written to a temporary file first and then
+ * renamed, such that a crash while writing leaves the previous checkpoint
+ * intact.
+ */
+struct BundleCheckpoint {
+
+	// the configuration of the bundle method
+	unsigned int dims;
+	unsigned int numSummands;
+	double       lambda;
+	double       eps;
+
+	// the number of completed iterations
+	unsigned int t;
+
+	// the smallest value of the objective seen so far, where it was observed,
+	// and the gradient of the objective there
+	double              minValue;
+	std::vector<double> w_b;
+	std::vector<double> g_b;
+
+	// the minimizer of the lower bound, i.e., the next point to evaluate
+	std::vector<double> w;
+
+	// the hyperplanes of the lower bound
+	std::vector<std::vector<double> > a;
+	std::vector<double>               b;
+	std::vector<unsigned int>         slacks;
+
+	/**
+	 * Write this checkpoint to the given file.
+	 */
+	void write(const std::string& filename) const;
+
+	/**
+	 * Replace this checkpoint with the content of the given file. Throws a
+	 * CheckpointError if the file is truncated or was written for a different
+	 * number of dimensions or summands.
+	 */
+	void read(const std::string& filename, unsigned int expectedDims, unsigned int expectedNumSummands);
+};
+
+#endif // SBMRM_BUNDLE_BUNDLE_CHECKPOINT_H__
+
@@ -5,27 +5,46 @@ BundleCollector::BundleCollector() {
 	registerOutput(_constraints, "linear constraints");
 
 	_constraints.registerForwardSlot(_constraintAdded);
+	_constraints.registerForwardSlot(_modified);
 }
 
 void
-BundleCollector::addHyperplane(std::vector<double>& a, double b) {
+BundleCollector::addHyperplane(const std::vector<double>& a, double b, unsigned int slack) {
 	/*
-	  <w,a> + b ≤  ξ
+	  <w,a> + b ≤  ξ_s
 	        <=>
-	  <w,a> - ξ ≤ -b
+	  <w,a> - ξ_s ≤ -b
 	*/
 
 	unsigned int dims = a.size();
 
-	LinearConstraint constraint;
-
 	for (unsigned int i = 0; i < dims; i++)
-		constraint.setCoefficient(i, a[i]);
-	constraint.setCoefficient(dims, -1.0);
-	constraint.setRelation(LessEqual);
-	constraint.setValue(-b);
+		_constraints->addCoefficient(i, a[i]);
+	_constraints->addCoefficient(dims + slack, -1.0);
+	_constraints->finishConstraint(LessEqual, -b);
+
+	_constraintAdded();
+}
+
+void
+BundleCollector::addAggregateHyperplane(const std::vector<double>& a, double b, unsigned int numSlacks) {
+
+	unsigned int dims = a.size();
 
-	_constraints->add(constraint);
+	for (unsigned int i = 0; i < dims; i++)
+		_constraints->addCoefficient(i, a[i]);
+	for (unsigned int s = 0; s < numSlacks; s++)
+		_constraints->addCoefficient(dims + s, -1.0);
+	_constraints->finishConstraint(LessEqual, -b);
 
 	_constraintAdded();
 }
+
+void
+BundleCollector::removeHyperplanes(const std::vector<bool>& remove) {
+
+	_constraints->remove(remove);
+
+	// the QP has to be set up again
+	_modified();
+}
@@ -13,13 +13,28 @@ public:
 
 	BundleCollector();
 
-	void addHyperplane(std::vector<double>& a, double b);
+	/**
+	 * Add the hyperplane <w,a> + b ≤ ξ_slack.
+	 */
+	void addHyperplane(const std::vector<double>& a, double b, unsigned int slack = 0);
+
+	/**
+	 * Add the hyperplane <w,a> + b ≤ Σ_s ξ_s, which bounds the sum of all
+	 * numSlacks slack variables.
+	 */
+	void addAggregateHyperplane(const std::vector<double>& a, double b, unsigned int numSlacks);
+
+	/**
+	 * Remove all hyperplanes i with remove[i] == true.
+	 */
+	void removeHyperplanes(const std::vector<bool>& remove);
 
 private:
 
 	pipeline::Output<LinearConstraints> _constraints;
 
-	signals::Slot<ConstraintAdded> _constraintAdded;
+	signals::Slot<ConstraintAdded>    _constraintAdded;
+	signals::Slot<pipeline::Modified> _modified;
 };
 
 #endif // SBMRM_BUNDLE_COLLECTOR_H__
@@ -1,9 +1,15 @@
 #include <limits>
 
+#include <boost/bind/bind.hpp>
+#include <boost/make_shared.hpp>
+
 #include <util/helpers.hpp>
 #include <util/Logger.h>
 #include <util/ProgramOptions.h>
+#include <util/timing.h>
 #include "BundleMethod.h"
+#include "DualBundleSolver.h"
+#include "QuadraticBundleSolver.h"
 
 logger::LogChannel bundlelog("bundlelog", "[BundleMethod] ");
 
@@ -11,13 +17,84 @@ util::ProgramOption optionOutputPrecision(
 		util::_long_name        = "outputPrecision",
 		util::_description_text = "The decimal precision of printed numbers in the bundle method.");
 
+util::ProgramOption optionUseQpBackend(
+		util::_long_name        = "useQpBackend",
+		util::_description_text = "Solve the bundle master problem in its primal form with the quadratic solver backend (e.g., Gurobi), "
+		                          "instead of using the built-in dual solver.");
+
+util::ProgramOption optionMaxInactiveIterations(
+		util::_long_name        = "maxInactiveIterations",
+		util::_description_text = "Remove hyperplanes from the bundle that did not support the lower bound for this many "
+		                          "consecutive iterations. The default (0) keeps all hyperplanes.",
+		util::_default_value    = 0);
+
+util::ProgramOption optionMaxBundleSize(
+		util::_long_name        = "maxBundleSize",
+		util::_description_text = "The maximal number of hyperplanes in the bundle (at least 2). If reached, hyperplanes are "
+		                          "aggregated into a single one. The default (0) does not limit the bundle size.",
+		util::_default_value    = 0);
+
+util::ProgramOption optionLineSearch(
+		util::_long_name        = "lineSearch",
+		util::_description_text = "Perform a line search between the best solution so far and the minimizer of the lower bound "
+		                          "in each iteration (LS-BMRM). The points evaluated during the line search add hyperplanes to "
+		                          "the lower bound as well.");
+
+util::ProgramOption optionLineSearchEvaluations(
+		util::_long_name        = "lineSearchEvaluations",
+		util::_description_text = "The maximal number of additional evaluations of the objective per line search.",
+		util::_default_value    = 3);
+
+util::ProgramOption optionOracleTolerance(
+		util::_long_name        = "oracleTolerance",
+		util::_description_text = "Evaluate the objective only up to this fraction of the current gap ε_t of the bundle "
+		                          "method, if the objective supports it (e.g., by stopping the ILP solver early). The bound "
+		                          "proven by the solver is used to compute ε_t, such that the result is still certified. The "
+		                          "default (0) evaluates the objective exactly. Disables --lineSearch, which needs exact "
+		                          "values.",
+		util::_default_value    = 0);
+
 BundleMethod::BundleMethod(callback_t valueGradientCallback, unsigned int dims, double regularizerWeight, double eps) :
-	_valueGradientCallback(valueGradientCallback),
+	_valuesGradientsCallback(boost::bind(&BundleMethod::singleCallback, valueGradientCallback, _1, _2, _3, _4, _5)),
+	_numSummands(1),
 	_dims(dims),
 	_lambda(regularizerWeight),
 	_eps(eps) {
 
-	setupQp();
+	init();
+}
+
+BundleMethod::BundleMethod(multi_callback_t valuesGradientsCallback, unsigned int numSummands, unsigned int dims, double regularizerWeight, double eps) :
+	_valuesGradientsCallback(boost::bind(&BundleMethod::multiCallback, valuesGradientsCallback, _1, _2, _3, _4, _5)),
+	_numSummands(numSummands),
+	_dims(dims),
+	_lambda(regularizerWeight),
+	_eps(eps) {
+
+	init();
+}
+
+void
+BundleMethod::init() {
+
+	_lineSearch               = optionLineSearch;
+	_lineSearchEvaluations    = optionLineSearchEvaluations;
+	_oracleTolerance          = optionOracleTolerance;
+	_inexact                  = false;
+	_numEvaluations           = 0;
+	_numLineSearchEvaluations = 0;
+	_numApproximations        = 0;
+	_checkpointInterval       = 10;
+
+	// solve the master problem considerably more precise than the bundle
+	// method, such that ε is dominated by the lower bound itself
+	unsigned int maxInactive = optionMaxInactiveIterations;
+	unsigned int maxSize     = optionMaxBundleSize;
+
+	if (optionUseQpBackend)
+		_bundleSolver = boost::make_shared<QuadraticBundleSolver>(_dims, _numSummands, _lambda, maxInactive, maxSize);
+	else
+		_bundleSolver = boost::make_shared<DualBundleSolver>(_dims, _numSummands, _lambda, 0.1*_eps, maxInactive, maxSize);
 
 	if (optionOutputPrecision) {
 
@@ -29,28 +106,140 @@ BundleMethod::BundleMethod(callback_t valueGradientCallback, unsigned int dims,
 	}
 }
 
+void
+BundleMethod::setGradientStore(boost::shared_ptr<GradientStore> store) {
+
+	if (!_bundleSolver->setGradientStore(store)) {
+
+		LOG_USER(bundlelog) << "bundle solver does not support gradient stores, keeping dense gradients" << std::endl;
+		return;
+	}
+
+	_gradientStore = store;
+}
+
+void
+BundleMethod::setCheckpointFile(const std::string& filename, unsigned int interval) {
+
+	_checkpointFile     = filename;
+	_checkpointInterval = std::max(interval, 1u);
+}
+
+void
+BundleMethod::resumeFrom(const std::string& filename) {
+
+	_resumed = boost::make_shared<BundleCheckpoint>();
+	_resumed->read(filename, _dims, _numSummands);
+
+	// the hyperplanes approximate L and are valid for any λ, only the
+	// regularized values and gradients have to be updated
+	if (_resumed->lambda != _lambda) {
+
+		LOG_USER(bundlelog)
+				<< "checkpoint was written with λ = " << _resumed->lambda
+				<< ", continuing with λ = " << _lambda << std::endl;
+
+		double delta = _lambda - _resumed->lambda;
+
+		_resumed->minValue += delta*0.5*dot(_resumed->w_b, _resumed->w_b);
+		for (unsigned int i = 0; i < _dims; i++)
+			_resumed->g_b[i] += delta*_resumed->w_b[i];
+	}
+
+	unsigned int numSkipped = 0;
+
+	for (unsigned int i = 0; i < _resumed->a.size(); i++) {
+
+		// only the QP backend supports hyperplanes on the sum of all ℒ_s
+		if (_resumed->slacks[i] > _numSummands || (_resumed->slacks[i] == _numSummands && !optionUseQpBackend)) {
+
+			numSkipped++;
+			continue;
+		}
+
+		_bundleSolver->addHyperplane(_resumed->a[i], _resumed->b[i], _resumed->slacks[i]);
+	}
+
+	if (numSkipped > 0)
+		LOG_ERROR(bundlelog)
+				<< "skipped " << numSkipped << " aggregated hyperplanes of the QP backend, "
+				<< "the lower bound is less tight than before" << std::endl;
+
+	LOG_USER(bundlelog)
+			<< "resuming after iteration " << _resumed->t << " with "
+			<< _bundleSolver->size() << " hyperplanes" << std::endl;
+}
+
 std::vector<double>
 BundleMethod::optimize() {
 
 	/*
 	  1. w_0 = 0, t = 0
 	  2. t++
-	  3. compute a_t = ∂L(w_t-1)/∂w
-	  4. compute b_t =  L(w_t-1) - <w_t-1,a_t>
-	  5. ℒ_t(w) = max_i <w,a_i> + b_i
+	  3. compute a_t,s = ∂L_s(w_t-1)/∂w                 ∀s
+	  4. compute b_t,s =  L_s(w_t-1) - <w_t-1,a_t,s>     ∀s
+	  5. ℒ_t(w) = Σ_s max_i <w,a_i,s> + b_i,s
 	  6. w_t = argmin λ½|w|² + ℒ_t(w)
 	  7. ε_t = min_i [ λ½|w_i|² + L(w_i) ] - [ λ½|w_t|² + ℒ_t(w_t) ]
 			   ^^^^^^^^^^^^^^^^^^^^^^^^^^^   ^^^^^^^^^^^^^^^^^^^^^^^
 				 smallest L(w) ever seen    current min of lower bound
 	  8. if ε_t > ε, goto 2
 	  9. return w_t
+
+	  With line search, the objective is evaluated at w_t-1 first, followed
+	  by a search for the minimum of the objective on the line from the best
+	  w_i so far through w_t-1. The best point evaluated on the line replaces
+	  w_t-1 as the point of the iteration. Every point evaluated during the
+	  search adds its hyperplanes to ℒ.
+
+	  With an approximate callback, steps 3 and 4 use the approximate lower
+	  bounds of L_s instead, as long as they cut off more than ε of ℒ_t-1 at
+	  w_t-1. Since the approximation does not provide L(w_t-1), the smallest
+	  L(w) seen is not updated in such iterations.
+
+	  With an inexact callback, L_s(w_t-1) is only computed up to a
+	  tolerance that shrinks with ε_t-1. The hyperplanes are taken at the
+	  (smaller) values found, and the (larger) proven upper bounds on L_s
+	  replace L_s in step 7, such that ε_t stays an upper bound on the
+	  distance to the optimum. The line search is not performed in this
+	  case, since it needs the values of L_s.
 	*/
 
 	std::vector<double> w(_dims, 0.0);
 	double minValue = std::numeric_limits<double>::infinity();
 
+	// the minimal value of the lower bound, attained at w
+	double minLower = -std::numeric_limits<double>::infinity();
+
+	// the best point so far and the gradient of the objective at it
+	std::vector<double> w_b(_dims, 0.0);
+	std::vector<double> g_b(_dims, 0.0);
+
+	_numEvaluations           = 0;
+	_numLineSearchEvaluations = 0;
+	_numApproximations        = 0;
+	_tolerance                = std::numeric_limits<double>::infinity();
+
+	// the line search compares values of the objective, which are only
+	// known up to the tolerance of an inexact callback
+	bool performLineSearch = _lineSearch && !(_inexact && _oracleTolerance > 0);
+
+	if (_lineSearch && !performLineSearch)
+		LOG_USER(bundlelog) << "the objective is evaluated inexactly, no line search is performed" << std::endl;
+
 	unsigned int t = 0;
 
+	if (_resumed) {
+
+		t        = _resumed->t;
+		w        = _resumed->w;
+		minValue = _resumed->minValue;
+		w_b      = _resumed->w_b;
+		g_b      = _resumed->g_b;
+
+		_resumed.reset();
+	}
+
 	while (true) {
 
 		t++;
@@ -61,38 +250,52 @@ BundleMethod::optimize() {
 
 		LOG_DEBUG(bundlelog) << "current w is " << w_tm1 << std::endl;
 
-		// value of L at current w
-		double L_w_tm1 = 0.0;
+		// evaluate the objective only as precise as needed for the current
+		// gap
+		if (_oracleTolerance > 0)
+			_tolerance = std::min(_tolerance, _oracleTolerance*std::max(minValue - minLower, _eps));
+		else
+			_tolerance = 0;
 
-		// gradient of L at current w
-		std::vector<double> a_t(_dims, 0.0);
+		LOG_DEBUG(bundlelog) << "   tolerance of L(w)     is: " << _tolerance << std::endl;
 
-		// get current value and gradient
-		_valueGradientCallback(w_tm1, L_w_tm1, a_t);
+		// try to improve the lower bound without evaluating the objective
+		bool approximated =
+				_approximateCallback &&
+				minLower > -std::numeric_limits<double>::infinity() &&
+				approximate(w_tm1, minLower);
 
-		LOG_DEBUG(bundlelog) << "       L(w)              is: " << L_w_tm1 << std::endl;
-		LOG_ALL(bundlelog)   << "      ∂L(w)/∂            is: " << a_t << std::endl;
+		if (!approximated) {
 
-		// update smallest observed value of regularized L
-		minValue = std::min(minValue, L_w_tm1 + _lambda*0.5*dot(w_tm1, w_tm1));
+			// gradient of the objective at current w
+			std::vector<double> g_tm1(_dims);
 
-		LOG_DEBUG(bundlelog) << " min_i L(w_i) + ½λ|w_i|² is: " << minValue << std::endl;
+			// get current value and gradient, update lower bound
+			double value = evaluate(w_tm1, g_tm1);
 
-		// compute hyperplane offset
-		double b_t = L_w_tm1 - dot(w_tm1, a_t);
+			LOG_DEBUG(bundlelog) << "       L(w)              is: " << value - _lambda*0.5*dot(w_tm1, w_tm1) << std::endl;
 
-		LOG_ALL(bundlelog) << "adding hyperplane " << a_t << "*w + " << b_t << std::endl;
+			// move to the minimum of the objective on the line from the best
+			// point so far through w_tm1
+			if (performLineSearch && t > 1)
+				lineSearch(w_b, minValue, g_b, w_tm1, value, g_tm1);
 
-		// update lower bound
-		_bundleCollector->addHyperplane(a_t, b_t);
+			// update smallest observed value of regularized L
+			if (value < minValue) {
+
+				minValue = value;
+				w_b      = w_tm1;
+				g_b      = g_tm1;
+			}
+		}
 
-		// minimal value of lower bound
-		double minLower;
+		LOG_DEBUG(bundlelog) << " min_i L(w_i) + ½λ|w_i|² is: " << minValue << std::endl;
 
 		// update w and get minimal value
 		findMinLowerBound(w, minLower);
 
 		LOG_DEBUG(bundlelog) << " min_w ℒ(w)   + ½λ|w|²   is: " << minLower << std::endl;
+		LOG_DEBUG(bundlelog) << "       hyperplanes in ℒ  is: " << _bundleSolver->size() << std::endl;
 		LOG_DEBUG(bundlelog) << " w* of ℒ(w)   + ½λ|w|²   is: "  << w << std::endl;
 
 		// compute gap
@@ -115,50 +318,366 @@ BundleMethod::optimize() {
 
 			break;
 		}
+
+		if (!_checkpointFile.empty() && t % _checkpointInterval == 0)
+			writeCheckpoint(t, w, minValue, w_b, g_b);
 	}
 
+	LOG_USER(bundlelog)
+			<< "evaluated the objective " << _numEvaluations << " times in " << t << " iterations";
+	if (performLineSearch)
+		LOG_USER(bundlelog) << ", " << _numLineSearchEvaluations << " of them in line searches";
+	if (_approximateCallback)
+		LOG_USER(bundlelog) << ", " << _numApproximations << " iterations used approximations instead";
+	LOG_USER(bundlelog) << std::endl;
+
 	return w;
 }
 
+double
+BundleMethod::evaluate(const std::vector<double>& w, std::vector<double>& gradient) {
+
+	// values of L_s at w
+	std::vector<double> values(_numSummands, 0.0);
+
+	// upper bounds on L_s at w
+	std::vector<double> upperBounds(_numSummands, 0.0);
+
+	// gradients of L_s at w
+	std::vector<std::vector<double> > a(_numSummands, std::vector<double>(_dims, 0.0));
+
+	{
+		UTIL_TIME_SCOPE("bundle method objective evaluation");
+
+		_valuesGradientsCallback(w, _tolerance, values, upperBounds, a);
+	}
+
+	_numEvaluations++;
+
+	double regularizer = _lambda*0.5*dot(w, w);
+	double value       = regularizer;
+	double upperBound  = regularizer;
+
+	for (unsigned int i = 0; i < _dims; i++)
+		gradient[i] = _lambda*w[i];
+
+	for (unsigned int s = 0; s < _numSummands; s++) {
+
+		value      += values[s];
+		upperBound += std::max(values[s], upperBounds[s]);
+		for (unsigned int i = 0; i < _dims; i++)
+			gradient[i] += a[s][i];
+	}
+
+	if (upperBound > value)
+		LOG_DEBUG(bundlelog)
+				<< "      L(w)              is in [" << value - regularizer << ", "
+				<< upperBound - regularizer << "]" << std::endl;
+
+	addHyperplanes(w, values, a);
+
+	return upperBound;
+}
+
+bool
+BundleMethod::approximate(const std::vector<double>& w, double lowerBound) {
+
+	// approximate values of L_s at w
+	std::vector<double> values(_numSummands, 0.0);
+
+	// gradients of the approximations at w
+	std::vector<std::vector<double> > a(_numSummands, std::vector<double>(_dims, 0.0));
+
+	{
+		UTIL_TIME_SCOPE("bundle method objective approximation");
+
+		if (!_approximateCallback(w, values, a))
+			return false;
+	}
+
+	double value = _lambda*0.5*dot(w, w);
+	for (unsigned int s = 0; s < _numSummands; s++)
+		value += values[s];
+
+	LOG_DEBUG(bundlelog)
+			<< "approximation improves lower bound at w by "
+			<< value - lowerBound << std::endl;
+
+	// the approximation is a lower bound of the objective as well, it only
+	// helps if it is considerably above the current one
+	if (value - lowerBound <= _eps)
+		return false;
+
+	addHyperplanes(w, values, a);
+
+	_numApproximations++;
+
+	return true;
+}
+
+void
+BundleMethod::addHyperplanes(
+		const std::vector<double>&               w,
+		const std::vector<double>&               values,
+		const std::vector<std::vector<double> >& gradients) {
+
+	for (unsigned int s = 0; s < _numSummands; s++) {
+
+		// compute hyperplane offset
+		double b = values[s] - dot(w, gradients[s]);
+
+		LOG_ALL(bundlelog) << "adding hyperplane " << gradients[s] << "*w + " << b << " to ℒ_" << s << std::endl;
+
+		// update lower bound
+		if (_gradientStore)
+			_bundleSolver->addStoredHyperplane(gradients[s], b, s, _gradientStore->add(s));
+		else
+			_bundleSolver->addHyperplane(gradients[s], b, s);
+	}
+}
+
 void
-BundleMethod::setupQp() {
+BundleMethod::lineSearch(
+		const std::vector<double>& w_b,
+		double                     value_b,
+		const std::vector<double>& gradient_b,
+		std::vector<double>&       w,
+		double&                    value,
+		std::vector<double>&       gradient) {
+
+	UTIL_TIME_SCOPE("bundle method line search");
 
 	/*
-	  w* = argmin λ½|w|² + ξ, s.t. <w,a_i> + b_i ≤ ξ ∀i
-	*/
+	  J(η) = λ½|w(η)|² + L(w(η)), w(η) = w_b + η(w - w_b)
 
-	// one variable for each component of w and for ξ
-	_qpObjective->resize(_dims + 1);
+	  is convex in η. Bracket its minimum with the derivatives
+	  J'(η) = <∂J/∂w,w - w_b>, and evaluate at the intersection of the
+	  tangents at the bracket ends, which is the minimizer of the
+	  cutting-plane model of J on the line.
+	*/
 
-	// regularizer
+	std::vector<double> d(_dims);
 	for (unsigned int i = 0; i < _dims; i++)
-		_qpObjective->setQuadraticCoefficient(i, i, 0.5*_lambda);
+		d[i] = w[i] - w_b[i];
+
+	double lo  = 0;
+	double flo = value_b;
+	double dlo = dot(gradient_b, d);
+	double hi  = 1;
+	double fhi = value;
+	double dhi = dot(gradient, d);
+
+	// w_b is already minimal along d
+	if (dlo >= 0) {
+
+		if (value_b < value) {
+
+			w        = w_b;
+			value    = value_b;
+			gradient = gradient_b;
+		}
+
+		return;
+	}
+
+	double start = std::min(value, value_b);
+
+	// the best point evaluated on the line so far
+	double bestEta = (value_b < value ? 0 : 1);
+
+	std::vector<double> w_best = (value_b < value ? w_b : w);
+	std::vector<double> g_best = (value_b < value ? gradient_b : gradient);
+	double              f_best = start;
+
+	std::vector<double> w_eta(_dims);
+	std::vector<double> g_eta(_dims);
+
+	unsigned int n = 0;
+	for (; n < _lineSearchEvaluations; n++) {
+
+		double eta;
+
+		if (dhi < 0) {
+
+			// the minimum is beyond hi
+			eta = 2*hi;
+			lo  = hi;
+			flo = fhi;
+			dlo = dhi;
+
+		} else {
+
+			double lower = flo;
+			eta = lo;
+			if (dhi > dlo) {
+
+				eta   = (fhi - flo + dlo*lo - dhi*hi)/(dlo - dhi);
+				lower = flo + dlo*(eta - lo);
+			}
+
+			// the remaining improvement is too small to be worth another
+			// evaluation
+			if (f_best - lower <= _eps)
+				break;
+
+			// stay away from the bracket ends
+			eta = std::max(eta, lo + 0.1*(hi - lo));
+			eta = std::min(eta, hi - 0.1*(hi - lo));
+		}
+
+		for (unsigned int i = 0; i < _dims; i++)
+			w_eta[i] = w_b[i] + eta*d[i];
+
+		double f    = evaluate(w_eta, g_eta);
+		double deta = dot(g_eta, d);
+
+		_numLineSearchEvaluations++;
 
-	// ξ
-	_qpObjective->setCoefficient(_dims, 1.0);
+		LOG_DEBUG(bundlelog) << "line search: J(" << eta << ") = " << f << ", J'(" << eta << ") = " << deta << std::endl;
 
-	// we minimize
-	_qpObjective->setSense(Minimize);
+		if (f < f_best) {
 
-	// connect pipeline
-	_qpSolver->setInput("objective", _qpObjective);
-	_qpSolver->setInput("linear constraints", _bundleCollector->getOutput());
-	_qpSolver->setInput("parameters", _qpParameters);
-	_qpSolution = _qpSolver->getOutput("solution");
+			bestEta = eta;
+			w_best  = w_eta;
+			g_best  = g_eta;
+			f_best  = f;
+		}
+
+		if (deta < 0 && dhi >= 0) {
+
+			lo  = eta;
+			flo = f;
+			dlo = deta;
+
+		} else {
+
+			hi  = eta;
+			fhi = f;
+			dhi = deta;
+		}
+
+		if (deta == 0)
+			break;
+	}
+
+	w.swap(w_best);
+	gradient.swap(g_best);
+	value = f_best;
+
+	LOG_DEBUG(bundlelog)
+			<< "line search: " << n << " evaluations, moved to η = " << bestEta
+			<< ", improved objective by " << start - value << std::endl;
+}
+
+void
+BundleMethod::setInexactCallback(inexact_callback_t callback) {
+
+	_valuesGradientsCallback = boost::bind(&BundleMethod::singleInexactCallback, callback, _1, _2, _3, _4, _5);
+	_inexact                 = true;
+}
+
+void
+BundleMethod::setInexactCallback(inexact_multi_callback_t callback) {
+
+	_valuesGradientsCallback = callback;
+	_inexact                 = true;
+}
+
+void
+BundleMethod::setApproximateCallback(approximate_callback_t callback) {
+
+	_approximateCallback = boost::bind(&BundleMethod::singleApproximateCallback, callback, _1, _2, _3);
+}
+
+void
+BundleMethod::setApproximateCallback(multi_approximate_callback_t callback) {
+
+	_approximateCallback = callback;
+}
+
+void
+BundleMethod::singleCallback(
+		callback_t callback,
+		const std::vector<double>& w,
+		double,
+		std::vector<double>& values,
+		std::vector<double>& upperBounds,
+		std::vector<std::vector<double> >& gradients) {
+
+	callback(w, values[0], gradients[0]);
+	upperBounds[0] = values[0];
+}
+
+void
+BundleMethod::multiCallback(
+		multi_callback_t callback,
+		const std::vector<double>& w,
+		double,
+		std::vector<double>& values,
+		std::vector<double>& upperBounds,
+		std::vector<std::vector<double> >& gradients) {
+
+	callback(w, values, gradients);
+	upperBounds = values;
+}
+
+void
+BundleMethod::singleInexactCallback(
+		inexact_callback_t callback,
+		const std::vector<double>& w,
+		double tolerance,
+		std::vector<double>& values,
+		std::vector<double>& upperBounds,
+		std::vector<std::vector<double> >& gradients) {
+
+	callback(w, tolerance, values[0], upperBounds[0], gradients[0]);
+}
+
+bool
+BundleMethod::singleApproximateCallback(
+		approximate_callback_t callback,
+		const std::vector<double>& w,
+		std::vector<double>& values,
+		std::vector<std::vector<double> >& gradients) {
+
+	return callback(w, values[0], gradients[0]);
 }
 
 void
 BundleMethod::findMinLowerBound(std::vector<double>& w, double& value) {
 
-	// read the solution (pipeline magic!)
-	for (unsigned int i = 0; i < _dims; i++)
-		w[i] = (*_qpSolution)[i];
+	_bundleSolver->solve(w, value);
+}
 
-	value = _qpSolution->getValue();
+void
+BundleMethod::writeCheckpoint(
+		unsigned int               t,
+		const std::vector<double>& w,
+		double                     minValue,
+		const std::vector<double>& w_b,
+		const std::vector<double>& g_b) {
+
+	UTIL_TIME_SCOPE("bundle method checkpoint");
+
+	BundleCheckpoint checkpoint;
+
+	checkpoint.dims        = _dims;
+	checkpoint.numSummands = _numSummands;
+	checkpoint.lambda      = _lambda;
+	checkpoint.eps         = _eps;
+	checkpoint.t           = t;
+	checkpoint.minValue    = minValue;
+	checkpoint.w_b         = w_b;
+	checkpoint.g_b         = g_b;
+	checkpoint.w           = w;
+
+	_bundleSolver->getHyperplanes(checkpoint.a, checkpoint.b, checkpoint.slacks);
+
+	checkpoint.write(_checkpointFile);
 }
 
 double
-BundleMethod::dot(std::vector<double>& a, std::vector<double>& b) {
+BundleMethod::dot(const std::vector<double>& a, const std::vector<double>& b) {
 
 	assert(a.size() == b.size());
 
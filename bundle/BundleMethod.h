@@ -1,18 +1,22 @@
 #ifndef SBMRM_BUNDLE_METHOD_H__
 #define SBMRM_BUNDLE_METHOD_H__
 
+#include <string>
 #include <vector>
 #include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
 
-#include <pipeline/Value.h>
-#include <pipeline/Process.h>
-#include <inference/QuadraticSolver.h>
-
-#include "BundleCollector.h"
+#include "BundleCheckpoint.h"
+#include "BundleSolver.h"
 
 /**
  * Implements a bundle method with a quadratic regularizer for arbitrary convex 
  * functions.
+ *
+ * If the function is a sum L(w) = Σ_s L_s(w) of convex functions, the
+ * summands can be approximated by individual lower bounds ℒ_s (multiple
+ * cuts), which usually needs fewer iterations than approximating L as a
+ * whole.
  */
 class BundleMethod {
 
@@ -20,6 +24,16 @@ public:
 
 	typedef boost::function<void(const std::vector<double>& w, double& value, std::vector<double>& gradient)> callback_t;
 
+	typedef boost::function<void(const std::vector<double>& w, std::vector<double>& values, std::vector<std::vector<double> >& gradients)> multi_callback_t;
+
+	typedef boost::function<void(const std::vector<double>& w, double tolerance, double& value, double& upperBound, std::vector<double>& gradient)> inexact_callback_t;
+
+	typedef boost::function<void(const std::vector<double>& w, double tolerance, std::vector<double>& values, std::vector<double>& upperBounds, std::vector<std::vector<double> >& gradients)> inexact_multi_callback_t;
+
+	typedef boost::function<bool(const std::vector<double>& w, double& value, std::vector<double>& gradient)> approximate_callback_t;
+
+	typedef boost::function<bool(const std::vector<double>& w, std::vector<double>& values, std::vector<std::vector<double> >& gradients)> multi_approximate_callback_t;
+
 	/**
 	 * Create a new bundle method for the given value and gradient callback.
 	 *
@@ -39,6 +53,82 @@ public:
 			double regularizerWeight,
 			double eps);
 
+	/**
+	 * Create a new bundle method for a sum of numSummands functions, each of
+	 * which is approximated by its own lower bound.
+	 *
+	 * @param valuesGradientsCallback
+	 *           A function returning the values and gradients of all summands
+	 *           at a given position w.
+	 * @param numSummands
+	 *           The number of summands L_s.
+	 * @param dims
+	 *           The size of the vector w.
+	 * @param regularizerWeight
+	 *           The weight of the quadratic regularizer.
+	 * @param eps
+	 *           Convergence threshold.
+	 */
+	BundleMethod(
+			multi_callback_t valuesGradientsCallback,
+			unsigned int numSummands,
+			unsigned int dims,
+			double regularizerWeight,
+			double eps);
+
+	/**
+	 * Replace the value and gradient callback with a function that evaluates
+	 * the function only up to a given tolerance. For a position w and a
+	 * tolerance, it returns the value and gradient of a hyperplane that bounds
+	 * the function from below and is at most tolerance below the function at
+	 * w, and an upper bound on the function value at w. The tolerance is
+	 * chosen relative to the current gap of the bundle method
+	 * (--oracleTolerance), the line search is not performed if it is not 0.
+	 */
+	void setInexactCallback(inexact_callback_t inexactCallback);
+
+	/**
+	 * Same as above, for the summands of a sum of functions. The tolerance
+	 * holds for the sum of all summands.
+	 */
+	void setInexactCallback(inexact_multi_callback_t inexactCallback);
+
+	/**
+	 * Set a function that returns cheap lower bounds on the value of the
+	 * function at w and gradients of these bounds, e.g., from hyperplanes
+	 * found earlier. They are used instead of the exact values and gradients
+	 * as long as they improve the lower bound of the bundle method by more
+	 * than eps. The function returns false if it can not provide bounds.
+	 */
+	void setApproximateCallback(approximate_callback_t approximateCallback);
+
+	/**
+	 * Same as above, for the summands of a sum of functions.
+	 */
+	void setApproximateCallback(multi_approximate_callback_t approximateCallback);
+
+	/**
+	 * Keep the gradients of the hyperplanes in the given store instead of as
+	 * dense vectors. After each call to one of the callbacks, the bundle
+	 * method asks the store to keep the gradients of all summands. Not
+	 * supported by the QP backend, where the store is ignored.
+	 */
+	void setGradientStore(boost::shared_ptr<GradientStore> store);
+
+	/**
+	 * Write the state of the bundle method to the given file every interval
+	 * iterations.
+	 */
+	void setCheckpointFile(const std::string& filename, unsigned int interval = 10);
+
+	/**
+	 * Continue from a checkpoint written by a previous run with the same
+	 * number of dimensions and summands. The hyperplanes of the checkpoint
+	 * are restored, such that the objective does not have to be evaluated
+	 * again at any previous point. Has to be called before optimize().
+	 */
+	void resumeFrom(const std::string& filename);
+
 	/**
 	 * Start the optimization.
 	 *
@@ -48,14 +138,85 @@ public:
 
 private:
 
-	void setupQp();
+	// common initialization of all constructors
+	void init();
+
+	// adapt the other callbacks to the inexact multi callback interface
+	static void singleCallback(
+			callback_t callback,
+			const std::vector<double>& w,
+			double tolerance,
+			std::vector<double>& values,
+			std::vector<double>& upperBounds,
+			std::vector<std::vector<double> >& gradients);
+
+	static void multiCallback(
+			multi_callback_t callback,
+			const std::vector<double>& w,
+			double tolerance,
+			std::vector<double>& values,
+			std::vector<double>& upperBounds,
+			std::vector<std::vector<double> >& gradients);
+
+	static void singleInexactCallback(
+			inexact_callback_t callback,
+			const std::vector<double>& w,
+			double tolerance,
+			std::vector<double>& values,
+			std::vector<double>& upperBounds,
+			std::vector<std::vector<double> >& gradients);
+
+	static bool singleApproximateCallback(
+			approximate_callback_t callback,
+			const std::vector<double>& w,
+			std::vector<double>& values,
+			std::vector<std::vector<double> >& gradients);
+
+	// evaluate all L_s at w up to the current tolerance and add their
+	// hyperplanes to the lower bound, returns an upper bound on the value of
+	// the regularized objective and the gradient of the hyperplanes
+	double evaluate(const std::vector<double>& w, std::vector<double>& gradient);
+
+	// search for the minimum of the objective on the line from w_b through
+	// w, replaces w and the value and gradient at it by the best point
+	// evaluated on the line (which can be w_b)
+	void lineSearch(
+			const std::vector<double>& w_b,
+			double                     value_b,
+			const std::vector<double>& gradient_b,
+			std::vector<double>&       w,
+			double&                    value,
+			std::vector<double>&       gradient);
+
+	// use the approximate callback at w, if it improves the lower bound
+	// there by more than ε, returns false otherwise
+	bool approximate(const std::vector<double>& w, double lowerBound);
+
+	// add the hyperplanes of all L_s at w
+	void addHyperplanes(
+			const std::vector<double>&               w,
+			const std::vector<double>&               values,
+			const std::vector<std::vector<double> >& gradients);
 
 	void findMinLowerBound(std::vector<double>& w, double& value);
 
-	inline double dot(std::vector<double>& a, std::vector<double>& b);
+	void writeCheckpoint(
+			unsigned int               t,
+			const std::vector<double>& w,
+			double                     minValue,
+			const std::vector<double>& w_b,
+			const std::vector<double>& g_b);
+
+	inline double dot(const std::vector<double>& a, const std::vector<double>& b);
+
+	// callback providing L_s(w) and ∂L_s(w)/∂w
+	inexact_multi_callback_t _valuesGradientsCallback;
 
-	// callback providing L(w) and ∂L(w)/∂w
-	callback_t _valueGradientCallback;
+	// optional callback providing lower bounds on L_s(w) and their gradients
+	multi_approximate_callback_t _approximateCallback;
+
+	// the number of summands L_s
+	unsigned int _numSummands;
 
 	// the size of w
 	unsigned int _dims;
@@ -66,13 +227,37 @@ private:
 	// convergence threshold
 	double _eps;
 
-	pipeline::Value<QuadraticObjective>        _qpObjective;
-	pipeline::Value<QuadraticSolverParameters> _qpParameters;
+	// perform a line search in each iteration
+	bool _lineSearch;
+
+	// the maximal number of evaluations per line search
+	unsigned int _lineSearchEvaluations;
+
+	// the tolerance for evaluations of the objective, relative to the
+	// current gap, and its current absolute value
+	double _oracleTolerance;
+	double _tolerance;
+
+	// an inexact callback was set
+	bool _inexact;
+
+	// statistics about the evaluations of the objective
+	unsigned int _numEvaluations;
+	unsigned int _numLineSearchEvaluations;
+	unsigned int _numApproximations;
+
+	// where and how often to write checkpoints
+	std::string  _checkpointFile;
+	unsigned int _checkpointInterval;
+
+	// optional compact storage of the hyperplane gradients
+	boost::shared_ptr<GradientStore> _gradientStore;
 
-	pipeline::Process<BundleCollector> _bundleCollector;
-	pipeline::Process<QuadraticSolver> _qpSolver;
+	// the state to continue from, if resumed
+	boost::shared_ptr<BundleCheckpoint> _resumed;
 
-	pipeline::Value<Solution> _qpSolution;
+	// solver for the master problem
+	boost::shared_ptr<BundleSolver> _bundleSolver;
 };
 
 #endif // SBMRM_BUNDLE_METHOD_H__
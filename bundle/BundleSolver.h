@@ -0,0 +1,87 @@
+#ifndef SBMRM_BUNDLE_BUNDLE_SOLVER_H__
+#define SBMRM_BUNDLE_BUNDLE_SOLVER_H__
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+#include "GradientStore.h"
+
+/**
+ * Interface for solvers of the bundle master problem
+ *
+ *   w* = argmin λ½|w|² + Σ_s ℒ_s(w),   ℒ_s(w) = max_{i∈I_s} <w,a_i> + b_i
+ *
+ * over a growing set of hyperplanes (a_i,b_i). Each hyperplane belongs to
+ * one of the sets I_s, which correspond to the slack variables ξ_s of the
+ * primal formulation. For a single-cut bundle method, there is only one set.
+ *
+ * Implementations can be asked to bound the size of the bundle: Hyperplanes
+ * that did not support the solution for a number of consecutive calls to
+ * solve() are removed, and if the bundle grows too large, hyperplanes are
+ * aggregated into a convex combination of themselves. Both operations leave
+ * the minimum of the master problem unchanged and thus preserve the
+ * convergence of the bundle method.
+ */
+class BundleSolver {
+
+public:
+
+	virtual ~BundleSolver() {}
+
+	/**
+	 * Add a hyperplane <w,a> + b to the lower bound ℒ_s(w).
+	 *
+	 * @param slack
+	 *           The index s of the lower bound (and slack variable) this
+	 *           hyperplane belongs to.
+	 */
+	virtual void addHyperplane(const std::vector<double>& a, double b, unsigned int slack) = 0;
+
+	/**
+	 * Use the given store for gradients added with addStoredHyperplane().
+	 *
+	 * @return false, if this solver does not support gradient stores.
+	 */
+	virtual bool setGradientStore(boost::shared_ptr<GradientStore> /*store*/) { return false; }
+
+	/**
+	 * Same as addHyperplane(), for a gradient a that is kept in the gradient
+	 * store under the given id. Solvers that support gradient stores do not
+	 * keep a itself, and remove the id from the store when they drop the
+	 * hyperplane.
+	 */
+	virtual void addStoredHyperplane(const std::vector<double>& a, double b, unsigned int slack, unsigned int /*id*/) {
+
+		addHyperplane(a, b, slack);
+	}
+
+	/**
+	 * Find the minimizer of the master problem.
+	 *
+	 * @param w
+	 *           Will be set to the minimizer w*.
+	 * @param value
+	 *           Will be set to the minimal value λ½|w*|² + Σ_s ℒ_s(w*), or a
+	 *           lower bound of it.
+	 */
+	virtual void solve(std::vector<double>& w, double& value) = 0;
+
+	/**
+	 * The number of hyperplanes currently in the bundle.
+	 */
+	virtual unsigned int size() const = 0;
+
+	/**
+	 * Get all hyperplanes currently in the bundle, e.g., to store them in a
+	 * checkpoint. Adding them to a new solver restores the lower bound.
+	 * Hyperplanes that bound the sum of all ℒ_s (see QuadraticBundleSolver)
+	 * are reported with a slack index equal to the number of lower bounds.
+	 */
+	virtual void getHyperplanes(
+			std::vector<std::vector<double> >& a,
+			std::vector<double>&               b,
+			std::vector<unsigned int>&         slacks) const = 0;
+};
+
+#endif // SBMRM_BUNDLE_BUNDLE_SOLVER_H__
+
@@ -0,0 +1,608 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+#include <util/Logger.h>
+#include <util/helpers.hpp>
+#include "DualBundleSolver.h"
+
+logger::LogChannel dualbundlesolverlog("dualbundlesolverlog", "[DualBundleSolver] ");
+
+// maximal number of SMO steps per call to solve()
+static const unsigned int MaxIterations = 100000;
+
+// lower bound on the curvature along a pair of coordinates
+static const double MinCurvature = 1e-12;
+
+// relative weight of the proximal term in Newton steps
+static const double ProximalWeight = 1e-8;
+
+// the id of hyperplanes that are not in the gradient store
+static const unsigned int NoId = std::numeric_limits<unsigned int>::max();
+
+static double
+dot(const std::vector<double>& a, const std::vector<double>& b) {
+
+	assert(a.size() == b.size());
+
+	double d = 0.0;
+	for (unsigned int i = 0; i < a.size(); i++)
+		d += a[i]*b[i];
+
+	return d;
+}
+
+DualBundleSolver::DualBundleSolver(
+		unsigned int dims,
+		unsigned int numSlacks,
+		double       regularizerWeight,
+		double       eps,
+		unsigned int maxInactive,
+		unsigned int maxSize) :
+	_dims(dims),
+	_numSlacks(numSlacks),
+	_lambda(regularizerWeight),
+	_eps(eps),
+	_maxInactive(maxInactive),
+	_maxSize(maxSize > 0 ? std::max(maxSize, 2u) : 0) {}
+
+bool
+DualBundleSolver::setGradientStore(boost::shared_ptr<GradientStore> store) {
+
+	_store = store;
+
+	return true;
+}
+
+void
+DualBundleSolver::addHyperplane(const std::vector<double>& a, double b, unsigned int slack) {
+
+	appendHyperplane(a, b, slack, NoId);
+}
+
+void
+DualBundleSolver::addStoredHyperplane(const std::vector<double>& a, double b, unsigned int slack, unsigned int id) {
+
+	if (!_store) {
+
+		addHyperplane(a, b, slack);
+		return;
+	}
+
+	appendHyperplane(a, b, slack, id);
+}
+
+void
+DualBundleSolver::appendHyperplane(const std::vector<double>& a, double b, unsigned int slack, unsigned int id) {
+
+	unsigned int t = _a.size();
+
+	// grow the Gram matrix by one row and column, the products with stored
+	// gradients are computed by the store in one go
+	std::vector<double>       row(t + 1);
+	std::vector<unsigned int> storedIds;
+	std::vector<unsigned int> stored;
+	for (unsigned int j = 0; j < t; j++) {
+
+		if (_ids[j] == NoId) {
+
+			row[j] = dot(a, _a[j]);
+
+		} else {
+
+			storedIds.push_back(_ids[j]);
+			stored.push_back(j);
+		}
+	}
+	row[t] = dot(a, a);
+
+	if (!stored.empty()) {
+
+		std::vector<double> products;
+		_store->dots(a, storedIds, products);
+
+		for (unsigned int k = 0; k < stored.size(); k++)
+			row[stored[k]] = products[k];
+	}
+
+	for (unsigned int j = 0; j < t; j++)
+		_gram[j].push_back(row[j]);
+
+	// the first hyperplane of each lower bound gets all the weight, later
+	// ones start inactive
+	bool first = (std::find(_slack.begin(), _slack.end(), slack) == _slack.end());
+
+	_gram.push_back(row);
+	_a.push_back(id == NoId ? a : std::vector<double>());
+	_b.push_back(b);
+	_slack.push_back(slack);
+	_ids.push_back(id);
+	_alpha.push_back(first ? 1.0 : 0.0);
+	_inactive.push_back(0);
+}
+
+void
+DualBundleSolver::accumulateGradients(const std::vector<double>& weights, std::vector<double>& x) const {
+
+	std::vector<unsigned int> storedIds;
+	std::vector<double>       storedWeights;
+
+	for (unsigned int i = 0; i < _a.size(); i++) {
+
+		if (weights[i] == 0)
+			continue;
+
+		if (_ids[i] != NoId) {
+
+			storedIds.push_back(_ids[i]);
+			storedWeights.push_back(weights[i]);
+			continue;
+		}
+
+		for (unsigned int j = 0; j < _dims; j++)
+			x[j] += weights[i]*_a[i][j];
+	}
+
+	if (!storedIds.empty())
+		_store->accumulate(storedIds, storedWeights, x);
+}
+
+void
+DualBundleSolver::getHyperplanes(
+		std::vector<std::vector<double> >& a,
+		std::vector<double>&               b,
+		std::vector<unsigned int>&         slacks) const {
+
+	a      = _a;
+	b      = _b;
+	slacks = _slack;
+
+	for (unsigned int i = 0; i < _a.size(); i++) {
+
+		if (_ids[i] == NoId)
+			continue;
+
+		a[i].assign(_dims, 0.0);
+		_store->accumulate(std::vector<unsigned int>(1, _ids[i]), std::vector<double>(1, 1.0), a[i]);
+	}
+}
+
+void
+DualBundleSolver::solve(std::vector<double>& w, double& value) {
+
+	value = optimizeMultipliers();
+
+	// w* = -1/λ Σ_i α_i a_i
+	std::vector<double> weights(_alpha.size());
+	for (unsigned int i = 0; i < _alpha.size(); i++)
+		weights[i] = -_alpha[i]/_lambda;
+
+	std::fill(w.begin(), w.end(), 0.0);
+	accumulateGradients(weights, w);
+
+	LOG_ALL(dualbundlesolverlog) << "multipliers are " << _alpha << std::endl;
+
+	limitBundle();
+}
+
+double
+DualBundleSolver::optimizeMultipliers() {
+
+	/*
+	  D(α)  = <b,α> - 1/(2λ) αᵀGα
+	  ∇D(α) = b - 1/λ Gα =: g
+
+	  The duality gap of the master problem at α is
+
+	    Σ_s max_{i∈I_s} g_i - <α,g>,
+
+	  which is zero iff α is optimal.
+	*/
+
+	unsigned int t = _alpha.size();
+
+	std::vector<double> g(_b);
+	for (unsigned int j = 0; j < t; j++)
+		if (_alpha[j] != 0)
+			for (unsigned int i = 0; i < t; i++)
+				g[i] -= _gram[i][j]*_alpha[j]/_lambda;
+
+	double gap = std::numeric_limits<double>::infinity();
+
+	// per lower bound: the hyperplane with the largest gradient and the
+	// contribution to the gap
+	std::vector<unsigned int> best(_numSlacks);
+	std::vector<double>       slackGap(_numSlacks);
+
+	unsigned int iteration = 0;
+	for (; iteration < MaxIterations; iteration++) {
+
+		std::fill(best.begin(), best.end(), t);
+		std::fill(slackGap.begin(), slackGap.end(), 0.0);
+
+		for (unsigned int k = 0; k < t; k++) {
+
+			unsigned int s = _slack[k];
+
+			if (best[s] == t || g[k] > g[best[s]])
+				best[s] = k;
+			slackGap[s] -= _alpha[k]*g[k];
+		}
+
+		gap = 0;
+		unsigned int worst = 0;
+		for (unsigned int s = 0; s < _numSlacks; s++) {
+
+			if (best[s] == t)
+				continue;
+
+			slackGap[s] += g[best[s]];
+			gap += slackGap[s];
+
+			if (slackGap[s] > slackGap[worst])
+				worst = s;
+		}
+
+		if (gap <= _eps)
+			break;
+
+		// the coordinate to increase
+		unsigned int i = best[worst];
+
+		// the coordinate to decrease, chosen by the largest possible gain
+		// (g_i - g_j)²/η
+		unsigned int j    = t;
+		double       gain = 0;
+		for (unsigned int k = 0; k < t; k++) {
+
+			if (_slack[k] != worst || _alpha[k] == 0 || g[k] >= g[i])
+				continue;
+
+			double eta = std::max(MinCurvature, _gram[i][i] + _gram[k][k] - 2*_gram[i][k]);
+			double d   = g[i] - g[k];
+
+			if (d*d/eta > gain) {
+
+				gain = d*d/eta;
+				j    = k;
+			}
+		}
+
+		if (j == t)
+			break;
+
+		// move δ from α_j to α_i
+		double eta   = std::max(MinCurvature, _gram[i][i] + _gram[j][j] - 2*_gram[i][j]);
+		double delta = std::min(_alpha[j], _lambda*(g[i] - g[j])/eta);
+
+		_alpha[i] += delta;
+		if (delta == _alpha[j])
+			_alpha[j] = 0;
+		else
+			_alpha[j] -= delta;
+
+		for (unsigned int k = 0; k < t; k++)
+			g[k] -= delta*(_gram[k][i] - _gram[k][j])/_lambda;
+
+		// pairwise steps alone converge slowly on ill-conditioned bundles,
+		// solve on the new support instead, dropping hyperplanes whose
+		// multipliers reach zero on the way
+		while (newtonStep(g) == PartialStep);
+	}
+
+	if (iteration == MaxIterations)
+		LOG_ERROR(dualbundlesolverlog)
+				<< "no convergence after " << MaxIterations
+				<< " iterations, duality gap is " << gap << std::endl;
+
+	LOG_DEBUG(dualbundlesolverlog)
+			<< "solved dual with " << t << " hyperplanes in "
+			<< iteration << " iterations, duality gap is " << gap << std::endl;
+
+	// D(α) = ½ Σ_i α_i (b_i + g_i)
+	double value = 0;
+	for (unsigned int k = 0; k < t; k++)
+		value += 0.5*_alpha[k]*(_b[k] + g[k]);
+
+	return value;
+}
+
+DualBundleSolver::StepResult
+DualBundleSolver::newtonStep(std::vector<double>& g) {
+
+	/*
+	  On the support S = {i : α_i > 0}, the maximizer of the proximal
+	  objective D(α) - δ/2|α - α'|² subject to Σ_{i∈I_s} α_i = 1 satisfies
+
+	    (1/λ G_SS + δI) α_S + Σ_s μ_s 1_s = b_S + δα'_S
+	                          1_sᵀ α_S    = 1            ∀s
+
+	  where 1_s is the indicator vector of I_s. The proximal term keeps the
+	  system regular if G_SS is singular, which happens as soon as the
+	  support has more than dims + 1 elements. Move from α_S towards the
+	  maximizer as far as α stays non-negative.
+	*/
+
+	std::vector<unsigned int> support;
+	for (unsigned int i = 0; i < _alpha.size(); i++)
+		if (_alpha[i] > 0)
+			support.push_back(i);
+
+	unsigned int n = support.size();
+
+	// there is one element in the support per lower bound at least
+	if (n <= _numSlacks)
+		return NoStep;
+
+	// the row of the constraint for each lower bound
+	std::vector<unsigned int> rows(_numSlacks, 0);
+	unsigned int m = 0;
+	for (unsigned int i = 0; i < n; i++)
+		if (rows[_slack[support[i]]] == 0)
+			rows[_slack[support[i]]] = n + m++;
+
+	double delta = 0;
+	for (unsigned int i = 0; i < n; i++)
+		delta = std::max(delta, ProximalWeight*_gram[support[i]][support[i]]/_lambda);
+	delta = std::max(delta, ProximalWeight);
+
+	// the KKT system [M|r]
+	unsigned int size = n + m;
+	std::vector<std::vector<double> > M(size, std::vector<double>(size + 1, 0.0));
+	for (unsigned int i = 0; i < n; i++) {
+
+		for (unsigned int j = 0; j < n; j++)
+			M[i][j] = _gram[support[i]][support[j]]/_lambda;
+
+		unsigned int row = rows[_slack[support[i]]];
+
+		M[i][i]   += delta;
+		M[i][row]  = 1;
+		M[row][i]  = 1;
+		M[i][size] = _b[support[i]] + delta*_alpha[support[i]];
+	}
+	for (unsigned int r = n; r < size; r++)
+		M[r][size] = 1;
+
+	// Gaussian elimination with partial pivoting
+	for (unsigned int c = 0; c < size; c++) {
+
+		unsigned int p = c;
+		for (unsigned int r = c + 1; r < size; r++)
+			if (std::abs(M[r][c]) > std::abs(M[p][c]))
+				p = r;
+
+		if (std::abs(M[p][c]) < MinCurvature)
+			return NoStep;
+
+		M[c].swap(M[p]);
+
+		for (unsigned int r = c + 1; r < size; r++) {
+
+			double f = M[r][c]/M[c][c];
+			for (unsigned int k = c; k <= size; k++)
+				M[r][k] -= f*M[c][k];
+		}
+	}
+
+	std::vector<double> x(size);
+	for (int r = size - 1; r >= 0; r--) {
+
+		double v = M[r][size];
+		for (unsigned int k = r + 1; k < size; k++)
+			v -= M[r][k]*x[k];
+		x[r] = v/M[r][r];
+	}
+
+	// the direction and the largest feasible step along it
+	std::vector<double> d(n);
+	double       tau      = 1.0;
+	unsigned int blocking = n;
+	for (unsigned int i = 0; i < n; i++) {
+
+		d[i] = x[i] - _alpha[support[i]];
+
+		if (d[i] < 0 && -_alpha[support[i]]/d[i] < tau) {
+
+			tau      = -_alpha[support[i]]/d[i];
+			blocking = i;
+		}
+	}
+
+	if (tau <= 0)
+		return NoStep;
+
+	for (unsigned int i = 0; i < n; i++) {
+
+		unsigned int s = support[i];
+
+		double alpha = (i == blocking ? 0.0 : std::max(0.0, _alpha[s] + tau*d[i]));
+		double delta = alpha - _alpha[s];
+
+		_alpha[s] = alpha;
+
+		for (unsigned int k = 0; k < g.size(); k++)
+			g[k] -= delta*_gram[k][s]/_lambda;
+	}
+
+	return (blocking < n ? PartialStep : FullStep);
+}
+
+void
+DualBundleSolver::limitBundle() {
+
+	unsigned int t = _alpha.size();
+
+	std::vector<bool> remove(t, false);
+	unsigned int numRemove = 0;
+
+	for (unsigned int i = 0; i < t; i++) {
+
+		if (_alpha[i] == 0)
+			_inactive[i]++;
+		else
+			_inactive[i] = 0;
+
+		if (_maxInactive > 0 && _inactive[i] >= _maxInactive) {
+
+			remove[i] = true;
+			numRemove++;
+		}
+	}
+
+	if (numRemove > 0) {
+
+		LOG_DEBUG(dualbundlesolverlog) << "removing " << numRemove << " inactive hyperplanes" << std::endl;
+
+		removeHyperplanes(remove);
+	}
+
+	if (_maxSize == 0)
+		return;
+
+	for (unsigned int s = 0; s < _numSlacks; s++) {
+
+		std::vector<std::pair<double, unsigned int> > order;
+		for (unsigned int i = 0; i < _alpha.size(); i++)
+			if (_slack[i] == s)
+				order.push_back(std::make_pair(_alpha[i], i));
+
+		// make room for the next hyperplane
+		if (order.size() < _maxSize)
+			continue;
+
+		// fold the hyperplanes with the smallest multipliers into one, such
+		// that maxSize - 1 remain
+		unsigned int numFold = order.size() - _maxSize + 2;
+
+		std::sort(order.begin(), order.end());
+
+		std::vector<bool> fold(_alpha.size(), false);
+		for (unsigned int k = 0; k < numFold; k++)
+			fold[order[k].second] = true;
+
+		aggregateHyperplanes(fold);
+	}
+}
+
+void
+DualBundleSolver::aggregateHyperplanes(const std::vector<bool>& fold) {
+
+	unsigned int t = _alpha.size();
+
+	unsigned int slack     = 0;
+	unsigned int numFold   = 0;
+	double       alphaFold = 0;
+	for (unsigned int i = 0; i < t; i++)
+		if (fold[i]) {
+
+			slack      = _slack[i];
+			alphaFold += _alpha[i];
+			numFold++;
+		}
+
+	LOG_DEBUG(dualbundlesolverlog)
+			<< "aggregating " << numFold << " hyperplanes with total multiplier "
+			<< alphaFold << std::endl;
+
+	// hyperplanes without weight can just be dropped
+	if (alphaFold == 0) {
+
+		removeHyperplanes(fold);
+		return;
+	}
+
+	// the aggregate and its Gram entries as convex combinations of the folded
+	// hyperplanes
+	std::vector<double> a(_dims, 0.0);
+	double              b = 0;
+	std::vector<double> row(t, 0.0);
+	double              diagonal = 0;
+	std::vector<double> weights(t, 0.0);
+
+	for (unsigned int i = 0; i < t; i++) {
+
+		if (!fold[i] || _alpha[i] == 0)
+			continue;
+
+		double s = _alpha[i]/alphaFold;
+
+		weights[i] = s;
+		b += s*_b[i];
+
+		for (unsigned int j = 0; j < t; j++)
+			row[j] += s*_gram[i][j];
+
+		for (unsigned int k = 0; k < t; k++)
+			if (fold[k])
+				diagonal += s*(_alpha[k]/alphaFold)*_gram[i][k];
+	}
+
+	accumulateGradients(weights, a);
+
+	// keep only the entries of the remaining hyperplanes
+	std::vector<double> newRow;
+	for (unsigned int j = 0; j < t; j++)
+		if (!fold[j])
+			newRow.push_back(row[j]);
+
+	removeHyperplanes(fold);
+
+	for (unsigned int j = 0; j < newRow.size(); j++)
+		_gram[j].push_back(newRow[j]);
+	newRow.push_back(diagonal);
+
+	_gram.push_back(newRow);
+	_a.push_back(a);
+	_b.push_back(b);
+	_slack.push_back(slack);
+	_ids.push_back(NoId);
+	_alpha.push_back(alphaFold);
+	_inactive.push_back(0);
+}
+
+void
+DualBundleSolver::removeHyperplanes(const std::vector<bool>& remove) {
+
+	unsigned int t = _alpha.size();
+	unsigned int n = 0;
+
+	for (unsigned int i = 0; i < t; i++) {
+
+		if (remove[i]) {
+
+			if (_ids[i] != NoId)
+				_store->remove(_ids[i]);
+
+			continue;
+		}
+
+		unsigned int m = 0;
+		for (unsigned int j = 0; j < t; j++)
+			if (!remove[j])
+				_gram[i][m++] = _gram[i][j];
+		_gram[i].resize(m);
+
+		if (n != i) {
+
+			_gram[n].swap(_gram[i]);
+			_a[n].swap(_a[i]);
+			_b[n]        = _b[i];
+			_slack[n]    = _slack[i];
+			_ids[n]      = _ids[i];
+			_alpha[n]    = _alpha[i];
+			_inactive[n] = _inactive[i];
+		}
+
+		n++;
+	}
+
+	_gram.resize(n);
+	_a.resize(n);
+	_b.resize(n);
+	_slack.resize(n);
+	_ids.resize(n);
+	_alpha.resize(n);
+	_inactive.resize(n);
+}
@@ -0,0 +1,157 @@
+#ifndef SBMRM_BUNDLE_DUAL_BUNDLE_SOLVER_H__
+#define SBMRM_BUNDLE_DUAL_BUNDLE_SOLVER_H__
+
+#include <vector>
+
+#include "BundleSolver.h"
+
+/**
+ * Solves the bundle master problem in its dual form
+ *
+ *   α* = argmax_α <b,α> - 1/(2λ) αᵀGα,  s.t. α ≥ 0, Σ_{i∈I_s} α_i = 1 ∀s
+ *
+ * where G_ij = <a_i,a_j> is the Gram matrix of the hyperplane gradients. The
+ * primal solution is recovered as w* = -1/λ Σ_i α_i a_i.
+ *
+ * The dual has only as many variables as there are hyperplanes, which is
+ * usually much smaller than the size of w. It is solved with pairwise
+ * (SMO-style) steps within each simplex, warm-started from the previous
+ * multipliers. Each pairwise step is followed by Newton steps on the support
+ * of α, such that the solver works like an active set method.
+ * The Gram matrix is grown incrementally whenever a hyperplane is added.
+ *
+ * After each solve, hyperplanes whose multipliers stayed zero for
+ * maxInactive consecutive calls are removed. If a set I_s reached maxSize
+ * hyperplanes, the ones with the smallest multipliers are folded into a
+ * single aggregate hyperplane Σ_i α_i(a_i,b_i)/Σ_i α_i, which carries their
+ * summed multiplier (Kiwiel's aggregation). Both keep the current α optimal.
+ *
+ * With a gradient store, the gradients of hyperplanes added through
+ * addStoredHyperplane() are not kept by the solver. Their Gram entries are
+ * computed once by the store, and w* by accumulating the gradients with
+ * non-zero multipliers. Aggregates are kept as dense vectors.
+ */
+class DualBundleSolver : public BundleSolver {
+
+public:
+
+	/**
+	 * @param dims
+	 *           The size of the vector w.
+	 * @param numSlacks
+	 *           The number of lower bounds ℒ_s.
+	 * @param regularizerWeight
+	 *           The weight λ of the quadratic regularizer.
+	 * @param eps
+	 *           Stop, if the duality gap of the master problem is below this
+	 *           value.
+	 * @param maxInactive
+	 *           Remove hyperplanes with zero multiplier after this many
+	 *           consecutive solves. 0 keeps them forever.
+	 * @param maxSize
+	 *           The maximal number of hyperplanes per lower bound ℒ_s (at
+	 *           least 2). 0 for no limit.
+	 */
+	DualBundleSolver(
+			unsigned int dims,
+			unsigned int numSlacks,
+			double       regularizerWeight,
+			double       eps,
+			unsigned int maxInactive = 0,
+			unsigned int maxSize = 0);
+
+	void addHyperplane(const std::vector<double>& a, double b, unsigned int slack);
+
+	bool setGradientStore(boost::shared_ptr<GradientStore> store);
+
+	void addStoredHyperplane(const std::vector<double>& a, double b, unsigned int slack, unsigned int id);
+
+	/**
+	 * Find the minimizer of the master problem. The value reported is the
+	 * value of the dual, i.e., a lower bound on the optimal value of the
+	 * master problem.
+	 */
+	void solve(std::vector<double>& w, double& value);
+
+	unsigned int size() const { return _a.size(); }
+
+	void getHyperplanes(
+			std::vector<std::vector<double> >& a,
+			std::vector<double>&               b,
+			std::vector<unsigned int>&         slacks) const;
+
+private:
+
+	// add a hyperplane with gradient a, kept in the gradient store under id
+	// or, if id is NoId, by the solver
+	void appendHyperplane(const std::vector<double>& a, double b, unsigned int slack, unsigned int id);
+
+	// add Σ_i weights[i] a_i to x, for all hyperplanes i with non-zero weight
+	void accumulateGradients(const std::vector<double>& weights, std::vector<double>& x) const;
+
+	// perform SMO steps until the duality gap is small enough, returns the
+	// value of the dual
+	double optimizeMultipliers();
+
+	enum StepResult {
+
+		NoStep,
+
+		// the step was cut short, since a multiplier became zero
+		PartialStep,
+
+		FullStep
+	};
+
+	// move α towards the optimum on its current support, updates the
+	// gradient g of the dual
+	StepResult newtonStep(std::vector<double>& g);
+
+	// remove inactive hyperplanes and aggregate if the bundle is too large
+	void limitBundle();
+
+	// fold all hyperplanes i with fold[i] == true (all of the same slack)
+	// into a single one
+	void aggregateHyperplanes(const std::vector<bool>& fold);
+
+	// remove all hyperplanes i with remove[i] == true
+	void removeHyperplanes(const std::vector<bool>& remove);
+
+	// the size of w
+	unsigned int _dims;
+
+	// the number of lower bounds ℒ_s
+	unsigned int _numSlacks;
+
+	// the weight of the regularizer
+	double _lambda;
+
+	// convergence threshold on the duality gap
+	double _eps;
+
+	// limits on the bundle size
+	unsigned int _maxInactive;
+	unsigned int _maxSize;
+
+	// the hyperplanes and the lower bound they belong to, _a[i] is empty for
+	// hyperplanes in the gradient store
+	std::vector<std::vector<double> > _a;
+	std::vector<double>               _b;
+	std::vector<unsigned int>         _slack;
+
+	// optional store for the gradients and the ids of the hyperplanes in it
+	boost::shared_ptr<GradientStore> _store;
+	std::vector<unsigned int>        _ids;
+
+	// the Gram matrix of the a_i
+	std::vector<std::vector<double> > _gram;
+
+	// the dual multipliers
+	std::vector<double> _alpha;
+
+	// the number of consecutive solves each multiplier stayed zero
+	std::vector<unsigned int> _inactive;
+};
+
+#endif // SBMRM_BUNDLE_DUAL_BUNDLE_SOLVER_H__
+
@@ -0,0 +1,52 @@
+#ifndef SBMRM_BUNDLE_GRADIENT_STORE_H__
+#define SBMRM_BUNDLE_GRADIENT_STORE_H__
+
+#include <vector>
+
+/**
+ * Interface for a compact store of the gradients a_i of the hyperplanes in
+ * the bundle. Instead of dense vectors, implementations keep what the
+ * gradients were computed from (e.g., the labelings y* of a structured loss)
+ * and compute products with the gradients on demand.
+ *
+ * The store is not given the gradients themselves: add() keeps the gradient
+ * of a summand L_s as it was returned by the most recent evaluation of the
+ * objective.
+ */
+class GradientStore {
+
+public:
+
+	virtual ~GradientStore() {}
+
+	/**
+	 * Keep the gradient of summand s of the most recent evaluation.
+	 *
+	 * @return An id to refer to the gradient.
+	 */
+	virtual unsigned int add(unsigned int summand) = 0;
+
+	/**
+	 * Forget the gradient with the given id.
+	 */
+	virtual void remove(unsigned int id) = 0;
+
+	/**
+	 * Compute the products <a,a_i> of a with the gradients of the given ids.
+	 */
+	virtual void dots(
+			const std::vector<double>&       a,
+			const std::vector<unsigned int>& ids,
+			std::vector<double>&             products) = 0;
+
+	/**
+	 * Add Σ_k weights[k] a_ids[k] to a.
+	 */
+	virtual void accumulate(
+			const std::vector<unsigned int>& ids,
+			const std::vector<double>&       weights,
+			std::vector<double>&             a) = 0;
+};
+
+#endif // SBMRM_BUNDLE_GRADIENT_STORE_H__
+
@@ -0,0 +1,207 @@
+#include <cmath>
+
+#include <util/Logger.h>
+#include <util/foreach.h>
+#include "QuadraticBundleSolver.h"
+
+logger::LogChannel quadraticbundlesolverlog("quadraticbundlesolverlog", "[QuadraticBundleSolver] ");
+
+// relative distance to ξ up to which a hyperplane is considered tight
+static const double ActivityTolerance = 1e-6;
+
+QuadraticBundleSolver::QuadraticBundleSolver(
+		unsigned int dims,
+		unsigned int numSlacks,
+		double       regularizerWeight,
+		unsigned int maxInactive,
+		unsigned int maxSize) :
+	_dims(dims),
+	_numSlacks(numSlacks),
+	_lambda(regularizerWeight),
+	_maxInactive(maxInactive),
+	_maxSize(maxSize > 0 ? std::max(maxSize, 2u) : 0) {
+
+	setupQp();
+}
+
+void
+QuadraticBundleSolver::addHyperplane(const std::vector<double>& a, double b, unsigned int slack) {
+
+	if (slack == _numSlacks)
+		_bundleCollector->addAggregateHyperplane(a, b, _numSlacks);
+	else
+		_bundleCollector->addHyperplane(a, b, slack);
+
+	_inactive.push_back(0);
+	_slack.push_back(slack);
+}
+
+void
+QuadraticBundleSolver::getHyperplanes(
+		std::vector<std::vector<double> >& a,
+		std::vector<double>&               b,
+		std::vector<unsigned int>&         slacks) const {
+
+	unsigned int t = _hyperplanes->size();
+
+	a.assign(t, std::vector<double>(_dims, 0.0));
+	b.resize(t);
+	slacks = _slack;
+
+	const unsigned int* variables    = _hyperplanes->getVariables();
+	const double*       coefficients = _hyperplanes->getCoefficients();
+
+	for (unsigned int i = 0; i < t; i++) {
+
+		// the constraint reads <w,a_i> - Σ_s ξ_s ≤ -b_i
+		b[i] = -_hyperplanes->getValue(i);
+
+		for (size_t k = _hyperplanes->getRowStart(i); k < _hyperplanes->getRowStart(i + 1); k++)
+			if (variables[k] < _dims)
+				a[i][variables[k]] = coefficients[k];
+	}
+}
+
+void
+QuadraticBundleSolver::solve(std::vector<double>& w, double& value) {
+
+	// read the solution (pipeline magic!)
+	for (unsigned int i = 0; i < _dims; i++)
+		w[i] = (*_qpSolution)[i];
+
+	value = _qpSolution->getValue();
+
+	std::vector<double> xi(_numSlacks);
+	for (unsigned int s = 0; s < _numSlacks; s++)
+		xi[s] = (*_qpSolution)[_dims + s];
+
+	limitBundle(w, xi);
+}
+
+void
+QuadraticBundleSolver::limitBundle(const std::vector<double>& w, const std::vector<double>& xi) {
+
+	unsigned int t = _hyperplanes->size();
+
+	std::vector<bool> remove(t, false);
+	unsigned int numRemove = 0;
+
+	const unsigned int* variables    = _hyperplanes->getVariables();
+	const double*       coefficients = _hyperplanes->getCoefficients();
+
+	for (unsigned int i = 0; i < t; i++) {
+
+		// the constraint reads <w,a_i> - Σ_s ξ_s ≤ -b_i, where the sum is
+		// over the slacks the hyperplane bounds
+		double value = -_hyperplanes->getValue(i);
+		double bound = 0;
+
+		for (size_t k = _hyperplanes->getRowStart(i); k < _hyperplanes->getRowStart(i + 1); k++)
+			if (variables[k] < _dims)
+				value += coefficients[k]*w[variables[k]];
+			else
+				bound -= coefficients[k]*xi[variables[k] - _dims];
+
+		if (value < bound - ActivityTolerance*std::max(1.0, std::abs(bound)))
+			_inactive[i]++;
+		else
+			_inactive[i] = 0;
+
+		if (_maxInactive > 0 && _inactive[i] >= _maxInactive) {
+
+			remove[i] = true;
+			numRemove++;
+		}
+	}
+
+	if (numRemove > 0) {
+
+		LOG_DEBUG(quadraticbundlesolverlog) << "removing " << numRemove << " inactive hyperplanes" << std::endl;
+
+		_bundleCollector->removeHyperplanes(remove);
+
+		unsigned int n = 0;
+		for (unsigned int i = 0; i < t; i++)
+			if (!remove[i]) {
+
+				_inactive[n] = _inactive[i];
+				_slack[n]    = _slack[i];
+				n++;
+			}
+		_inactive.resize(n);
+		_slack.resize(n);
+		t = n;
+	}
+
+	if (_maxSize == 0)
+		return;
+
+	// make room for the next hyperplane of each lower bound (the aggregate
+	// counts for all of them)
+	std::vector<unsigned int> sizes(_numSlacks, 0);
+	bool full = false;
+	for (unsigned int i = 0; i < t; i++)
+		for (unsigned int s = 0; s < _numSlacks; s++)
+			if (_slack[i] == s || _slack[i] == _numSlacks)
+				full |= (++sizes[s] >= _maxSize);
+
+	if (!full)
+		return;
+
+	LOG_DEBUG(quadraticbundlesolverlog) << "aggregating all " << t << " hyperplanes" << std::endl;
+
+	/*
+	  At the optimum, w* = -1/λ Σ_i α_i a_i with Σ_{i∈I_s} α_i = 1 and
+	  <w*,a_i> + b_i = ξ*_s for all i∈I_s with α_i > 0. The aggregate
+	  Σ_i α_i (a_i,b_i) therefore bounds Σ_s ξ_s with
+
+	    a = -λw*
+	    b = Σ_s ξ*_s - <w*,a> = Σ_s ξ*_s + λ|w*|²
+	*/
+
+	std::vector<double> a(_dims);
+	double b = 0;
+	for (unsigned int s = 0; s < _numSlacks; s++)
+		b += xi[s];
+	for (unsigned int j = 0; j < _dims; j++) {
+
+		a[j] = -_lambda*w[j];
+		b   +=  _lambda*w[j]*w[j];
+	}
+
+	_bundleCollector->removeHyperplanes(std::vector<bool>(t, true));
+	_inactive.clear();
+	_slack.clear();
+
+	// with a single lower bound, the aggregate is an ordinary hyperplane
+	addHyperplane(a, b, _numSlacks == 1 ? 0 : _numSlacks);
+}
+
+void
+QuadraticBundleSolver::setupQp() {
+
+	/*
+	  w* = argmin λ½|w|² + Σ_s ξ_s, s.t. <w,a_i> + b_i ≤ ξ_s ∀i∈I_s
+	*/
+
+	// one variable for each component of w and for each ξ_s
+	_qpObjective->resize(_dims + _numSlacks);
+
+	// regularizer
+	for (unsigned int i = 0; i < _dims; i++)
+		_qpObjective->setQuadraticCoefficient(i, i, 0.5*_lambda);
+
+	// ξ_s
+	for (unsigned int s = 0; s < _numSlacks; s++)
+		_qpObjective->setCoefficient(_dims + s, 1.0);
+
+	// we minimize
+	_qpObjective->setSense(Minimize);
+
+	// connect pipeline
+	_qpSolver->setInput("objective", _qpObjective);
+	_hyperplanes = _bundleCollector->getOutput();
+	_qpSolver->setInput("linear constraints", _hyperplanes);
+	_qpSolver->setInput("parameters", _qpParameters);
+	_qpSolution = _qpSolver->getOutput("solution");
+}
@@ -0,0 +1,103 @@
+#ifndef SBMRM_BUNDLE_QUADRATIC_BUNDLE_SOLVER_H__
+#define SBMRM_BUNDLE_QUADRATIC_BUNDLE_SOLVER_H__
+
+#include <pipeline/Value.h>
+#include <pipeline/Process.h>
+#include <inference/QuadraticSolver.h>
+
+#include "BundleCollector.h"
+#include "BundleSolver.h"
+
+/**
+ * Solves the bundle master problem in its primal form
+ *
+ *   w* = argmin λ½|w|² + Σ_s ξ_s, s.t. <w,a_i> + b_i ≤ ξ_s ∀i∈I_s
+ *
+ * using a QuadraticSolver (and thus whatever backend the DefaultFactory
+ * provides).
+ *
+ * The backend does not report multipliers. A hyperplane is therefore
+ * considered inactive if it is not tight at the solution. If a set I_s
+ * reached maxSize hyperplanes, all hyperplanes are replaced by their
+ * aggregate <w,-λw*> + Σ_s ξ*_s + λ|w*|² ≤ Σ_s ξ_s, the only combination that
+ * can be recovered from the primal solution alone.
+ */
+class QuadraticBundleSolver : public BundleSolver {
+
+public:
+
+	/**
+	 * @param dims
+	 *           The size of the vector w.
+	 * @param numSlacks
+	 *           The number of lower bounds ℒ_s.
+	 * @param regularizerWeight
+	 *           The weight λ of the quadratic regularizer.
+	 * @param maxInactive
+	 *           Remove hyperplanes that are not tight after this many
+	 *           consecutive solves. 0 keeps them forever.
+	 * @param maxSize
+	 *           The maximal number of hyperplanes per lower bound ℒ_s (at
+	 *           least 2). 0 for no limit.
+	 */
+	QuadraticBundleSolver(
+			unsigned int dims,
+			unsigned int numSlacks,
+			double       regularizerWeight,
+			unsigned int maxInactive = 0,
+			unsigned int maxSize = 0);
+
+	/**
+	 * Add a hyperplane to ℒ_slack, or to the sum of all ℒ_s if slack equals
+	 * the number of lower bounds.
+	 */
+	void addHyperplane(const std::vector<double>& a, double b, unsigned int slack);
+
+	void solve(std::vector<double>& w, double& value);
+
+	unsigned int size() const { return _hyperplanes->size(); }
+
+	void getHyperplanes(
+			std::vector<std::vector<double> >& a,
+			std::vector<double>&               b,
+			std::vector<unsigned int>&         slacks) const;
+
+private:
+
+	void setupQp();
+
+	// remove inactive hyperplanes and aggregate if the bundle is too large
+	void limitBundle(const std::vector<double>& w, const std::vector<double>& xi);
+
+	// the size of w
+	unsigned int _dims;
+
+	// the number of lower bounds ℒ_s
+	unsigned int _numSlacks;
+
+	// the weight of the regularizer
+	double _lambda;
+
+	// limits on the bundle size
+	unsigned int _maxInactive;
+	unsigned int _maxSize;
+
+	// the number of consecutive solves each hyperplane was not tight
+	std::vector<unsigned int> _inactive;
+
+	// the lower bound each hyperplane belongs to, _numSlacks for the
+	// aggregate
+	std::vector<unsigned int> _slack;
+
+	pipeline::Value<QuadraticObjective>        _qpObjective;
+	pipeline::Value<QuadraticSolverParameters> _qpParameters;
+
+	pipeline::Process<BundleCollector> _bundleCollector;
+	pipeline::Process<QuadraticSolver> _qpSolver;
+
+	pipeline::Value<LinearConstraints> _hyperplanes;
+	pipeline::Value<Solution>          _qpSolution;
+};
+
+#endif // SBMRM_BUNDLE_QUADRATIC_BUNDLE_SOLVER_H__
+
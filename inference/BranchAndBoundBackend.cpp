@@ -0,0 +1,532 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <boost/bind/bind.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <util/Logger.h>
+#include <util/ProgramOptions.h>
+#include <util/foreach.h>
+#include "BranchAndBoundBackend.h"
+
+using namespace logger;
+
+LogChannel branchandboundlog("branchandboundlog", "[BranchAndBoundBackend] ");
+
+util::ProgramOption optionBranchAndBoundMIPGap(
+		util::_module           = "inference.branchAndBound",
+		util::_long_name        = "mipGap",
+		util::_description_text = "The relative optimality gap of the built-in branch-and-bound solver.",
+		util::_default_value    = 0.0001);
+
+util::ProgramOption optionBranchAndBoundNumThreads(
+		util::_module           = "inference.branchAndBound",
+		util::_long_name        = "numThreads",
+		util::_description_text = "The number of threads to search the branch-and-bound tree with. Each thread keeps its "
+		                          "own copy of the linear relaxation.",
+		util::_default_value    = 1);
+
+// values of the relaxation closer than this to 0 or 1 are integral
+static const double IntegralityTolerance = 1e-6;
+
+// the tolerance on the violation of constraints by an incumbent
+static const double FeasibilityTolerance = 1e-6;
+
+// a dive stops if its bound is larger than the best open bound plus this
+// fraction of the gap between the best open bound and the incumbent
+static const double DiveGap = 0.5;
+
+BranchAndBoundBackend::BranchAndBoundBackend() :
+	_numVariables(0),
+	_constant(0),
+	_sense(1),
+	_absoluteGap(0),
+	_relativeGap(optionBranchAndBoundMIPGap.as<double>()),
+	_numThreads(std::max(1, optionBranchAndBoundNumThreads.as<int>())),
+	_incumbentValue(0),
+	_numBusy(0),
+	_numNodes(0),
+	_prunedBound(0),
+	_stop(false) {}
+
+void
+BranchAndBoundBackend::initialize(
+		unsigned int numVariables,
+		VariableType variableType) {
+
+	initialize(numVariables, variableType, std::map<unsigned int, VariableType>());
+}
+
+void
+BranchAndBoundBackend::initialize(
+		unsigned int                                numVariables,
+		VariableType                                defaultVariableType,
+		const std::map<unsigned int, VariableType>& specialVariableTypes) {
+
+	unsigned int v;
+	VariableType type;
+	foreach (boost::tie(v, type), specialVariableTypes)
+		if (type != Binary)
+			defaultVariableType = type;
+
+	if (defaultVariableType != Binary)
+		BOOST_THROW_EXCEPTION(
+				BranchAndBoundError() <<
+						error_message("the built-in branch-and-bound solver supports only binary variables"));
+
+	LOG_DEBUG(branchandboundlog) << "creating " << numVariables << " binary variables" << std::endl;
+
+	_numVariables = numVariables;
+	_costs.assign(_numVariables, 0.0);
+	_incumbent.clear();
+	_root.reset();
+}
+
+void
+BranchAndBoundBackend::setObjective(const LinearObjective& objective) {
+
+	_sense    = (objective.getSense() == Minimize ? 1.0 : -1.0);
+	_constant = objective.getConstant();
+
+	const std::vector<double>& coefficients = objective.getCoefficients();
+
+	for (unsigned int i = 0; i < _numVariables; i++)
+		_costs[i] = (i < coefficients.size() ? _sense*coefficients[i] : 0.0);
+}
+
+void
+BranchAndBoundBackend::setConstraints(const LinearConstraints& constraints) {
+
+	LOG_DEBUG(branchandboundlog) << "setting " << constraints.size() << " constraints" << std::endl;
+
+	_constraints.clear();
+	_constraints.addAll(constraints);
+
+	_root.reset();
+}
+
+void
+BranchAndBoundBackend::addConstraint(const LinearConstraint& constraint) {
+
+	_constraints.add(constraint);
+
+	_root.reset();
+}
+
+void
+BranchAndBoundBackend::setAbsoluteGap(double gap) {
+
+	_absoluteGap = gap;
+}
+
+bool
+BranchAndBoundBackend::solve(Solution& x, double& value, std::string& msg) {
+
+	if (!_root)
+		_root.reset(new DualSimplex(_numVariables, _constraints));
+
+	_root->setCosts(_costs);
+
+	// start from the previous solution, if it is still feasible
+	if (_incumbent.size() == _numVariables && isFeasible(_incumbent)) {
+
+		_incumbentValue = evaluate(_incumbent);
+
+		LOG_ALL(branchandboundlog) << "previous solution is feasible with value " << _incumbentValue << std::endl;
+
+	} else {
+
+		_incumbent.clear();
+		_incumbentValue = std::numeric_limits<double>::infinity();
+	}
+
+	_open.clear();
+	_numBusy     = 0;
+	_numNodes    = 0;
+	_prunedBound = std::numeric_limits<double>::infinity();
+	_stop        = false;
+
+	unsigned long rootPivots = _root->getNumPivots();
+
+	// the root relaxation on _root, such that its basis is kept for the next
+	// solve, all threads start from copies of it
+	DualSimplex::Status status = _root->solve(getCutoff());
+
+	if (status == DualSimplex::Infeasible) {
+
+		msg = "problem is infeasible";
+		return false;
+	}
+
+	Node root;
+	root.bound = (status == DualSimplex::IterationLimit ? -std::numeric_limits<double>::infinity() : _root->getValue());
+	pushNode(root);
+
+	unsigned int numThreads = _numThreads;
+
+	std::vector<DualSimplex>          relaxations(numThreads, *_root);
+	std::vector<boost::exception_ptr> exceptions(numThreads);
+
+	boost::thread_group workers;
+	for (unsigned int i = 1; i < numThreads; i++)
+		workers.create_thread(
+				boost::bind(
+						&BranchAndBoundBackend::work,
+						this,
+						boost::ref(relaxations[i]),
+						boost::ref(exceptions[i])));
+	work(relaxations[0], exceptions[0]);
+	workers.join_all();
+
+	for (unsigned int i = 0; i < numThreads; i++)
+		if (exceptions[i])
+			boost::rethrow_exception(exceptions[i]);
+
+	unsigned long numPivots = _root->getNumPivots() - rootPivots;
+	for (unsigned int i = 0; i < numThreads; i++)
+		numPivots += relaxations[i].getNumPivots() - _root->getNumPivots();
+
+	LOG_DEBUG(branchandboundlog) << "explored " << _numNodes << " nodes with " << numPivots << " pivots" << std::endl;
+
+	if (_incumbent.empty()) {
+
+		msg = "problem is infeasible";
+		return false;
+	}
+
+	x.resize(_numVariables);
+	for (unsigned int i = 0; i < _numVariables; i++)
+		x[i] = _incumbent[i];
+
+	value = _sense*_incumbentValue + _constant;
+
+	x.setValue(value);
+	x.setBound(_sense*std::min(_incumbentValue, _prunedBound) + _constant);
+
+	msg = "Optimal solution found after " + boost::lexical_cast<std::string>(_numNodes) + " nodes";
+
+	return true;
+}
+
+void
+BranchAndBoundBackend::work(DualSimplex& relaxation, boost::exception_ptr& exception) {
+
+	// the fixings currently set in the relaxation
+	std::vector<unsigned int> applied;
+
+	Node node;
+
+	try {
+
+		while (nextNode(node)) {
+
+			dive(relaxation, node, applied);
+
+			boost::mutex::scoped_lock lock(_mutex);
+
+			_numBusy--;
+
+			if (_numBusy == 0 && _open.empty())
+				_nodeAvailable.notify_all();
+		}
+
+	} catch (...) {
+
+		exception = boost::current_exception();
+
+		boost::mutex::scoped_lock lock(_mutex);
+
+		_stop = true;
+		_nodeAvailable.notify_all();
+	}
+}
+
+bool
+BranchAndBoundBackend::nextNode(Node& node) {
+
+	boost::mutex::scoped_lock lock(_mutex);
+
+	while (_open.empty() && _numBusy > 0 && !_stop)
+		_nodeAvailable.wait(lock);
+
+	if (_open.empty() || _stop)
+		return false;
+
+	std::pop_heap(_open.begin(), _open.end(), NodeOrder(_incumbent.empty()));
+	node = _open.back();
+	_open.pop_back();
+	_numBusy++;
+
+	return true;
+}
+
+void
+BranchAndBoundBackend::pushNode(const Node& node) {
+
+	_open.push_back(node);
+	std::push_heap(_open.begin(), _open.end(), NodeOrder(_incumbent.empty()));
+
+	_nodeAvailable.notify_one();
+}
+
+void
+BranchAndBoundBackend::dive(DualSimplex& relaxation, Node& node, std::vector<unsigned int>& applied) {
+
+	std::vector<char> rounded(_numVariables);
+
+	while (true) {
+
+		double cutoff = getCutoff();
+
+		if (node.bound >= cutoff) {
+
+			prune(node.bound);
+			return;
+		}
+
+		applyFixings(relaxation, node.fixings, applied);
+
+		DualSimplex::Status status = relaxation.solve(cutoff);
+
+		{
+			boost::mutex::scoped_lock lock(_mutex);
+			_numNodes++;
+		}
+
+		if (status == DualSimplex::Infeasible)
+			return;
+
+		if (status == DualSimplex::Cutoff) {
+
+			prune(relaxation.getValue());
+			return;
+		}
+
+		bool optimal = (status == DualSimplex::Optimal);
+
+		if (optimal)
+			node.bound = std::max(node.bound, relaxation.getValue());
+
+		// branch on the most fractional variable, or on any free variable if
+		// the relaxation could not be solved
+		int    branch        = -1;
+		double fractionality = IntegralityTolerance;
+
+		for (unsigned int i = 0; i < _numVariables; i++) {
+
+			if (relaxation.getLowerBound(i) == relaxation.getUpperBound(i))
+				continue;
+
+			double v = relaxation.getSolution(i);
+			double f = std::min(v, 1.0 - v);
+
+			if (!optimal) {
+
+				branch = i;
+				break;
+			}
+
+			if (f > fractionality) {
+
+				fractionality = f;
+				branch        = i;
+			}
+		}
+
+		if (optimal) {
+
+			// the rounded relaxation is the solution, if it is integral, and
+			// might be a better incumbent otherwise
+			for (unsigned int i = 0; i < _numVariables; i++)
+				rounded[i] = (relaxation.getSolution(i) >= 0.5);
+
+			updateIncumbent(rounded);
+		}
+
+		if (branch < 0)
+			return;
+
+		cutoff = getCutoff();
+
+		if (node.bound >= cutoff) {
+
+			prune(node.bound);
+			return;
+		}
+
+		// reduced cost fixing: moving a non-basic variable away from its
+		// bound increases the bound by at least its reduced cost
+		if (optimal && cutoff < std::numeric_limits<double>::infinity()) {
+
+			// the smallest bound of the subtrees cut off by fixing
+			double fixedBound = std::numeric_limits<double>::infinity();
+
+			for (unsigned int i = 0; i < _numVariables; i++) {
+
+				if (relaxation.isBasic(i) || relaxation.getLowerBound(i) == relaxation.getUpperBound(i))
+					continue;
+
+				double d = relaxation.getReducedCost(i);
+
+				if (relaxation.getSolution(i) == 0 && relaxation.getValue() + d >= cutoff) {
+
+					node.fixings.push_back(2*i);
+					fixedBound = std::min(fixedBound, relaxation.getValue() + d);
+
+				} else if (relaxation.getSolution(i) == 1 && relaxation.getValue() - d >= cutoff) {
+
+					node.fixings.push_back(2*i + 1);
+					fixedBound = std::min(fixedBound, relaxation.getValue() - d);
+				}
+			}
+
+			// the solutions cut off are within the gap of the incumbent, but
+			// not necessarily worse than it
+			if (fixedBound < std::numeric_limits<double>::infinity())
+				prune(fixedBound);
+		}
+
+		bool up = (relaxation.getSolution(branch) >= 0.5);
+
+		Node other = node;
+		other.fixings.push_back(2*branch + (up ? 0 : 1));
+		node.fixings.push_back(2*branch + (up ? 1 : 0));
+
+		boost::mutex::scoped_lock lock(_mutex);
+
+		pushNode(other);
+
+		// continue with the best open node instead, if the dive got too far
+		// away from it
+		if (_incumbent.empty())
+			continue;
+
+		double best = _open.front().bound;
+
+		if (node.bound > best + DiveGap*(_incumbentValue - best)) {
+
+			pushNode(node);
+			return;
+		}
+	}
+}
+
+void
+BranchAndBoundBackend::applyFixings(
+		DualSimplex&                     relaxation,
+		const std::vector<unsigned int>& fixings,
+		std::vector<unsigned int>&       applied) {
+
+	foreach (unsigned int fixing, applied)
+		relaxation.setBounds(fixing/2, 0.0, 1.0);
+
+	foreach (unsigned int fixing, fixings)
+		relaxation.setBounds(fixing/2, fixing%2, fixing%2);
+
+	applied = fixings;
+}
+
+double
+BranchAndBoundBackend::getCutoff() {
+
+	boost::mutex::scoped_lock lock(_mutex);
+
+	if (_incumbent.empty())
+		return std::numeric_limits<double>::infinity();
+
+	double gap = std::max(_absoluteGap, _relativeGap*std::abs(_sense*_incumbentValue + _constant));
+
+	// the default absolute gap
+	gap = std::max(gap, 1e-9);
+
+	return _incumbentValue - gap;
+}
+
+void
+BranchAndBoundBackend::prune(double bound) {
+
+	boost::mutex::scoped_lock lock(_mutex);
+
+	_prunedBound = std::min(_prunedBound, bound);
+}
+
+void
+BranchAndBoundBackend::updateIncumbent(const std::vector<char>& x) {
+
+	double value = evaluate(x);
+
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+
+		if (!_incumbent.empty() && value >= _incumbentValue)
+			return;
+	}
+
+	if (!isFeasible(x))
+		return;
+
+	boost::mutex::scoped_lock lock(_mutex);
+
+	if (!_incumbent.empty() && value >= _incumbentValue)
+		return;
+
+	LOG_ALL(branchandboundlog) << "found solution with value " << value << std::endl;
+
+	// the open nodes are ordered by bound from now on
+	if (_incumbent.empty())
+		std::make_heap(_open.begin(), _open.end(), NodeOrder(false));
+
+	_incumbent      = x;
+	_incumbentValue = value;
+}
+
+bool
+BranchAndBoundBackend::isFeasible(const std::vector<char>& x) const {
+
+	const unsigned int* variables    = _constraints.getVariables();
+	const double*       coefficients = _constraints.getCoefficients();
+
+	for (unsigned int j = 0; j < _constraints.size(); j++) {
+
+		double activity = 0;
+		for (size_t k = _constraints.getRowStart(j); k < _constraints.getRowStart(j + 1); k++)
+			if (x[variables[k]])
+				activity += coefficients[k];
+
+		double value     = _constraints.getValue(j);
+		double tolerance = FeasibilityTolerance*(1.0 + std::abs(value));
+
+		switch (_constraints.getRelation(j)) {
+
+			case LessEqual:
+				if (activity > value + tolerance)
+					return false;
+				break;
+
+			case GreaterEqual:
+				if (activity < value - tolerance)
+					return false;
+				break;
+
+			case Equal:
+				if (std::abs(activity - value) > tolerance)
+					return false;
+				break;
+		}
+	}
+
+	return true;
+}
+
+double
+BranchAndBoundBackend::evaluate(const std::vector<char>& x) const {
+
+	double value = 0;
+	for (unsigned int i = 0; i < _numVariables; i++)
+		if (x[i])
+			value += _costs[i];
+
+	return value;
+}
+
@@ -0,0 +1,167 @@
+#ifndef INFERENCE_BRANCH_AND_BOUND_BACKEND_H__
+#define INFERENCE_BRANCH_AND_BOUND_BACKEND_H__
+
+#include <string>
+#include <vector>
+
+#include <boost/exception_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include <util/exceptions.h>
+#include "DualSimplex.h"
+#include "LinearConstraints.h"
+#include "LinearSolverBackend.h"
+
+struct BranchAndBoundError : virtual Exception {};
+
+/**
+ * A built-in solver for binary linear programs
+ *
+ * min  <a,x>
+ * s.t. Ax (≤,=,≥) b
+ *      x ∈ {0,1}^n
+ *
+ * which does not need any external solver. Only Binary variables are
+ * supported.
+ *
+ * The problem is solved by branch-and-bound on the linear relaxation (see
+ * DualSimplex), which gives a bound for each node. Variables whose reduced
+ * cost proves that changing them cannot lead to a better solution than the
+ * incumbent are fixed in the subtree of the node. Each thread dives depth-
+ * first into the child closer to the relaxed solution and puts the other one
+ * into a queue of open nodes. Until a first solution is found, the deepest
+ * open node is processed next. Afterwards, the open nodes are ordered by
+ * their bound, and a dive ends if its bound gets much worse than the best
+ * open node, which is then processed next.
+ *
+ * The solution of the previous call to solve() is used as the first
+ * incumbent if it is still feasible, and the relaxation starts from the
+ * previous root basis, such that repeated solves with slightly changed
+ * objectives (like in the bundle method) are cheap.
+ */
+class BranchAndBoundBackend : public LinearSolverBackend {
+
+public:
+
+	BranchAndBoundBackend();
+
+	///////////////////////////////////
+	// solver backend implementation //
+	///////////////////////////////////
+
+	void initialize(
+			unsigned int numVariables,
+			VariableType variableType);
+
+	void initialize(
+			unsigned int                                numVariables,
+			VariableType                                defaultVariableType,
+			const std::map<unsigned int, VariableType>& specialVariableTypes);
+
+	void setObjective(const LinearObjective& objective);
+
+	void setConstraints(const LinearConstraints& constraints);
+
+	void addConstraint(const LinearConstraint& constraint);
+
+	void setAbsoluteGap(double gap);
+
+	bool solve(Solution& solution, double& value, std::string& message);
+
+private:
+
+	/**
+	 * A node of the search tree, given by the variables fixed in it.
+	 */
+	struct Node {
+
+		// a lower bound on the value of all solutions in the subtree
+		double bound;
+
+		// 2*i for x_i = 0, 2*i + 1 for x_i = 1
+		std::vector<unsigned int> fixings;
+	};
+
+	/**
+	 * The order of open nodes: the deepest node comes first as long as there
+	 * is no incumbent, the node with the smallest bound afterwards.
+	 */
+	struct NodeOrder {
+
+		NodeOrder(bool depthFirst_) : depthFirst(depthFirst_) {}
+
+		// true, if a is to be processed after b
+		bool operator()(const Node& a, const Node& b) const {
+
+			if (depthFirst && a.fixings.size() != b.fixings.size())
+				return a.fixings.size() < b.fixings.size();
+
+			return a.bound > b.bound;
+		}
+
+		bool depthFirst;
+	};
+
+	// the search of one thread on its own copy of the relaxation
+	void work(DualSimplex& relaxation, boost::exception_ptr& exception);
+
+	// add an open node, _mutex has to be locked
+	void pushNode(const Node& node);
+
+	// get the next open node, false if the search is done
+	bool nextNode(Node& node);
+
+	// process a node and dive into its children
+	void dive(DualSimplex& relaxation, Node& node, std::vector<unsigned int>& applied);
+
+	// set the bounds of the relaxation for the fixings of a node
+	void applyFixings(DualSimplex& relaxation, const std::vector<unsigned int>& fixings, std::vector<unsigned int>& applied);
+
+	// the value below which a node has to be to be explored
+	double getCutoff();
+
+	// remember the bound of a discarded node
+	void prune(double bound);
+
+	// replace the incumbent, if x is feasible and better
+	void updateIncumbent(const std::vector<char>& x);
+
+	bool isFeasible(const std::vector<char>& x) const;
+
+	double evaluate(const std::vector<char>& x) const;
+
+	unsigned int _numVariables;
+
+	LinearConstraints _constraints;
+
+	// the costs to minimize, -a for maximization problems
+	std::vector<double> _costs;
+	double              _constant;
+	double              _sense;
+
+	double _absoluteGap;
+	double _relativeGap;
+
+	unsigned int _numThreads;
+
+	// the relaxation at the root, kept to warm-start the next solve
+	boost::scoped_ptr<DualSimplex> _root;
+
+	// the best solution found so far, kept between solves
+	std::vector<char> _incumbent;
+	double            _incumbentValue;
+
+	// the search state shared between threads, _open is a heap in NodeOrder
+	std::vector<Node> _open;
+	unsigned int      _numBusy;
+	unsigned long     _numNodes;
+	double            _prunedBound;
+	bool              _stop;
+
+	boost::mutex              _mutex;
+	boost::condition_variable _nodeAvailable;
+};
+
+#endif // INFERENCE_BRANCH_AND_BOUND_BACKEND_H__
+
@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+#include <util/Logger.h>
+#include "ClosedFormSolver.h"
+
+logger::LogChannel closedformsolverlog("closedformsolverlog", "[ClosedFormSolver] ");
+
+// the tolerance for integral right-hand sides
+static const double Tolerance = 1e-9;
+
+ClosedFormSolver::ClosedFormSolver(unsigned int numVariables, const LinearConstraints& constraints) :
+	_numVariables(numVariables),
+	_groupOf(numVariables, -1),
+	_applicable(true) {
+
+	const unsigned int* variables    = constraints.getVariables();
+	const double*       coefficients = constraints.getCoefficients();
+
+	// the last constraint each variable was seen in, to find duplicates
+	std::vector<unsigned int> seenIn(numVariables, constraints.size());
+
+	for (unsigned int i = 0; i < constraints.size() && _applicable; i++) {
+
+		size_t begin = constraints.getRowStart(i);
+		size_t end   = constraints.getRowStart(i + 1);
+
+		if (begin == end) {
+
+			// 0 (≤,=,≥) b
+			double b = constraints.getValue(i);
+
+			switch (constraints.getRelation(i)) {
+
+				case LessEqual:    _applicable = (b >= -Tolerance); break;
+				case GreaterEqual: _applicable = (b <= Tolerance); break;
+				case Equal:        _applicable = (std::abs(b) <= Tolerance); break;
+			}
+
+			continue;
+		}
+
+		double a = coefficients[begin];
+		int    g = _groupOf[variables[begin]];
+
+		if (a == 0) {
+
+			_applicable = false;
+			break;
+		}
+
+		if (g < 0) {
+
+			// a new group, none of its variables can be in another one
+			g = _groups.size();
+			_groups.push_back(Group());
+
+			for (size_t k = begin; k < end; k++) {
+
+				unsigned int v = variables[k];
+
+				if (coefficients[k] != a || _groupOf[v] >= 0) {
+
+					_applicable = false;
+					break;
+				}
+
+				_groupOf[v] = g;
+				seenIn[v]   = i;
+				_groups[g].variables.push_back(v);
+			}
+
+			_groups[g].minOnes = 0;
+			_groups[g].maxOnes = _groups[g].variables.size();
+
+		} else {
+
+			// an existing group, has to contain exactly the same variables
+			if (end - begin != _groups[g].variables.size()) {
+
+				_applicable = false;
+				break;
+			}
+
+			for (size_t k = begin; k < end; k++) {
+
+				unsigned int v = variables[k];
+
+				if (coefficients[k] != a || _groupOf[v] != g || seenIn[v] == i) {
+
+					_applicable = false;
+					break;
+				}
+
+				seenIn[v] = i;
+			}
+		}
+
+		if (_applicable && !addBounds(g, constraints, i))
+			_applicable = false;
+	}
+
+	if (_applicable)
+		LOG_DEBUG(closedformsolverlog)
+				<< "constraints bound the number of ones in " << _groups.size()
+				<< " disjoint groups, using the closed-form solution" << std::endl;
+	else
+		LOG_DEBUG(closedformsolverlog)
+				<< "constraints do not have a closed-form solution" << std::endl;
+}
+
+double
+ClosedFormSolver::solve(const LinearObjective& objective, std::vector<char>& x) {
+
+	const std::vector<double>& coefficients = objective.getCoefficients();
+
+	// the gain of setting a variable to 1
+	double sense = (objective.getSense() == Maximize ? 1.0 : -1.0);
+	double value = objective.getConstant();
+
+	x.assign(_numVariables, 0);
+
+	for (unsigned int i = 0; i < _numVariables; i++)
+		if (_groupOf[i] < 0 && sense*coefficients[i] > 0) {
+
+			x[i]   = 1;
+			value += coefficients[i];
+		}
+
+	for (unsigned int g = 0; g < _groups.size(); g++) {
+
+		const Group& group = _groups[g];
+
+		// take all variables with a positive gain, as far as the bounds allow
+		unsigned int numPositive = 0;
+
+		_candidates.clear();
+		for (unsigned int k = 0; k < group.variables.size(); k++) {
+
+			double gain = sense*coefficients[group.variables[k]];
+
+			_candidates.push_back(std::make_pair(gain, group.variables[k]));
+			if (gain > 0)
+				numPositive++;
+		}
+
+		unsigned int ones = std::min(std::max(numPositive, group.minOnes), group.maxOnes);
+
+		if (ones == 0)
+			continue;
+
+		if (ones < _candidates.size())
+			std::nth_element(
+					_candidates.begin(),
+					_candidates.begin() + (ones - 1),
+					_candidates.end(),
+					std::greater<std::pair<double, unsigned int> >());
+
+		for (unsigned int k = 0; k < ones; k++) {
+
+			x[_candidates[k].second] = 1;
+			value += coefficients[_candidates[k].second];
+		}
+	}
+
+	return value;
+}
+
+bool
+ClosedFormSolver::addBounds(unsigned int g, const LinearConstraints& constraints, unsigned int i) {
+
+	Group& group = _groups[g];
+
+	// a Σ x_i (≤,=,≥) b  ⇔  Σ x_i (≤,=,≥) b/a, with the relation flipped for
+	// a < 0
+	double   a        = constraints.getCoefficients()[constraints.getRowStart(i)];
+	double   bound    = constraints.getValue(i)/a;
+	Relation relation = constraints.getRelation(i);
+
+	if (a < 0 && relation != Equal)
+		relation = (relation == LessEqual ? GreaterEqual : LessEqual);
+
+	double size = group.variables.size();
+
+	if (relation != GreaterEqual) {
+
+		double maxOnes = std::floor(bound + Tolerance);
+
+		if (maxOnes < 0)
+			return false;
+
+		if (maxOnes < size)
+			group.maxOnes = std::min(group.maxOnes, static_cast<unsigned int>(maxOnes));
+	}
+
+	if (relation != LessEqual) {
+
+		double minOnes = std::ceil(bound - Tolerance);
+
+		if (minOnes > size)
+			return false;
+
+		if (minOnes > 0)
+			group.minOnes = std::max(group.minOnes, static_cast<unsigned int>(minOnes));
+	}
+
+	return group.minOnes <= group.maxOnes;
+}
+
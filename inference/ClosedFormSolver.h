@@ -0,0 +1,90 @@
+#ifndef INFERENCE_CLOSED_FORM_SOLVER_H__
+#define INFERENCE_CLOSED_FORM_SOLVER_H__
+
+#include <utility>
+#include <vector>
+
+#include "LinearConstraints.h"
+#include "LinearObjective.h"
+
+/**
+ * An exact solver for binary linear programs whose constraints only bound
+ * the number of ones in disjoint groups of variables, i.e., every constraint
+ * has the form
+ *
+ *   a Σ_{i ∈ G} x_i (≤,=,≥) b
+ *
+ * and two constraints either have the same group G or disjoint ones. This
+ * covers problems without constraints (every variable is set by the sign of
+ * its coefficient), "exactly/at most one" constraints per group (the best
+ * variable of each group is selected), and global cardinality bounds (the
+ * best k variables are selected).
+ *
+ * Whether the constraints have this structure is detected in the
+ * constructor, see isApplicable(). Each solve() then takes O(n) for n
+ * variables.
+ */
+class ClosedFormSolver {
+
+public:
+
+	/**
+	 * Detect the structure of the given constraints on numVariables binary
+	 * variables.
+	 */
+	ClosedFormSolver(unsigned int numVariables, const LinearConstraints& constraints);
+
+	/**
+	 * True, if the constraints have the structure described above and are
+	 * feasible.
+	 */
+	bool isApplicable() const { return _applicable; }
+
+	/**
+	 * The number of constrained groups of variables.
+	 */
+	unsigned int numGroups() const { return _groups.size(); }
+
+	/**
+	 * Find an optimal solution for the given objective. Only valid if
+	 * isApplicable().
+	 *
+	 * @param x
+	 *              The optimal solution, 0 or 1 for each variable.
+	 *
+	 * @return The value of the objective for x.
+	 */
+	double solve(const LinearObjective& objective, std::vector<char>& x);
+
+private:
+
+	/**
+	 * A group of variables with bounds on the number of ones in it.
+	 */
+	struct Group {
+
+		std::vector<unsigned int> variables;
+
+		unsigned int minOnes;
+		unsigned int maxOnes;
+	};
+
+	// restrict the bounds of group g for constraint i, false if they become
+	// empty
+	bool addBounds(unsigned int g, const LinearConstraints& constraints, unsigned int i);
+
+	unsigned int _numVariables;
+
+	std::vector<Group> _groups;
+
+	// the group of each variable, -1 if the variable is not constrained
+	std::vector<int> _groupOf;
+
+	bool _applicable;
+
+	// the gains and variables of one group, reused between solves
+	std::vector<std::pair<double, unsigned int> > _candidates;
+};
+
+#endif // INFERENCE_CLOSED_FORM_SOLVER_H__
+
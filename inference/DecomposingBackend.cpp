@@ -0,0 +1,404 @@
+#include <algorithm>
+#include <cmath>
+
+#include <boost/bind/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread.hpp>
+
+#include <util/Logger.h>
+#include <util/ProgramOptions.h>
+#include <util/foreach.h>
+#include "DecomposingBackend.h"
+
+using namespace logger;
+
+LogChannel decomposingbackendlog("decomposingbackendlog", "[DecomposingBackend] ");
+
+util::ProgramOption optionDecompositionNumThreads(
+		util::_module           = "inference.decomposition",
+		util::_long_name        = "numThreads",
+		util::_description_text = "The number of threads to solve the blocks of a decomposed problem with. The default (0) "
+		                          "uses as many threads as there are CPUs, or an equal share of them if several problems are "
+		                          "solved concurrently.",
+		util::_default_value    = 0);
+
+util::ProgramOption optionDecompositionMinBlockSize(
+		util::_module           = "inference.decomposition",
+		util::_long_name        = "minBlockSize",
+		util::_description_text = "Independent parts of a decomposed problem are combined into blocks of at least this many "
+		                          "variables, each of which is solved by its own backend.",
+		util::_default_value    = 1000);
+
+// the tolerance on the violation of constraints without variables
+static const double FeasibilityTolerance = 1e-6;
+
+DecomposingBackend::DecomposingBackend(boost::function<LinearSolverBackend*()> createBackend) :
+	_createBackend(createBackend),
+	_numVariables(0),
+	_variableType(Binary),
+	_binary(true),
+	_absoluteGap(0),
+	_numThreads(optionDecompositionNumThreads.as<unsigned int>()),
+	_maxThreads(0),
+	_minBlockSize(std::max(1u, optionDecompositionMinBlockSize.as<unsigned int>())),
+	_infeasible(false),
+	_dirty(true) {}
+
+void
+DecomposingBackend::initialize(
+		unsigned int numVariables,
+		VariableType variableType) {
+
+	initialize(numVariables, variableType, std::map<unsigned int, VariableType>());
+}
+
+void
+DecomposingBackend::initialize(
+		unsigned int                                numVariables,
+		VariableType                                defaultVariableType,
+		const std::map<unsigned int, VariableType>& specialVariableTypes) {
+
+	_numVariables         = numVariables;
+	_variableType         = defaultVariableType;
+	_specialVariableTypes = specialVariableTypes;
+
+	_binary = (defaultVariableType == Binary);
+
+	unsigned int v;
+	VariableType type;
+	foreach (boost::tie(v, type), specialVariableTypes)
+		if (type != Binary)
+			_binary = false;
+
+	_objective.resize(_numVariables);
+
+	_dirty = true;
+}
+
+void
+DecomposingBackend::setObjective(const LinearObjective& objective) {
+
+	const std::vector<double>& coefficients = objective.getCoefficients();
+
+	_objective.setSense(objective.getSense());
+	_objective.setConstant(objective.getConstant());
+
+	for (unsigned int i = 0; i < _numVariables; i++)
+		_objective.setCoefficient(i, i < coefficients.size() ? coefficients[i] : 0.0);
+}
+
+void
+DecomposingBackend::setConstraints(const LinearConstraints& constraints) {
+
+	_constraints.clear();
+	_constraints.addAll(constraints);
+
+	_dirty = true;
+}
+
+void
+DecomposingBackend::addConstraint(const LinearConstraint& constraint) {
+
+	_constraints.add(constraint);
+
+	_dirty = true;
+}
+
+void
+DecomposingBackend::setAbsoluteGap(double gap) {
+
+	_absoluteGap = gap;
+}
+
+void
+DecomposingBackend::setMaxThreads(unsigned int maxThreads) {
+
+	_maxThreads = maxThreads;
+}
+
+bool
+DecomposingBackend::solve(Solution& x, double& value, std::string& msg) {
+
+	if (_dirty) {
+
+		createBlocks();
+		_dirty = false;
+	}
+
+	if (_infeasible) {
+
+		msg = "problem is infeasible";
+		return false;
+	}
+
+	const std::vector<double>& coefficients = _objective.getCoefficients();
+
+	double sense = (_objective.getSense() == Maximize ? 1.0 : -1.0);
+
+	// the absolute gaps of the blocks add up
+	double gap = _absoluteGap/std::max<size_t>(1, _blocks.size());
+
+	// all CPUs, unless limited for concurrent problems
+	unsigned int numThreads = _numThreads;
+	if (numThreads == 0)
+		numThreads = (_maxThreads > 0 ? _maxThreads : std::max(1u, boost::thread::hardware_concurrency()));
+
+	unsigned int numWorkers = std::min<size_t>(numThreads, _blocks.size());
+
+	// the blocks solved concurrently share the threads
+	unsigned int blockThreads = std::max(1u, numThreads/std::max(1u, numWorkers));
+
+	foreach (boost::shared_ptr<Block> block, _blocks) {
+
+		block->objective.setSense(_objective.getSense());
+		for (unsigned int i = 0; i < block->variables.size(); i++)
+			block->objective.setCoefficient(i, coefficients[block->variables[i]]);
+
+		block->backend->setObjective(block->objective);
+		block->backend->setAbsoluteGap(gap);
+		block->backend->setMaxThreads(blockThreads);
+	}
+
+	_exceptions.assign(numWorkers, boost::exception_ptr());
+
+	// the calling thread is worker 0
+	boost::thread_group workers;
+	for (unsigned int k = 1; k < numWorkers; k++)
+		workers.create_thread(boost::bind(&DecomposingBackend::solveBlocks, this, k, numWorkers));
+	if (numWorkers > 0)
+		solveBlocks(0, numWorkers);
+	workers.join_all();
+
+	for (unsigned int k = 0; k < numWorkers; k++)
+		if (_exceptions[k])
+			boost::rethrow_exception(_exceptions[k]);
+
+	x.resize(_numVariables);
+
+	value        = _objective.getConstant();
+	double bound = _objective.getConstant();
+
+	foreach (unsigned int i, _unconstrained) {
+
+		x[i] = (sense*coefficients[i] > 0 ? 1.0 : 0.0);
+
+		value += x[i]*coefficients[i];
+		bound += x[i]*coefficients[i];
+	}
+
+	// combine the blocks in a fixed order, to get deterministic results
+	foreach (boost::shared_ptr<Block> block, _blocks) {
+
+		if (!block->solved) {
+
+			msg = block->message;
+			return false;
+		}
+
+		for (unsigned int i = 0; i < block->variables.size(); i++)
+			x[block->variables[i]] = block->solution[i];
+
+		value += block->value;
+		bound += block->solution.getBound();
+	}
+
+	x.setValue(value);
+	x.setBound(bound);
+
+	msg =
+			"Solved " + boost::lexical_cast<std::string>(_blocks.size()) + " blocks" +
+			(_blocks.size() == 1 ? ": " + _blocks[0]->message : std::string(""));
+
+	return true;
+}
+
+void
+DecomposingBackend::createBlocks() {
+
+	unsigned int n = _numVariables;
+
+	_blocks.clear();
+	_unconstrained.clear();
+	_infeasible = false;
+
+	const unsigned int* variables    = _constraints.getVariables();
+	const double*       coefficients = _constraints.getCoefficients();
+
+	// find the components with union-find
+	std::vector<unsigned int> parent(n);
+	std::vector<char>         constrained(n, 0);
+
+	for (unsigned int v = 0; v < n; v++)
+		parent[v] = v;
+
+	for (unsigned int i = 0; i < _constraints.size(); i++) {
+
+		size_t begin = _constraints.getRowStart(i);
+		size_t end   = _constraints.getRowStart(i + 1);
+
+		if (begin == end) {
+
+			// 0 (≤,=,≥) b
+			double b = _constraints.getValue(i);
+
+			switch (_constraints.getRelation(i)) {
+
+				case LessEqual:    _infeasible |= (b < -FeasibilityTolerance); break;
+				case GreaterEqual: _infeasible |= (b > FeasibilityTolerance); break;
+				case Equal:        _infeasible |= (std::abs(b) > FeasibilityTolerance); break;
+			}
+
+			continue;
+		}
+
+		for (size_t k = begin; k < end; k++) {
+
+			constrained[variables[k]] = 1;
+
+			unsigned int a = variables[begin];
+			unsigned int b = variables[k];
+
+			while (parent[a] != a) {
+
+				parent[a] = parent[parent[a]];
+				a = parent[a];
+			}
+
+			while (parent[b] != b) {
+
+				parent[b] = parent[parent[b]];
+				b = parent[b];
+			}
+
+			parent[std::max(a, b)] = std::min(a, b);
+		}
+	}
+
+	// the root of every constrained variable and the size of every component
+	std::vector<unsigned int> root(n);
+	std::vector<unsigned int> componentSize(n, 0);
+
+	for (unsigned int v = 0; v < n; v++) {
+
+		if (!constrained[v])
+			continue;
+
+		root[v] = v;
+		while (parent[root[v]] != root[v])
+			root[v] = parent[root[v]];
+
+		componentSize[root[v]]++;
+	}
+
+	// the block of every variable, -1 if not constrained
+	std::vector<int> blockOf(n, -1);
+	std::vector<int> blockOfComponent(n, -1);
+
+	unsigned int numComponents = 0;
+	unsigned int blockSize     = 0;
+
+	for (unsigned int v = 0; v < n; v++) {
+
+		// non-binary problems are not split
+		if (!_binary) {
+
+			if (_blocks.empty())
+				_blocks.push_back(boost::make_shared<Block>());
+
+			blockOf[v] = 0;
+			continue;
+		}
+
+		if (!constrained[v]) {
+
+			_unconstrained.push_back(v);
+			continue;
+		}
+
+		// the root of a component is its smallest variable, the first one
+		// seen here
+		if (root[v] == v) {
+
+			numComponents++;
+
+			if (_blocks.empty() || blockSize >= _minBlockSize) {
+
+				_blocks.push_back(boost::make_shared<Block>());
+				blockSize = 0;
+			}
+
+			blockOfComponent[v] = _blocks.size() - 1;
+			blockSize += componentSize[v];
+		}
+
+		blockOf[v] = blockOfComponent[root[v]];
+	}
+
+	// the variables of each block and their index in it
+	std::vector<unsigned int> localIndex(n);
+
+	for (unsigned int v = 0; v < n; v++)
+		if (blockOf[v] >= 0) {
+
+			Block& block = *_blocks[blockOf[v]];
+
+			localIndex[v] = block.variables.size();
+			block.variables.push_back(v);
+		}
+
+	for (unsigned int i = 0; i < _constraints.size(); i++) {
+
+		size_t begin = _constraints.getRowStart(i);
+		size_t end   = _constraints.getRowStart(i + 1);
+
+		if (begin == end)
+			continue;
+
+		Block& block = *_blocks[blockOf[variables[begin]]];
+
+		for (size_t k = begin; k < end; k++)
+			block.constraints.addCoefficient(localIndex[variables[k]], coefficients[k]);
+		block.constraints.finishConstraint(_constraints.getRelation(i), _constraints.getValue(i));
+	}
+
+	// the variables of a non-binary problem keep their index in the only
+	// block, all variables of a binary problem are binary
+	std::map<unsigned int, VariableType> specialVariableTypes;
+	if (!_binary)
+		specialVariableTypes = _specialVariableTypes;
+
+	foreach (boost::shared_ptr<Block> block, _blocks) {
+
+		block->objective.resize(block->variables.size());
+
+		block->backend.reset(_createBackend());
+		block->backend->initialize(block->variables.size(), _variableType, specialVariableTypes);
+		block->backend->setConstraints(block->constraints);
+	}
+
+	LOG_DEBUG(decomposingbackendlog)
+			<< "split " << n << " variables into " << _unconstrained.size() << " unconstrained variables and "
+			<< numComponents << " components in " << _blocks.size() << " blocks" << std::endl;
+}
+
+void
+DecomposingBackend::solveBlocks(unsigned int worker, unsigned int numWorkers) {
+
+	try {
+
+		for (unsigned int b = worker; b < _blocks.size(); b += numWorkers) {
+
+			Block& block = *_blocks[b];
+
+			block.solved = block.backend->solve(block.solution, block.value, block.message);
+
+			LOG_ALL(decomposingbackendlog) << "block " << b << ": " << block.message << std::endl;
+		}
+
+	} catch (...) {
+
+		_exceptions[worker] = boost::current_exception();
+	}
+}
+
@@ -0,0 +1,131 @@
+#ifndef INFERENCE_DECOMPOSING_BACKEND_H__
+#define INFERENCE_DECOMPOSING_BACKEND_H__
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/exception_ptr.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "LinearConstraints.h"
+#include "LinearObjective.h"
+#include "LinearSolverBackend.h"
+
+/**
+ * A backend that splits binary linear programs into independent parts.
+ *
+ * The connected components of the constraint graph (variables, connected if
+ * they share a constraint) are found once per set of constraints. Variables
+ * without constraints are set from the sign of their coefficient. The other
+ * components are combined into blocks of at least
+ * --inference.decomposition.minBlockSize variables. Each block is its own
+ * problem for a backend created with the given function, and the blocks are
+ * solved in parallel, each with an equal share of the threads. The
+ * solutions, values, and bounds of all blocks are combined into the solution
+ * of the whole problem.
+ *
+ * Problems with non-binary variables are not split, they are solved by a
+ * single backend.
+ */
+class DecomposingBackend : public LinearSolverBackend {
+
+public:
+
+	/**
+	 * Create a decomposing backend.
+	 *
+	 * @param createBackend
+	 *             Creates the backend for a block.
+	 */
+	DecomposingBackend(boost::function<LinearSolverBackend*()> createBackend);
+
+	///////////////////////////////////
+	// solver backend implementation //
+	///////////////////////////////////
+
+	void initialize(
+			unsigned int numVariables,
+			VariableType variableType);
+
+	void initialize(
+			unsigned int                                numVariables,
+			VariableType                                defaultVariableType,
+			const std::map<unsigned int, VariableType>& specialVariableTypes);
+
+	void setObjective(const LinearObjective& objective);
+
+	void setConstraints(const LinearConstraints& constraints);
+
+	void addConstraint(const LinearConstraint& constraint);
+
+	void setAbsoluteGap(double gap);
+
+	void setMaxThreads(unsigned int maxThreads);
+
+	bool solve(Solution& solution, double& value, std::string& message);
+
+private:
+
+	/**
+	 * A part of the problem, given by its variables and the constraints on
+	 * them, with its own backend.
+	 */
+	struct Block {
+
+		// the variables of the block, variable i of the block is variables[i]
+		// of the whole problem
+		std::vector<unsigned int> variables;
+
+		LinearConstraints constraints;
+		LinearObjective   objective;
+
+		boost::shared_ptr<LinearSolverBackend> backend;
+
+		Solution    solution;
+		double      value;
+		bool        solved;
+		std::string message;
+	};
+
+	// find the components of the constraint graph and create the blocks
+	void createBlocks();
+
+	// solve every numWorkers-th block, starting with block worker
+	void solveBlocks(unsigned int worker, unsigned int numWorkers);
+
+	boost::function<LinearSolverBackend*()> _createBackend;
+
+	unsigned int _numVariables;
+
+	VariableType                         _variableType;
+	std::map<unsigned int, VariableType> _specialVariableTypes;
+	bool                                 _binary;
+
+	LinearConstraints _constraints;
+	LinearObjective   _objective;
+	double            _absoluteGap;
+
+	// the number of threads given with the program options (0 for all CPUs)
+	// and the limit set with setMaxThreads()
+	unsigned int _numThreads;
+	unsigned int _maxThreads;
+	unsigned int _minBlockSize;
+
+	std::vector<boost::shared_ptr<Block> > _blocks;
+
+	// the variables without constraints
+	std::vector<unsigned int> _unconstrained;
+
+	// a constraint without variables is violated
+	bool _infeasible;
+
+	// the blocks have to be created for the current constraints
+	bool _dirty;
+
+	std::vector<boost::exception_ptr> _exceptions;
+};
+
+#endif // INFERENCE_DECOMPOSING_BACKEND_H__
+
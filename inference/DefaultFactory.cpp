@@ -1,55 +1,102 @@
 #include "DefaultFactory.h"
 
 #include <config.h>
+#include <util/ProgramOptions.h>
+#include <boost/bind/bind.hpp>
+
+#include "BranchAndBoundBackend.h"
+#include "DecomposingBackend.h"
+#include "DynamicProgrammingBackend.h"
+#include "QuadraticSolverBackend.h"
 
 #ifdef HAVE_GUROBI
 #include "GurobiBackend.h"
 #endif
 
-#ifdef HAVE_CPLEX
-#include "CplexBackend.h"
+#ifdef HAVE_HIGHS
+#include "HighsBackend.h"
 #endif
 
+util::ProgramOption optionInferenceBackend(
+		util::_module           = "inference",
+		util::_long_name        = "backend",
+		util::_description_text = "The solver backend to use: 'gurobi', 'highs', or 'builtin' (binary linear programs "
+		                          "only). If not given, the first available of these is used. 'dp' solves binary linear "
+		                          "programs with a constraint graph of small treewidth by dynamic programming, and all "
+		                          "others with the first available backend.");
+
+util::ProgramOption optionInferenceDecompose(
+		util::_module           = "inference",
+		util::_long_name        = "decompose",
+		util::_description_text = "Split binary linear programs into the independent parts of their constraint graph and "
+		                          "solve them in parallel, each with the selected backend.");
+
 LinearSolverBackend*
 DefaultFactory::createLinearSolverBackend() const {
 
-// by default, create a gurobi backend
-#ifdef HAVE_GUROBI
+	if (optionInferenceDecompose)
+		return new DecomposingBackend(boost::bind(&DefaultFactory::createLinearBackend, DefaultFactory(), getBackendName()));
 
-	return new GurobiBackend();
+	return createLinearBackend(getBackendName());
+}
 
-#endif
+QuadraticSolverBackend*
+DefaultFactory::createQuadraticSolverBackend() const {
 
-// if this is not available, create a CPLEX backend
-#ifdef HAVE_CPLEX
+	return createQuadraticBackend(getBackendName());
+}
 
-	return new CplexBackend();
+LinearSolverBackend*
+DefaultFactory::createLinearBackend(const std::string& backend) const {
 
-#endif
+	if (backend == "builtin")
+		return new BranchAndBoundBackend();
 
-// if this is not available as well, throw an exception
+	if (backend == "dp")
+		return new DynamicProgrammingBackend(createLinearBackend(getDefaultBackendName()));
 
-	BOOST_THROW_EXCEPTION(NoSolverException() << error_message("No linear solver available."));
+	return createQuadraticBackend(backend);
 }
 
 QuadraticSolverBackend*
-DefaultFactory::createQuadraticSolverBackend() const {
+DefaultFactory::createQuadraticBackend(const std::string& backend) const {
 
-// by default, create a gurobi backend
 #ifdef HAVE_GUROBI
+	if (backend == "gurobi")
+		return new GurobiBackend();
+#endif
 
-	return new GurobiBackend();
-
+#ifdef HAVE_HIGHS
+	if (backend == "highs")
+		return new HighsBackend();
 #endif
 
-// if this is not available, create a CPLEX backend
-#ifdef HAVE_CPLEX
+	if (backend == "builtin" || backend == "dp")
+		BOOST_THROW_EXCEPTION(
+				NoSolverException() <<
+						error_message("No quadratic solver available, the " + backend + " backend solves only binary linear programs."));
 
-	return new CplexBackend();
+	BOOST_THROW_EXCEPTION(NoSolverException() << error_message("Solver backend '" + backend + "' is not available."));
+}
 
-#endif
+std::string
+DefaultFactory::getBackendName() const {
 
-// if this is not available as well, throw an exception
+	if (optionInferenceBackend)
+		return optionInferenceBackend.as<std::string>();
 
-	BOOST_THROW_EXCEPTION(NoSolverException() << error_message("No linear solver available."));
+	return getDefaultBackendName();
 }
+
+std::string
+DefaultFactory::getDefaultBackendName() const {
+
+#if defined(HAVE_GUROBI)
+	return "gurobi";
+#elif defined(HAVE_HIGHS)
+	return "highs";
+#else
+	return "builtin";
+#endif
+}
+
@@ -1,12 +1,26 @@
 #ifndef INFERENCE_DEFAULT_FACTORY_H__
 #define INFERENCE_DEFAULT_FACTORY_H__
 
+#include <string>
+
 #include <util/exceptions.h>
 #include "LinearSolverBackendFactory.h"
 #include "QuadraticSolverBackendFactory.h"
 
 struct NoSolverException : virtual Exception {};
 
+/**
+ * Creates the solver backend selected with --inference.backend, or the first
+ * available of Gurobi, HiGHS, and the built-in branch-and-bound solver, if
+ * none was selected. The latter does not solve quadratic programs.
+ *
+ * The 'dp' backend solves binary linear programs by dynamic programming (see
+ * DynamicProgrammingBackend) and falls back to the first available backend
+ * for problems that are not suitable for it.
+ *
+ * With --inference.decompose, linear programs are split into independent
+ * parts, each solved by its own backend (see DecomposingBackend).
+ */
 class DefaultFactory :
 		public LinearSolverBackendFactory,
 		public QuadraticSolverBackendFactory {
@@ -16,6 +30,18 @@ public:
 	LinearSolverBackend* createLinearSolverBackend() const;
 
 	QuadraticSolverBackend* createQuadraticSolverBackend() const;
+
+private:
+
+	LinearSolverBackend* createLinearBackend(const std::string& backend) const;
+
+	QuadraticSolverBackend* createQuadraticBackend(const std::string& backend) const;
+
+	// the name of the backend to create
+	std::string getBackendName() const;
+
+	// the first available backend
+	std::string getDefaultBackendName() const;
 };
 
 #endif // INFERENCE_DEFAULT_FACTORY_H__
@@ -0,0 +1,781 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <util/Logger.h>
+#include "DualSimplex.h"
+
+logger::LogChannel dualsimplexlog("dualsimplexlog", "[DualSimplex] ");
+
+// recompute the inverse of the basis matrix after this many pivots
+static const unsigned int RefactorInterval = 100;
+
+// the tolerances on bound violations, reduced costs, and pivot elements
+static const double PrimalTolerance = 1e-9;
+static const double DualTolerance   = 1e-9;
+static const double PivotTolerance  = 1e-9;
+
+DualSimplex::DualSimplex(unsigned int numVariables, const LinearConstraints& constraints) :
+	_numVariables(numVariables),
+	_numConstraints(constraints.size()),
+	_columnStarts(numVariables + 1, 0),
+	_b(constraints.size()),
+	_c(numVariables + constraints.size(), 0.0),
+	_lower(numVariables + constraints.size(), 0.0),
+	_upper(numVariables + constraints.size(), 1.0),
+	_x(numVariables + constraints.size(), 0.0),
+	_d(numVariables + constraints.size(), 0.0),
+	_state(numVariables + constraints.size(), AtLower),
+	_kernelColumnIndex(numVariables, -1),
+	_kernelRowIndex(constraints.size(), -1),
+	_stride(0),
+	_rho(constraints.size()),
+	_alpha(numVariables + constraints.size()),
+	_slackColumn(constraints.size()),
+	_value(0),
+	_numUpdates(0),
+	_numPivots(0),
+	_dirty(true) {
+
+	const unsigned int* variables    = constraints.getVariables();
+	const double*       coefficients = constraints.getCoefficients();
+
+	// transpose the rows into columns
+	for (size_t k = 0; k < constraints.numCoefficients(); k++)
+		_columnStarts[variables[k] + 1]++;
+	for (unsigned int j = 0; j < _numVariables; j++)
+		_columnStarts[j + 1] += _columnStarts[j];
+
+	_rows.resize(constraints.numCoefficients());
+	_coefficients.resize(constraints.numCoefficients());
+
+	_rowStarts.resize(_numConstraints + 1);
+	for (unsigned int i = 0; i <= _numConstraints; i++)
+		_rowStarts[i] = constraints.getRowStart(i);
+
+	_rowVariables.assign(variables, variables + constraints.numCoefficients());
+	_rowCoefficients.assign(coefficients, coefficients + constraints.numCoefficients());
+
+	std::vector<size_t> next(_columnStarts.begin(), _columnStarts.end() - 1);
+
+	for (unsigned int i = 0; i < _numConstraints; i++) {
+
+		// the range of <A_i,x> for x ∈ [0,1]
+		double minActivity = 0;
+		double maxActivity = 0;
+
+		for (size_t k = constraints.getRowStart(i); k < constraints.getRowStart(i + 1); k++) {
+
+			size_t pos = next[variables[k]]++;
+
+			_rows[pos]         = i;
+			_coefficients[pos] = coefficients[k];
+
+			minActivity += std::min(coefficients[k], 0.0);
+			maxActivity += std::max(coefficients[k], 0.0);
+		}
+
+		_b[i] = constraints.getValue(i);
+
+		// the bounds of s_i = b_i - <A_i,x>, an infeasible constraint gets
+		// an empty range of the wrong side
+		unsigned int s = _numVariables + i;
+
+		switch (constraints.getRelation(i)) {
+
+			case LessEqual:
+				_lower[s] = 0;
+				_upper[s] = std::max(0.0, _b[i] - minActivity);
+				break;
+
+			case GreaterEqual:
+				_lower[s] = std::min(0.0, _b[i] - maxActivity);
+				_upper[s] = 0;
+				break;
+
+			case Equal:
+				_lower[s] = 0;
+				_upper[s] = 0;
+				break;
+		}
+	}
+
+	resetBasis();
+}
+
+void
+DualSimplex::setCosts(const std::vector<double>& costs) {
+
+	std::fill(_c.begin(), _c.end(), 0.0);
+	std::copy(costs.begin(), costs.begin() + std::min<size_t>(costs.size(), _numVariables), _c.begin());
+
+	_dirty = true;
+}
+
+void
+DualSimplex::setBounds(unsigned int i, double lower, double upper) {
+
+	_lower[i] = lower;
+	_upper[i] = upper;
+
+	_dirty = true;
+}
+
+DualSimplex::Status
+DualSimplex::solve(double cutoff) {
+
+	if (_dirty) {
+
+		computeReducedCosts();
+		placeNonbasic();
+		computeSolution();
+
+		_dirty = false;
+	}
+
+	unsigned int maxIterations = 10*(_numVariables + _numConstraints) + 1000;
+
+	for (unsigned int iteration = 0; iteration < maxIterations; iteration++) {
+
+		// every basis is dual feasible, so _value is a lower bound
+		if (_value > cutoff)
+			return Cutoff;
+
+		int leaving = chooseLeaving();
+
+		if (leaving < 0) {
+
+			if (_numUpdates == 0)
+				return Optimal;
+
+			// make sure the solution is not an artifact of rounding errors
+			computeSolution();
+
+			if (chooseLeaving() < 0)
+				return Optimal;
+
+			continue;
+		}
+
+		double direction = (_x[leaving] < _lower[leaving] ? 1.0 : -1.0);
+
+		int q = chooseEntering(leaving, direction);
+
+		if (q < 0 && _numUpdates == 0)
+			return Infeasible;
+
+		// a missing entering variable or an unstable pivot might be caused
+		// by rounding errors in the inverse, start over from a fresh one
+		if (q < 0 || _numUpdates >= RefactorInterval || !(pivot(leaving, q, direction))) {
+
+			LOG_ALL(dualsimplexlog) << "refactoring after " << _numUpdates << " updates" << std::endl;
+
+			if (!refactor()) {
+
+				LOG_DEBUG(dualsimplexlog) << "basis is singular, starting from the slack basis" << std::endl;
+				resetBasis();
+			}
+
+			computeReducedCosts();
+			placeNonbasic();
+			computeSolution();
+		}
+	}
+
+	LOG_DEBUG(dualsimplexlog) << "reached the iteration limit" << std::endl;
+
+	return IterationLimit;
+}
+
+void
+DualSimplex::resetBasis() {
+
+	for (unsigned int j = 0; j < _numVariables; j++) {
+
+		_state[j]             = AtLower;
+		_kernelColumnIndex[j] = -1;
+	}
+
+	for (unsigned int i = 0; i < _numConstraints; i++) {
+
+		_state[_numVariables + i] = Basic;
+		_kernelRowIndex[i]        = -1;
+	}
+
+	_kernelColumns.clear();
+	_kernelRows.clear();
+	_inverse.clear();
+	_stride = 0;
+
+	_numUpdates = 0;
+	_dirty      = true;
+}
+
+bool
+DualSimplex::refactor() {
+
+	unsigned int k = _kernelColumns.size();
+
+	// invert K with Gauss-Jordan elimination, K[b][a] = A_{R[b],J[a]}
+	std::vector<double> K(k*k, 0.0);
+	std::vector<double> Kinv(k*k, 0.0);
+
+	for (unsigned int a = 0; a < k; a++) {
+
+		unsigned int j = _kernelColumns[a];
+
+		for (size_t e = _columnStarts[j]; e < _columnStarts[j + 1]; e++)
+			if (_kernelRowIndex[_rows[e]] >= 0)
+				K[_kernelRowIndex[_rows[e]]*k + a] += _coefficients[e];
+
+		Kinv[a*k + a] = 1.0;
+	}
+
+	for (unsigned int col = 0; col < k; col++) {
+
+		unsigned int pivotRow = col;
+		for (unsigned int row = col + 1; row < k; row++)
+			if (std::abs(K[row*k + col]) > std::abs(K[pivotRow*k + col]))
+				pivotRow = row;
+
+		if (std::abs(K[pivotRow*k + col]) < PivotTolerance)
+			return false;
+
+		if (pivotRow != col)
+			for (unsigned int c = 0; c < k; c++) {
+
+				std::swap(K[pivotRow*k + c], K[col*k + c]);
+				std::swap(Kinv[pivotRow*k + c], Kinv[col*k + c]);
+			}
+
+		double p = K[col*k + col];
+		for (unsigned int c = 0; c < k; c++) {
+
+			K[col*k + c]    /= p;
+			Kinv[col*k + c] /= p;
+		}
+
+		for (unsigned int row = 0; row < k; row++) {
+
+			double f = K[row*k + col];
+
+			if (row == col || f == 0)
+				continue;
+
+			for (unsigned int c = 0; c < k; c++) {
+
+				K[row*k + c]    -= f*K[col*k + c];
+				Kinv[row*k + c] -= f*Kinv[col*k + c];
+			}
+		}
+	}
+
+	// K x_J = rhs_R, therefore row a of K^{-1} belongs to J[a]
+	_stride = k;
+	_inverse.swap(Kinv);
+
+	_numUpdates = 0;
+
+	return true;
+}
+
+void
+DualSimplex::computeReducedCosts() {
+
+	unsigned int m = _numConstraints;
+	unsigned int k = _kernelColumns.size();
+
+	// y = c_B B^{-1}, only basic structurals have costs and only the rows R
+	// get a non-zero dual
+	std::vector<double> y(m, 0.0);
+
+	for (unsigned int a = 0; a < k; a++) {
+
+		double c = _c[_kernelColumns[a]];
+
+		if (c == 0)
+			continue;
+
+		const double* row = inverseRow(a);
+		for (unsigned int b = 0; b < k; b++)
+			y[_kernelRows[b]] += c*row[b];
+	}
+
+	for (unsigned int j = 0; j < _numVariables; j++) {
+
+		if (_state[j] == Basic) {
+
+			_d[j] = 0;
+			continue;
+		}
+
+		double d = _c[j];
+		for (size_t e = _columnStarts[j]; e < _columnStarts[j + 1]; e++)
+			d -= y[_rows[e]]*_coefficients[e];
+
+		_d[j] = d;
+	}
+
+	for (unsigned int i = 0; i < m; i++)
+		_d[_numVariables + i] = -y[i];
+}
+
+void
+DualSimplex::placeNonbasic() {
+
+	for (unsigned int j = 0; j < _x.size(); j++) {
+
+		if (_state[j] == Basic)
+			continue;
+
+		if (_d[j] > DualTolerance)
+			_state[j] = AtLower;
+		else if (_d[j] < -DualTolerance)
+			_state[j] = AtUpper;
+
+		_x[j] = (_state[j] == AtLower ? _lower[j] : _upper[j]);
+	}
+}
+
+void
+DualSimplex::computeSolution() {
+
+	unsigned int m = _numConstraints;
+	unsigned int k = _kernelColumns.size();
+
+	// K x_J = b_R - A_{R,N} x_N - s_R
+	std::vector<double> rhs(_b);
+
+	for (unsigned int j = 0; j < _numVariables; j++)
+		if (_state[j] != Basic && _x[j] != 0)
+			for (size_t e = _columnStarts[j]; e < _columnStarts[j + 1]; e++)
+				rhs[_rows[e]] -= _coefficients[e]*_x[j];
+
+	for (unsigned int a = 0; a < k; a++) {
+
+		const double* row = inverseRow(a);
+
+		double x = 0;
+		for (unsigned int b = 0; b < k; b++)
+			x += row[b]*(rhs[_kernelRows[b]] - _x[_numVariables + _kernelRows[b]]);
+
+		_x[_kernelColumns[a]] = x;
+	}
+
+	// the basic slacks follow from all structurals
+	for (unsigned int i = 0; i < m; i++) {
+
+		if (_kernelRowIndex[i] >= 0)
+			continue;
+
+		double s = _b[i];
+		for (size_t e = _rowStarts[i]; e < _rowStarts[i + 1]; e++)
+			s -= _rowCoefficients[e]*_x[_rowVariables[e]];
+
+		_x[_numVariables + i] = s;
+	}
+
+	_value = 0;
+	for (unsigned int j = 0; j < _numVariables; j++)
+		_value += _c[j]*_x[j];
+}
+
+int
+DualSimplex::chooseLeaving() {
+
+	int    leaving    = -1;
+	double infeasible = PrimalTolerance;
+
+	for (unsigned int j = 0; j < _x.size(); j++) {
+
+		if (_state[j] != Basic)
+			continue;
+
+		double violation = std::max(_lower[j] - _x[j], _x[j] - _upper[j]);
+
+		if (violation > infeasible) {
+
+			infeasible = violation;
+			leaving    = j;
+		}
+	}
+
+	return leaving;
+}
+
+int
+DualSimplex::chooseEntering(unsigned int leaving, double direction) {
+
+	unsigned int m = _numConstraints;
+	unsigned int k = _kernelColumns.size();
+
+	computeRho(leaving);
+
+	// the pivot row <rho,a_j> for all variables, only the rows R and the row
+	// of a leaving slack contribute
+	std::fill(_alpha.begin(), _alpha.begin() + _numVariables, 0.0);
+
+	for (unsigned int b = 0; b <= k; b++) {
+
+		unsigned int i;
+
+		if (b < k)
+			i = _kernelRows[b];
+		else if (leaving >= _numVariables)
+			i = leaving - _numVariables;
+		else
+			break;
+
+		double r = _rho[i];
+
+		if (r == 0)
+			continue;
+
+		for (size_t e = _rowStarts[i]; e < _rowStarts[i + 1]; e++)
+			_alpha[_rowVariables[e]] += r*_rowCoefficients[e];
+	}
+
+	for (unsigned int i = 0; i < m; i++)
+		_alpha[_numVariables + i] = _rho[i];
+
+	// Harris' ratio test: find the largest step that keeps all reduced costs
+	// feasible within the tolerance, then take the largest pivot among the
+	// variables that limit the step to at most that
+	double maxStep = std::numeric_limits<double>::infinity();
+
+	for (unsigned int j = 0; j < _x.size(); j++) {
+
+		if (_state[j] == Basic || _lower[j] == _upper[j])
+			continue;
+
+		double alpha = direction*_alpha[j];
+
+		if (_state[j] == AtLower && alpha < -PivotTolerance)
+			maxStep = std::min(maxStep, (_d[j] + DualTolerance)/(-alpha));
+		else if (_state[j] == AtUpper && alpha > PivotTolerance)
+			maxStep = std::min(maxStep, (-_d[j] + DualTolerance)/alpha);
+	}
+
+	int    entering = -1;
+	double maxPivot = 0;
+
+	for (unsigned int j = 0; j < _x.size(); j++) {
+
+		if (_state[j] == Basic || _lower[j] == _upper[j])
+			continue;
+
+		double alpha = direction*_alpha[j];
+		double step;
+
+		if (_state[j] == AtLower && alpha < -PivotTolerance)
+			step = _d[j]/(-alpha);
+		else if (_state[j] == AtUpper && alpha > PivotTolerance)
+			step = -_d[j]/alpha;
+		else
+			continue;
+
+		if (step <= maxStep && std::abs(alpha) > maxPivot) {
+
+			maxPivot = std::abs(alpha);
+			entering = j;
+		}
+	}
+
+	return entering;
+}
+
+bool
+DualSimplex::pivot(unsigned int leaving, unsigned int q, double direction) {
+
+	unsigned int m = _numConstraints;
+	unsigned int k = _kernelColumns.size();
+
+	computeColumn(q);
+
+	double p;
+	if (leaving < _numVariables)
+		p = _w[_kernelColumnIndex[leaving]];
+	else
+		p = _slackColumn[leaving - _numVariables];
+
+	// the pivot from the column has to agree with the one from the row
+	if (std::abs(p - _alpha[q]) > 1e-7*(1.0 + std::abs(p)) || std::abs(p) < PivotTolerance)
+		return false;
+
+	// dual step, the reduced cost of q becomes 0
+	double step = std::max(0.0, (_state[q] == AtLower ? _d[q] : -_d[q])/std::abs(_alpha[q]));
+	double dq   = _d[q];
+
+	for (unsigned int j = 0; j < _x.size(); j++)
+		if (_state[j] != Basic)
+			_d[j] += direction*step*_alpha[j];
+
+	_d[q]       = 0;
+	_d[leaving] = direction*step;
+
+	// primal step, the leaving variable goes to its violated bound
+	double bound = (direction > 0 ? _lower[leaving] : _upper[leaving]);
+	double theta = (_x[leaving] - bound)/p;
+
+	for (unsigned int a = 0; a < k; a++)
+		_x[_kernelColumns[a]] -= theta*_w[a];
+
+	for (unsigned int i = 0; i < m; i++)
+		if (_kernelRowIndex[i] < 0)
+			_x[_numVariables + i] -= theta*_slackColumn[i];
+
+	_x[q]       += theta;
+	_x[leaving]  = bound;
+	_value      += theta*dq;
+
+	updateInverse(leaving, q);
+
+	_state[q]       = Basic;
+	_state[leaving] = (direction > 0 ? AtLower : AtUpper);
+
+	_numUpdates++;
+	_numPivots++;
+
+	return true;
+}
+
+void
+DualSimplex::computeRho(unsigned int leaving) {
+
+	unsigned int k = _kernelColumns.size();
+
+	std::fill(_rho.begin(), _rho.end(), 0.0);
+
+	if (leaving < _numVariables) {
+
+		const double* row = inverseRow(_kernelColumnIndex[leaving]);
+
+		for (unsigned int b = 0; b < k; b++)
+			_rho[_kernelRows[b]] = row[b];
+
+		return;
+	}
+
+	// the row of slack s_i is [e_i - A_{i,J} K^{-1}] on the rows [i, R]
+	unsigned int i = leaving - _numVariables;
+
+	_z.assign(k, 0.0);
+
+	for (size_t e = _rowStarts[i]; e < _rowStarts[i + 1]; e++) {
+
+		int a = _kernelColumnIndex[_rowVariables[e]];
+
+		if (a < 0)
+			continue;
+
+		const double* row = inverseRow(a);
+		for (unsigned int b = 0; b < k; b++)
+			_z[b] += _rowCoefficients[e]*row[b];
+	}
+
+	_rho[i] = 1.0;
+	for (unsigned int b = 0; b < k; b++)
+		_rho[_kernelRows[b]] = -_z[b];
+}
+
+void
+DualSimplex::computeColumn(unsigned int q) {
+
+	unsigned int k = _kernelColumns.size();
+
+	_w.assign(k, 0.0);
+	std::fill(_slackColumn.begin(), _slackColumn.end(), 0.0);
+
+	if (q < _numVariables) {
+
+		for (size_t e = _columnStarts[q]; e < _columnStarts[q + 1]; e++) {
+
+			int b = _kernelRowIndex[_rows[e]];
+
+			if (b < 0) {
+
+				_slackColumn[_rows[e]] += _coefficients[e];
+				continue;
+			}
+
+			for (unsigned int a = 0; a < k; a++)
+				_w[a] += _inverse[a*_stride + b]*_coefficients[e];
+		}
+
+	} else {
+
+		int b = _kernelRowIndex[q - _numVariables];
+
+		for (unsigned int a = 0; a < k; a++)
+			_w[a] = _inverse[a*_stride + b];
+	}
+
+	// the basic slacks change with the basic structurals
+	for (unsigned int a = 0; a < k; a++) {
+
+		if (_w[a] == 0)
+			continue;
+
+		unsigned int j = _kernelColumns[a];
+
+		for (size_t e = _columnStarts[j]; e < _columnStarts[j + 1]; e++)
+			if (_kernelRowIndex[_rows[e]] < 0)
+				_slackColumn[_rows[e]] -= _coefficients[e]*_w[a];
+	}
+}
+
+void
+DualSimplex::updateInverse(unsigned int leaving, unsigned int q) {
+
+	unsigned int k = _kernelColumns.size();
+
+	if (leaving < _numVariables && q < _numVariables) {
+
+		// a structural replaces a structural: column a0 of K changes
+		unsigned int a0   = _kernelColumnIndex[leaving];
+		double*      row0 = inverseRow(a0);
+		double       p    = _w[a0];
+
+		for (unsigned int b = 0; b < k; b++)
+			row0[b] /= p;
+
+		for (unsigned int a = 0; a < k; a++) {
+
+			double f = _w[a];
+
+			if (a == a0 || f == 0)
+				continue;
+
+			double* row = inverseRow(a);
+			for (unsigned int b = 0; b < k; b++)
+				row[b] -= f*row0[b];
+		}
+
+		_kernelColumns[a0]           = q;
+		_kernelColumnIndex[q]        = a0;
+		_kernelColumnIndex[leaving]  = -1;
+
+	} else if (leaving < _numVariables) {
+
+		// the slack of row l replaces a structural: K loses row l and
+		// column a0
+		unsigned int l    = q - _numVariables;
+		unsigned int a0   = _kernelColumnIndex[leaving];
+		unsigned int b0   = _kernelRowIndex[l];
+		double*      row0 = inverseRow(a0);
+		double       p    = row0[b0];
+
+		for (unsigned int a = 0; a < k; a++) {
+
+			double* row = inverseRow(a);
+			double  f   = row[b0]/p;
+
+			if (a == a0 || f == 0)
+				continue;
+
+			for (unsigned int b = 0; b < k; b++)
+				row[b] -= f*row0[b];
+		}
+
+		// move the last row and column into the gap
+		unsigned int last = k - 1;
+
+		if (a0 != last) {
+
+			std::copy(inverseRow(last), inverseRow(last) + k, row0);
+
+			_kernelColumns[a0] = _kernelColumns[last];
+			_kernelColumnIndex[_kernelColumns[a0]] = a0;
+		}
+
+		if (b0 != last) {
+
+			for (unsigned int a = 0; a < last; a++)
+				inverseRow(a)[b0] = inverseRow(a)[last];
+
+			_kernelRows[b0] = _kernelRows[last];
+			_kernelRowIndex[_kernelRows[b0]] = b0;
+		}
+
+		_kernelColumns.pop_back();
+		_kernelRows.pop_back();
+		_kernelColumnIndex[leaving] = -1;
+		_kernelRowIndex[l]          = -1;
+
+	} else if (q < _numVariables) {
+
+		// a structural replaces the slack of row i: K gets row i and column
+		// q, K'^{-1} = [ K^{-1} + w z/σ  -w/σ ; -z/σ  1/σ ]
+		unsigned int i     = leaving - _numVariables;
+		double       sigma = _slackColumn[i];
+
+		growInverse();
+
+		for (unsigned int a = 0; a < k; a++) {
+
+			double* row = inverseRow(a);
+			double  f   = _w[a]/sigma;
+
+			if (f != 0)
+				for (unsigned int b = 0; b < k; b++)
+					row[b] += f*_z[b];
+
+			row[k] = -f;
+		}
+
+		double* row = inverseRow(k);
+		for (unsigned int b = 0; b < k; b++)
+			row[b] = -_z[b]/sigma;
+		row[k] = 1.0/sigma;
+
+		_kernelColumns.push_back(q);
+		_kernelRows.push_back(i);
+		_kernelColumnIndex[q] = k;
+		_kernelRowIndex[i]    = k;
+
+	} else {
+
+		// the slack of row l replaces the slack of row i: row l of K is
+		// replaced by A_{i,J}
+		unsigned int i  = leaving - _numVariables;
+		unsigned int l  = q - _numVariables;
+		unsigned int b0 = _kernelRowIndex[l];
+		double       zb = _z[b0];
+
+		for (unsigned int a = 0; a < k; a++) {
+
+			double* row = inverseRow(a);
+			double  f   = row[b0]/zb;
+
+			if (f == 0)
+				continue;
+
+			for (unsigned int b = 0; b < k; b++)
+				row[b] -= f*_z[b];
+			row[b0] += f;
+		}
+
+		_kernelRows[b0]    = i;
+		_kernelRowIndex[i] = b0;
+		_kernelRowIndex[l] = -1;
+	}
+}
+
+void
+DualSimplex::growInverse() {
+
+	unsigned int k = _kernelColumns.size();
+
+	if (k + 1 <= _stride)
+		return;
+
+	unsigned int stride = std::max(2*_stride, 16u);
+
+	std::vector<double> inverse(stride*stride, 0.0);
+	for (unsigned int a = 0; a < k; a++)
+		std::copy(inverseRow(a), inverseRow(a) + k, &inverse[a*stride]);
+
+	_inverse.swap(inverse);
+	_stride = stride;
+}
+
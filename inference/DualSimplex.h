@@ -0,0 +1,202 @@
+#ifndef INFERENCE_DUAL_SIMPLEX_H__
+#define INFERENCE_DUAL_SIMPLEX_H__
+
+#include <vector>
+
+#include "LinearConstraints.h"
+
+/**
+ * A dual simplex for the linear relaxation of binary linear programs
+ *
+ *   min  <c,x>
+ *   s.t. Ax (≤,=,≥) b
+ *        l ≤ x ≤ u,  0 ≤ l ≤ u ≤ 1
+ *
+ * Each constraint i gets a slack s_i = b_i - <A_i,x>, whose bounds follow
+ * from the relation and from the bounds 0 ≤ x ≤ 1. Since every variable is
+ * bounded, any basis is dual feasible once the non-basic variables are put
+ * to the bound that matches the sign of their reduced cost. Therefore, the
+ * simplex can be warm-started from the basis of the previous solve after
+ * the costs or the bounds changed, which is what branch-and-bound needs.
+ *
+ * Only the part of the basis formed by the basic structurals J and the rows
+ * R whose slacks are not basic is stored: the square matrix K = A_{R,J}
+ * determines the rest of the basis, and its dense inverse is updated after
+ * each pivot and periodically recomputed. K is usually much smaller than the
+ * number of constraints, such that problems with many constraints fit into
+ * memory.
+ */
+class DualSimplex {
+
+public:
+
+	enum Status {
+
+		Optimal,
+
+		Infeasible,
+
+		// the value exceeded the cutoff given to solve()
+		Cutoff,
+
+		IterationLimit
+	};
+
+	/**
+	 * Create a simplex for the given constraints on numVariables variables
+	 * with bounds [0,1] and costs 0.
+	 */
+	DualSimplex(unsigned int numVariables, const LinearConstraints& constraints);
+
+	/**
+	 * Set the cost vector c. The current basis stays valid.
+	 */
+	void setCosts(const std::vector<double>& costs);
+
+	/**
+	 * Restrict the bounds of variable i to [lower, upper] ⊆ [0,1].
+	 */
+	void setBounds(unsigned int i, double lower, double upper);
+
+	double getLowerBound(unsigned int i) const { return _lower[i]; }
+
+	double getUpperBound(unsigned int i) const { return _upper[i]; }
+
+	/**
+	 * Solve the linear program, starting from the current basis.
+	 *
+	 * @param cutoff
+	 *              Stop as soon as the value of the relaxation is proven to
+	 *              be larger than this.
+	 */
+	Status solve(double cutoff);
+
+	/**
+	 * The value <c,x> of the last solution. After Cutoff, a lower bound on
+	 * the value of the relaxation.
+	 */
+	double getValue() const { return _value; }
+
+	/**
+	 * The value of variable i in the last solution.
+	 */
+	double getSolution(unsigned int i) const { return _x[i]; }
+
+	/**
+	 * The reduced cost of variable i in the last solution, 0 for basic
+	 * variables.
+	 */
+	double getReducedCost(unsigned int i) const { return _d[i]; }
+
+	bool isBasic(unsigned int i) const { return _state[i] == Basic; }
+
+	/**
+	 * The number of pivots of all calls to solve() so far.
+	 */
+	unsigned long getNumPivots() const { return _numPivots; }
+
+private:
+
+	enum VariableState {
+
+		Basic,
+		AtLower,
+		AtUpper
+	};
+
+	// make the slacks the basis
+	void resetBasis();
+
+	// recompute the inverse of K, false if it is singular
+	bool refactor();
+
+	// recompute the reduced costs from the costs and the basis
+	void computeReducedCosts();
+
+	// put the non-basic variables to the bound matching their reduced cost
+	void placeNonbasic();
+
+	// recompute the values of the basic variables and the objective
+	void computeSolution();
+
+	// the basic variable to leave the basis, -1 if the basis is primal
+	// feasible
+	int chooseLeaving();
+
+	// the variable to enter the basis for the leaving variable, -1 if there
+	// is none
+	int chooseEntering(unsigned int leaving, double direction);
+
+	// exchange the basic variable leaving with variable q, false if the pivot
+	// is numerically unstable
+	bool pivot(unsigned int leaving, unsigned int q, double direction);
+
+	// _rho = the row of B^{-1} that belongs to the basic variable leaving,
+	// _z = A_{i,J} K^{-1} if leaving is the slack of row i
+	void computeRho(unsigned int leaving);
+
+	// _w = K^{-1} a_{R,q} and _slackColumn = the column of B^{-1} a_q for the
+	// basic slacks
+	void computeColumn(unsigned int q);
+
+	// update K^{-1} for the pivot of computeRho() and computeColumn()
+	void updateInverse(unsigned int leaving, unsigned int q);
+
+	// make room for one more row and column in K^{-1}
+	void growInverse();
+
+	double* inverseRow(unsigned int a) { return &_inverse[a*_stride]; }
+
+	unsigned int _numVariables;
+	unsigned int _numConstraints;
+
+	// the constraint matrix in compressed sparse column and row format
+	std::vector<size_t>       _columnStarts;
+	std::vector<unsigned int> _rows;
+	std::vector<double>       _coefficients;
+	std::vector<size_t>       _rowStarts;
+	std::vector<unsigned int> _rowVariables;
+	std::vector<double>       _rowCoefficients;
+
+	std::vector<double> _b;
+
+	// costs, bounds, values, reduced costs, and states of the structural
+	// variables followed by the slacks
+	std::vector<double>        _c;
+	std::vector<double>        _lower;
+	std::vector<double>        _upper;
+	std::vector<double>        _x;
+	std::vector<double>        _d;
+	std::vector<VariableState> _state;
+
+	// the basic structurals J, the rows R whose slacks are not basic, and the
+	// positions of variables and rows in them (-1 if not contained)
+	std::vector<unsigned int> _kernelColumns;
+	std::vector<unsigned int> _kernelRows;
+	std::vector<int>          _kernelColumnIndex;
+	std::vector<int>          _kernelRowIndex;
+
+	// K^{-1}, row a belongs to J[a], column b to R[b], rows are _stride apart
+	std::vector<double> _inverse;
+	unsigned int        _stride;
+
+	// the pivot row and column of the current iteration
+	std::vector<double> _rho;
+	std::vector<double> _z;
+	std::vector<double> _alpha;
+	std::vector<double> _w;
+	std::vector<double> _slackColumn;
+
+	double _value;
+
+	// the number of pivots since the last refactorization
+	unsigned int _numUpdates;
+
+	unsigned long _numPivots;
+
+	// the bounds or costs changed since the last solve
+	bool _dirty;
+};
+
+#endif // INFERENCE_DUAL_SIMPLEX_H__
+
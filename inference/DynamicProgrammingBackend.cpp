@@ -0,0 +1,434 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <set>
+
+#include <boost/lexical_cast.hpp>
+
+#include <util/Logger.h>
+#include <util/ProgramOptions.h>
+#include <util/foreach.h>
+#include "DynamicProgrammingBackend.h"
+
+using namespace logger;
+
+LogChannel dynamicprogramminglog("dynamicprogramminglog", "[DynamicProgrammingBackend] ");
+
+util::ProgramOption optionDynamicProgrammingMaxWidth(
+		util::_module           = "inference.dynamicProgramming",
+		util::_long_name        = "maxWidth",
+		util::_description_text = "The largest width of the elimination order for which problems are solved by dynamic "
+		                          "programming. The tables of the dynamic program have up to 2^(maxWidth + 1) entries. "
+		                          "Wider problems are solved by the fallback backend.",
+		util::_default_value    = 10);
+
+// the tolerance on the violation of constraints
+static const double FeasibilityTolerance = 1e-6;
+
+DynamicProgrammingBackend::DynamicProgrammingBackend(LinearSolverBackend* fallback) :
+	_numVariables(0),
+	_variableType(Binary),
+	_binary(true),
+	_absoluteGap(0),
+	_maxWidth(optionDynamicProgrammingMaxWidth.as<unsigned int>()),
+	_width(0),
+	_infeasible(false),
+	_dirty(true),
+	_useFallback(false),
+	_fallbackInitialized(false),
+	_fallback(fallback) {}
+
+void
+DynamicProgrammingBackend::initialize(
+		unsigned int numVariables,
+		VariableType variableType) {
+
+	initialize(numVariables, variableType, std::map<unsigned int, VariableType>());
+}
+
+void
+DynamicProgrammingBackend::initialize(
+		unsigned int                                numVariables,
+		VariableType                                defaultVariableType,
+		const std::map<unsigned int, VariableType>& specialVariableTypes) {
+
+	_numVariables         = numVariables;
+	_variableType         = defaultVariableType;
+	_specialVariableTypes = specialVariableTypes;
+
+	_binary = (defaultVariableType == Binary);
+
+	unsigned int v;
+	VariableType type;
+	foreach (boost::tie(v, type), specialVariableTypes)
+		if (type != Binary)
+			_binary = false;
+
+	_objective.resize(_numVariables);
+
+	_dirty               = true;
+	_fallbackInitialized = false;
+}
+
+void
+DynamicProgrammingBackend::setObjective(const LinearObjective& objective) {
+
+	const std::vector<double>& coefficients = objective.getCoefficients();
+
+	_objective.setSense(objective.getSense());
+	_objective.setConstant(objective.getConstant());
+
+	for (unsigned int i = 0; i < _numVariables; i++)
+		_objective.setCoefficient(i, i < coefficients.size() ? coefficients[i] : 0.0);
+}
+
+void
+DynamicProgrammingBackend::setConstraints(const LinearConstraints& constraints) {
+
+	_constraints.clear();
+	_constraints.addAll(constraints);
+
+	_dirty               = true;
+	_fallbackInitialized = false;
+}
+
+void
+DynamicProgrammingBackend::addConstraint(const LinearConstraint& constraint) {
+
+	_constraints.add(constraint);
+
+	if (_fallbackInitialized)
+		_fallback->addConstraint(constraint);
+
+	_dirty = true;
+}
+
+void
+DynamicProgrammingBackend::setAbsoluteGap(double gap) {
+
+	_absoluteGap = gap;
+}
+
+void
+DynamicProgrammingBackend::setMaxThreads(unsigned int maxThreads) {
+
+	_fallback->setMaxThreads(maxThreads);
+}
+
+bool
+DynamicProgrammingBackend::solve(Solution& x, double& value, std::string& msg) {
+
+	if (_dirty) {
+
+		_useFallback = (!_binary || !createBuckets());
+		_dirty       = false;
+
+		if (_useFallback)
+			LOG_DEBUG(dynamicprogramminglog) << "problem is not suitable for dynamic programming, using the fallback" << std::endl;
+		else
+			LOG_DEBUG(dynamicprogramminglog) << "found an elimination order of width " << _width << std::endl;
+	}
+
+	if (_useFallback) {
+
+		if (!_fallbackInitialized)
+			initializeFallback();
+
+		_fallback->setObjective(_objective);
+		_fallback->setAbsoluteGap(_absoluteGap);
+
+		return _fallback->solve(x, value, msg);
+	}
+
+	if (_infeasible) {
+
+		msg = "problem is infeasible";
+		return false;
+	}
+
+	const std::vector<double>& coefficients = _objective.getCoefficients();
+
+	double sense = (_objective.getSense() == Maximize ? 1.0 : -1.0);
+
+	// max-sum over the buckets in elimination order
+	for (unsigned int p = 0; p < _buckets.size(); p++) {
+
+		Bucket&      bucket = _buckets[p];
+		unsigned int size   = 1u << bucket.scope.size();
+		double       gain   = sense*coefficients[bucket.scope[0]];
+
+		_table.resize(size);
+		for (unsigned int t = 0; t < size; t++)
+			_table[t] = (t & 1 ? gain : 0.0);
+
+		if (!bucket.feasible.empty())
+			for (unsigned int t = 0; t < size; t++)
+				if (!bucket.feasible[t])
+					_table[t] = -std::numeric_limits<double>::infinity();
+
+		for (unsigned int c = 0; c < bucket.children.size(); c++) {
+
+			const std::vector<double>&       message   = _buckets[bucket.children[c]].message;
+			const std::vector<unsigned int>& positions = bucket.childPositions[c];
+
+			for (unsigned int t = 0; t < size; t++) {
+
+				unsigned int index = 0;
+				for (unsigned int k = 0; k < positions.size(); k++)
+					index |= ((t >> positions[k]) & 1) << k;
+
+				_table[t] += message[index];
+			}
+		}
+
+		// maximize over the eliminated variable, bit 0 of the table index
+		for (unsigned int a = 0; a < size/2; a++) {
+
+			double v0 = _table[2*a];
+			double v1 = _table[2*a + 1];
+
+			bucket.message[a] = std::max(v0, v1);
+			bucket.argmax[a]  = (v1 > v0);
+		}
+	}
+
+	double total = 0;
+	foreach (unsigned int p, _roots)
+		total += _buckets[p].message[0];
+
+	if (total == -std::numeric_limits<double>::infinity()) {
+
+		msg = "problem is infeasible";
+		return false;
+	}
+
+	// assign the variables in reverse elimination order, all neighbours of a
+	// variable at its elimination are assigned before it
+	x.resize(_numVariables);
+
+	for (unsigned int p = _buckets.size(); p-- > 0;) {
+
+		const Bucket& bucket = _buckets[p];
+
+		unsigned int index = 0;
+		for (unsigned int k = 1; k < bucket.scope.size(); k++)
+			if (x[bucket.scope[k]] > 0.5)
+				index |= 1u << (k - 1);
+
+		x[bucket.scope[0]] = bucket.argmax[index];
+	}
+
+	value = _objective.getConstant();
+	for (unsigned int i = 0; i < _numVariables; i++)
+		value += coefficients[i]*x[i];
+
+	x.setValue(value);
+	x.setBound(value);
+
+	msg = "Optimal solution found by dynamic programming of width " + boost::lexical_cast<std::string>(_width);
+
+	return true;
+}
+
+bool
+DynamicProgrammingBackend::createBuckets() {
+
+	unsigned int n = _numVariables;
+
+	_buckets.clear();
+	_roots.clear();
+	_infeasible = false;
+	_width      = 0;
+
+	const unsigned int* variables = _constraints.getVariables();
+
+	// the constraint graph
+	std::vector<std::set<unsigned int> > neighbors(n);
+
+	for (unsigned int i = 0; i < _constraints.size(); i++) {
+
+		size_t begin = _constraints.getRowStart(i);
+		size_t end   = _constraints.getRowStart(i + 1);
+
+		// the variables of a constraint become one clique
+		if (end - begin > _maxWidth + 1) {
+
+			LOG_DEBUG(dynamicprogramminglog) << "constraint " << i << " has more than " << (_maxWidth + 1) << " variables" << std::endl;
+			return false;
+		}
+
+		for (size_t k = begin; k < end; k++)
+			for (size_t l = begin; l < end; l++)
+				if (variables[k] != variables[l])
+					neighbors[variables[k]].insert(variables[l]);
+	}
+
+	// eliminate the variable with the fewest neighbours first, and connect
+	// its neighbours
+	std::set<std::pair<unsigned int, unsigned int> > queue;
+	for (unsigned int v = 0; v < n; v++)
+		queue.insert(std::make_pair(neighbors[v].size(), v));
+
+	std::vector<unsigned int> position(n);
+
+	while (!queue.empty()) {
+
+		unsigned int v = queue.begin()->second;
+		queue.erase(queue.begin());
+
+		if (neighbors[v].size() > _maxWidth) {
+
+			LOG_DEBUG(dynamicprogramminglog) << "elimination order has a width larger than " << _maxWidth << std::endl;
+			return false;
+		}
+
+		_width = std::max(_width, static_cast<unsigned int>(neighbors[v].size()));
+
+		position[v] = _buckets.size();
+		_buckets.push_back(Bucket());
+
+		std::vector<unsigned int>& scope = _buckets.back().scope;
+		scope.push_back(v);
+		scope.insert(scope.end(), neighbors[v].begin(), neighbors[v].end());
+
+		for (unsigned int k = 1; k < scope.size(); k++)
+			queue.erase(std::make_pair(neighbors[scope[k]].size(), scope[k]));
+
+		for (unsigned int k = 1; k < scope.size(); k++) {
+
+			neighbors[scope[k]].erase(v);
+
+			for (unsigned int l = 1; l < scope.size(); l++)
+				if (l != k)
+					neighbors[scope[k]].insert(scope[l]);
+		}
+
+		for (unsigned int k = 1; k < scope.size(); k++)
+			queue.insert(std::make_pair(neighbors[scope[k]].size(), scope[k]));
+
+		neighbors[v].clear();
+	}
+
+	// the message of a bucket goes to the bucket of its first eliminated
+	// variable
+	for (unsigned int p = 0; p < _buckets.size(); p++) {
+
+		Bucket& bucket = _buckets[p];
+
+		bucket.message.resize(1u << (bucket.scope.size() - 1));
+		bucket.argmax.resize(1u << (bucket.scope.size() - 1));
+
+		if (bucket.scope.size() == 1) {
+
+			_roots.push_back(p);
+			continue;
+		}
+
+		unsigned int target = _buckets.size();
+		for (unsigned int k = 1; k < bucket.scope.size(); k++)
+			target = std::min(target, position[bucket.scope[k]]);
+
+		const std::vector<unsigned int>& targetScope = _buckets[target].scope;
+
+		std::vector<unsigned int> positions;
+		for (unsigned int k = 1; k < bucket.scope.size(); k++)
+			positions.push_back(std::find(targetScope.begin(), targetScope.end(), bucket.scope[k]) - targetScope.begin());
+
+		_buckets[target].children.push_back(p);
+		_buckets[target].childPositions.push_back(positions);
+	}
+
+	// a constraint belongs to the bucket of its first eliminated variable,
+	// whose scope contains all its other variables
+	std::vector<std::vector<unsigned int> > bucketConstraints(_buckets.size());
+
+	for (unsigned int i = 0; i < _constraints.size(); i++) {
+
+		size_t begin = _constraints.getRowStart(i);
+		size_t end   = _constraints.getRowStart(i + 1);
+
+		if (begin == end) {
+
+			// 0 (≤,=,≥) b
+			double b = _constraints.getValue(i);
+
+			switch (_constraints.getRelation(i)) {
+
+				case LessEqual:    _infeasible |= (b < -FeasibilityTolerance); break;
+				case GreaterEqual: _infeasible |= (b > FeasibilityTolerance); break;
+				case Equal:        _infeasible |= (std::abs(b) > FeasibilityTolerance); break;
+			}
+
+			continue;
+		}
+
+		unsigned int p = _buckets.size();
+		for (size_t k = begin; k < end; k++)
+			p = std::min(p, position[variables[k]]);
+
+		bucketConstraints[p].push_back(i);
+	}
+
+	for (unsigned int p = 0; p < _buckets.size(); p++)
+		setFeasible(_buckets[p], bucketConstraints[p]);
+
+	return true;
+}
+
+void
+DynamicProgrammingBackend::setFeasible(Bucket& bucket, const std::vector<unsigned int>& constraints) {
+
+	if (constraints.empty())
+		return;
+
+	const unsigned int* variables    = _constraints.getVariables();
+	const double*       coefficients = _constraints.getCoefficients();
+
+	unsigned int size = 1u << bucket.scope.size();
+
+	bucket.feasible.assign(size, 1);
+
+	foreach (unsigned int i, constraints) {
+
+		size_t begin = _constraints.getRowStart(i);
+		size_t end   = _constraints.getRowStart(i + 1);
+
+		std::vector<unsigned int> positions;
+		for (size_t k = begin; k < end; k++)
+			positions.push_back(std::find(bucket.scope.begin(), bucket.scope.end(), variables[k]) - bucket.scope.begin());
+
+		double   b        = _constraints.getValue(i);
+		Relation relation = _constraints.getRelation(i);
+
+		for (unsigned int t = 0; t < size; t++) {
+
+			double activity = 0;
+			for (unsigned int k = 0; k < positions.size(); k++)
+				if ((t >> positions[k]) & 1)
+					activity += coefficients[begin + k];
+
+			bool satisfied;
+			switch (relation) {
+
+				case LessEqual:    satisfied = (activity <= b + FeasibilityTolerance); break;
+				case GreaterEqual: satisfied = (activity >= b - FeasibilityTolerance); break;
+				default:           satisfied = (std::abs(activity - b) <= FeasibilityTolerance); break;
+			}
+
+			if (!satisfied)
+				bucket.feasible[t] = 0;
+		}
+	}
+}
+
+void
+DynamicProgrammingBackend::initializeFallback() {
+
+	LOG_DEBUG(dynamicprogramminglog) << "initializing the fallback backend" << std::endl;
+
+	_fallback->initialize(_numVariables, _variableType, _specialVariableTypes);
+	_fallback->setConstraints(_constraints);
+
+	_fallbackInitialized = true;
+}
+
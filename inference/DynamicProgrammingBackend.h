@@ -0,0 +1,144 @@
+#ifndef INFERENCE_DYNAMIC_PROGRAMMING_BACKEND_H__
+#define INFERENCE_DYNAMIC_PROGRAMMING_BACKEND_H__
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/scoped_ptr.hpp>
+
+#include "LinearConstraints.h"
+#include "LinearObjective.h"
+#include "LinearSolverBackend.h"
+
+/**
+ * An exact solver for binary linear programs whose constraint graph (the
+ * variables, connected if they share a constraint) has a small treewidth,
+ * like chains of pairwise constraints in sequence labelling.
+ *
+ * The variables are eliminated one after another in the order of a
+ * min-degree heuristic. Eliminating a variable v maximizes over the table of
+ * all assignments to v and its remaining neighbours, which holds the gain of
+ * v, the feasibility of the constraints of v, and the tables of previously
+ * eliminated variables (max-sum dynamic programming). The largest number of
+ * neighbours is the width of the elimination order, the tables have at most
+ * 2^{width + 1} entries.
+ *
+ * The elimination order and the feasibility of all table entries are found
+ * once per set of constraints, each solve() only adds up and maximizes the
+ * tables. If the width exceeds --inference.dynamicProgramming.maxWidth or
+ * the variables are not binary, all calls are passed on to a fallback
+ * backend instead.
+ */
+class DynamicProgrammingBackend : public LinearSolverBackend {
+
+public:
+
+	/**
+	 * Create a dynamic programming backend.
+	 *
+	 * @param fallback
+	 *             The backend to solve problems that are not suitable for
+	 *             dynamic programming. Will be deleted with this backend.
+	 */
+	DynamicProgrammingBackend(LinearSolverBackend* fallback);
+
+	///////////////////////////////////
+	// solver backend implementation //
+	///////////////////////////////////
+
+	void initialize(
+			unsigned int numVariables,
+			VariableType variableType);
+
+	void initialize(
+			unsigned int                                numVariables,
+			VariableType                                defaultVariableType,
+			const std::map<unsigned int, VariableType>& specialVariableTypes);
+
+	void setObjective(const LinearObjective& objective);
+
+	void setConstraints(const LinearConstraints& constraints);
+
+	void addConstraint(const LinearConstraint& constraint);
+
+	void setAbsoluteGap(double gap);
+
+	void setMaxThreads(unsigned int maxThreads);
+
+	bool solve(Solution& solution, double& value, std::string& message);
+
+private:
+
+	/**
+	 * The elimination of one variable.
+	 */
+	struct Bucket {
+
+		// the eliminated variable, followed by its neighbours at the time of
+		// elimination, bit k of a table index is the value of scope[k]
+		std::vector<unsigned int> scope;
+
+		// the buckets whose messages are added to the table, and for each
+		// of them the position in scope of each variable of the message
+		std::vector<unsigned int>               children;
+		std::vector<std::vector<unsigned int> > childPositions;
+
+		// whether each assignment of scope satisfies the constraints of this
+		// bucket, empty if there are none
+		std::vector<char> feasible;
+
+		// the max-marginal table over scope[1..] and the maximizing value of
+		// scope[0] for each entry
+		std::vector<double> message;
+		std::vector<char>   argmax;
+	};
+
+	// find an elimination order and set up the buckets, false if the width is
+	// too large
+	bool createBuckets();
+
+	// compute the feasibility table of a bucket for the given constraints
+	void setFeasible(Bucket& bucket, const std::vector<unsigned int>& constraints);
+
+	// pass the current problem to the fallback backend
+	void initializeFallback();
+
+	unsigned int _numVariables;
+
+	// the variable types, for the fallback backend
+	VariableType                         _variableType;
+	std::map<unsigned int, VariableType> _specialVariableTypes;
+	bool                                 _binary;
+
+	LinearConstraints _constraints;
+	LinearObjective   _objective;
+	double            _absoluteGap;
+
+	unsigned int _maxWidth;
+	unsigned int _width;
+
+	// the buckets in elimination order, and the buckets whose messages have
+	// no variables left
+	std::vector<Bucket>       _buckets;
+	std::vector<unsigned int> _roots;
+
+	// a constraint without variables is violated
+	bool _infeasible;
+
+	// the buckets have to be created for the current constraints
+	bool _dirty;
+
+	// the problem is solved by the fallback backend, which has been
+	// initialized with it
+	bool _useFallback;
+	bool _fallbackInitialized;
+
+	boost::scoped_ptr<LinearSolverBackend> _fallback;
+
+	// the table of the current bucket
+	std::vector<double> _table;
+};
+
+#endif // INFERENCE_DYNAMIC_PROGRAMMING_BACKEND_H__
+
@@ -27,7 +27,8 @@ util::ProgramOption optionGurobiMIPFocus(
 util::ProgramOption optionGurobiNumThreads(
 		util::_module           = "inference.gurobi",
 		util::_long_name        = "numThreads",
-		util::_description_text = "The number of threads to be used by Gurobi. The default (0) uses all available CPUs.",
+		util::_description_text = "The number of threads to be used by Gurobi. The default (0) uses all available CPUs, or an "
+		                          "equal share of them if several problems are solved concurrently.",
 		util::_default_value    = 0);
 
 
@@ -196,31 +197,41 @@ GurobiBackend::setConstraints(const LinearConstraints& constraints) {
 
 		LOG_DEBUG(gurobilog) << "setting " << constraints.size() << " constraints" << std::endl;
 
-		unsigned int j = 0;
-		foreach (const LinearConstraint& constraint, constraints) {
+		const unsigned int* variables    = constraints.getVariables();
+		const double*       coefficients = constraints.getCoefficients();
+
+		// the Gurobi variables of the current row
+		std::vector<GRBVar> rowVariables;
+
+		for (unsigned int j = 0; j < constraints.size(); j++) {
 
 			if (j > 0)
 				if (j % 1000 == 0)
 					LOG_ALL(gurobilog) << "" << j << " constraints set so far" << std::endl;
 
-			// create the lhs expression
+			size_t       begin = constraints.getRowStart(j);
+			unsigned int size  = constraints.getNumCoefficients(j);
+
+			// create the lhs expression from the row of the constraint
 			GRBLinExpr lhsExpr;
 
-			// set the coefficients
-			typedef std::pair<unsigned int, double> pair_type;
-			foreach (const pair_type& pair, constraint.getCoefficients())
-				lhsExpr += pair.second*_variables[pair.first];
+			if (size > 0) {
+
+				rowVariables.resize(size);
+				for (unsigned int k = 0; k < size; k++)
+					rowVariables[k] = _variables[variables[begin + k]];
+
+				lhsExpr.addTerms(&coefficients[begin], &rowVariables[0], size);
+			}
 
 			// add to the model
 			_constraints.push_back(
 					_model.addConstr(
 						lhsExpr,
-						(constraint.getRelation() == LessEqual ? GRB_LESS_EQUAL :
-								(constraint.getRelation() == GreaterEqual ? GRB_GREATER_EQUAL :
+						(constraints.getRelation(j) == LessEqual ? GRB_LESS_EQUAL :
+								(constraints.getRelation(j) == GreaterEqual ? GRB_GREATER_EQUAL :
 										GRB_EQUAL)),
-						constraint.getValue()));
-
-			j++;
+						constraints.getValue(j)));
 		}
 
 		_model.update();
@@ -295,6 +306,12 @@ GurobiBackend::solve(Solution& x, double& value, std::string& msg) {
 
 		x.setValue(value);
 
+		// the proven bound, only available for MIPs
+		if (_model.get(GRB_IntAttr_IsMIP))
+			x.setBound(_model.get(GRB_DoubleAttr_ObjBound));
+		else
+			x.setBound(value);
+
 	} catch (GRBException e) {
 
 		LOG_ERROR(gurobilog) << "error: " << e.getMessage() << endl;
@@ -313,6 +330,24 @@ GurobiBackend::setMIPGap(double gap) {
 	_model.getEnv().set(GRB_DoubleParam_MIPGap, gap);
 }
 
+void
+GurobiBackend::setAbsoluteGap(double gap) {
+
+	// Gurobi's default absolute gap
+	if (gap <= 0)
+		gap = 1e-10;
+
+	_model.getEnv().set(GRB_DoubleParam_MIPGapAbs, std::min(gap, GRB_INFINITY));
+}
+
+void
+GurobiBackend::setMaxThreads(unsigned int maxThreads) {
+
+	// an explicitly given number of threads takes precedence
+	if (optionGurobiNumThreads.as<unsigned int>() == 0)
+		setNumThreads(maxThreads);
+}
+
 void
 GurobiBackend::setMIPFocus(unsigned int focus) {
 
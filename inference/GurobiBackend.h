@@ -58,6 +58,10 @@ public:
 
 	void addConstraint(const LinearConstraint& constraint);
 
+	void setAbsoluteGap(double gap);
+
+	void setMaxThreads(unsigned int maxThreads);
+
 	bool solve(Solution& solution, double& value, std::string& message);
 
 private:
@@ -0,0 +1,494 @@
+#include <config.h>
+
+#ifdef HAVE_HIGHS
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+#include <boost/lexical_cast.hpp>
+
+#include <util/Logger.h>
+#include <util/ProgramOptions.h>
+#include <util/foreach.h>
+#include "HighsBackend.h"
+
+using namespace logger;
+
+LogChannel highslog("highslog", "[HighsBackend] ");
+
+// the relative violation of bounds accepted in solutions of HiGHS
+static const double FeasibilityTolerance = 1e-6;
+
+util::ProgramOption optionHighsMIPGap(
+		util::_module           = "inference.highs",
+		util::_long_name        = "mipGap",
+		util::_description_text = "The HiGHS relative optimality gap.",
+		util::_default_value    = 0.0001);
+
+util::ProgramOption optionHighsNumThreads(
+		util::_module           = "inference.highs",
+		util::_long_name        = "numThreads",
+		util::_description_text = "The number of threads to be used by HiGHS. 0 lets HiGHS decide. The same for all "
+		                          "instances of HiGHS in a process.",
+		util::_default_value    = 1);
+
+util::ProgramOption optionHighsTimeLimit(
+		util::_module           = "inference.highs",
+		util::_long_name        = "timeLimit",
+		util::_description_text = "The time limit in seconds for a single solve, 0 for no limit. The best solution found is "
+		                          "used if the limit is reached.",
+		util::_default_value    = 0);
+
+HighsBackend::HighsBackend() :
+	_highs(Highs_create()),
+	_numVariables(0),
+	_integer(false),
+	_quadratic(false),
+	_sense(1),
+	_constant(0) {
+
+	if (!_highs)
+		BOOST_THROW_EXCEPTION(HighsError() << error_message("could not create a HiGHS instance"));
+
+	_infinity = Highs_getInfinity(_highs);
+
+	check(Highs_setBoolOptionValue(_highs, "output_flag", highslog.getLogLevel() >= Debug), "setting output_flag");
+	check(Highs_setDoubleOptionValue(_highs, "mip_rel_gap", optionHighsMIPGap.as<double>()), "setting mip_rel_gap");
+
+	if (optionHighsNumThreads.as<int>() > 0)
+		check(Highs_setIntOptionValue(_highs, "threads", optionHighsNumThreads.as<int>()), "setting threads");
+
+	if (optionHighsTimeLimit.as<double>() > 0)
+		check(Highs_setDoubleOptionValue(_highs, "time_limit", optionHighsTimeLimit.as<double>()), "setting time_limit");
+}
+
+HighsBackend::~HighsBackend() {
+
+	LOG_DEBUG(highslog) << "destructing HiGHS solver..." << std::endl;
+
+	Highs_destroy(_highs);
+}
+
+void
+HighsBackend::initialize(
+		unsigned int numVariables,
+		VariableType variableType) {
+
+	initialize(numVariables, variableType, std::map<unsigned int, VariableType>());
+}
+
+void
+HighsBackend::initialize(
+		unsigned int                                numVariables,
+		VariableType                                defaultVariableType,
+		const std::map<unsigned int, VariableType>& specialVariableTypes) {
+
+	_numVariables = numVariables;
+
+	LOG_DEBUG(highslog) << "creating " << _numVariables << " variables" << std::endl;
+
+	std::vector<VariableType> types(_numVariables, defaultVariableType);
+
+	unsigned int v;
+	VariableType type;
+	foreach (boost::tie(v, type), specialVariableTypes)
+		types[v] = type;
+
+	std::vector<double>   costs(_numVariables, 0.0);
+	std::vector<HighsInt> integrality(_numVariables);
+	HighsInt              start = 0;
+
+	_colLower.resize(_numVariables);
+	_colUpper.resize(_numVariables);
+	_rowLower.clear();
+	_rowUpper.clear();
+
+	_integer = false;
+
+	for (unsigned int i = 0; i < _numVariables; i++) {
+
+		_colLower[i]   = (types[i] == Binary ? 0.0 : -_infinity);
+		_colUpper[i]   = (types[i] == Binary ? 1.0 : _infinity);
+		integrality[i] = (types[i] == Continuous ? kHighsVarTypeContinuous : kHighsVarTypeInteger);
+
+		_integer |= (types[i] != Continuous);
+	}
+
+	// a new model without constraints and Hessian
+	check(Highs_clearModel(_highs), "Highs_clearModel");
+	_quadratic = false;
+
+	if (_numVariables == 0)
+		return;
+
+	// HiGHS treats a problem as MIP if integrality is given
+	if (_integer)
+		check(
+				Highs_passMip(
+						_highs, _numVariables, 0, 0, kHighsMatrixFormatRowwise, kHighsObjSenseMinimize, 0,
+						&costs[0], &_colLower[0], &_colUpper[0], 0, 0, &start, 0, 0, &integrality[0]),
+				"Highs_passMip");
+	else
+		check(
+				Highs_passLp(
+						_highs, _numVariables, 0, 0, kHighsMatrixFormatRowwise, kHighsObjSenseMinimize, 0,
+						&costs[0], &_colLower[0], &_colUpper[0], 0, 0, &start, 0, 0),
+				"Highs_passLp");
+}
+
+void
+HighsBackend::setObjective(const LinearObjective& objective) {
+
+	setObjective((QuadraticObjective)objective);
+}
+
+void
+HighsBackend::setObjective(const QuadraticObjective& objective) {
+
+	_sense    = (objective.getSense() == Minimize ? 1.0 : -1.0);
+	_constant = objective.getConstant();
+
+	std::vector<double> costs(_numVariables, 0.0);
+	for (unsigned int i = 0; i < _numVariables && i < objective.getCoefficients().size(); i++)
+		costs[i] = _sense*objective.getCoefficients()[i];
+
+	check(Highs_changeObjectiveSense(_highs, kHighsObjSenseMinimize), "Highs_changeObjectiveSense");
+	check(Highs_changeObjectiveOffset(_highs, _sense*objective.getConstant()), "Highs_changeObjectiveOffset");
+
+	if (_numVariables > 0)
+		check(Highs_changeColsCostByRange(_highs, 0, _numVariables - 1, &costs[0]), "Highs_changeColsCostByRange");
+
+	if (objective.getQuadraticCoefficients().empty()) {
+
+		// remove the Hessian of a previous objective, an empty Hessian has to
+		// have the dimension of the problem
+		if (_quadratic) {
+
+			_starts.assign(_numVariables, 0);
+			check(Highs_passHessian(_highs, _numVariables, 0, kHighsHessianFormatTriangular, &_starts[0], 0, 0), "Highs_passHessian");
+			_quadratic = false;
+		}
+
+		return;
+	}
+
+	if (_integer)
+		BOOST_THROW_EXCEPTION(
+				HighsError() <<
+						error_message("HiGHS does not solve quadratic programs with integer variables"));
+
+	// HiGHS minimizes <a,x> + ½xHx with H given by its lower triangle in
+	// column-wise format, i.e., H_ii = 2Q_ii and H_ij = Q_ij + Q_ji
+	std::vector<std::map<unsigned int, double> > columns(_numVariables);
+
+	typedef std::pair<std::pair<unsigned int, unsigned int>, double> quad_coef_pair_type;
+	foreach (const quad_coef_pair_type& pair, objective.getQuadraticCoefficients()) {
+
+		unsigned int i = std::max(pair.first.first, pair.first.second);
+		unsigned int j = std::min(pair.first.first, pair.first.second);
+
+		if (i >= _numVariables)
+			BOOST_THROW_EXCEPTION(
+					HighsError() <<
+							error_message(
+									"quadratic coefficient of variable " + boost::lexical_cast<std::string>(i) +
+									", but there are only " + boost::lexical_cast<std::string>(_numVariables) + " variables"));
+
+		columns[j][i] += _sense*(i == j ? 2*pair.second : pair.second);
+	}
+
+	_starts.clear();
+	_indices.clear();
+	_values.clear();
+
+	for (unsigned int j = 0; j < _numVariables; j++) {
+
+		_starts.push_back(_indices.size());
+
+		typedef std::pair<unsigned int, double> entry_type;
+		foreach (const entry_type& entry, columns[j]) {
+
+			_indices.push_back(entry.first);
+			_values.push_back(entry.second);
+		}
+	}
+
+	LOG_DEBUG(highslog) << "setting " << _indices.size() << " quadratic coefficients" << std::endl;
+
+	check(
+			Highs_passHessian(
+					_highs, _numVariables, _indices.size(), kHighsHessianFormatTriangular,
+					&_starts[0], &_indices[0], &_values[0]),
+			"Highs_passHessian");
+
+	_quadratic = true;
+}
+
+void
+HighsBackend::setConstraints(const LinearConstraints& constraints) {
+
+	LOG_DEBUG(highslog) << "setting " << constraints.size() << " constraints" << std::endl;
+
+	// remove previous constraints
+	if (Highs_getNumRow(_highs) > 0)
+		check(Highs_deleteRowsByRange(_highs, 0, Highs_getNumRow(_highs) - 1), "Highs_deleteRowsByRange");
+
+	_rowLower.resize(constraints.size());
+	_rowUpper.resize(constraints.size());
+
+	if (constraints.size() == 0)
+		return;
+
+	_starts.clear();
+	_indices.clear();
+	_values.clear();
+
+	for (unsigned int j = 0; j < constraints.size(); j++) {
+
+		getRowBounds(constraints.getRelation(j), constraints.getValue(j), _rowLower[j], _rowUpper[j]);
+
+		_starts.push_back(_indices.size());
+		addRowCoefficients(
+				constraints.getVariables(),
+				constraints.getCoefficients(),
+				constraints.getRowStart(j),
+				constraints.getRowStart(j + 1));
+	}
+
+	check(
+			Highs_addRows(
+					_highs,
+					constraints.size(),
+					&_rowLower[0],
+					&_rowUpper[0],
+					_indices.size(),
+					&_starts[0],
+					_indices.empty() ? 0 : &_indices[0],
+					_values.empty() ? 0 : &_values[0]),
+			"Highs_addRows");
+}
+
+void
+HighsBackend::addConstraint(const LinearConstraint& constraint) {
+
+	LOG_DEBUG(highslog) << "adding a constraint" << std::endl;
+
+	_indices.clear();
+	_values.clear();
+
+	typedef std::pair<unsigned int, double> pair_type;
+	foreach (const pair_type& pair, constraint.getCoefficients()) {
+
+		_indices.push_back(pair.first);
+		_values.push_back(pair.second);
+	}
+
+	double lower, upper;
+	getRowBounds(constraint.getRelation(), constraint.getValue(), lower, upper);
+
+	_rowLower.push_back(lower);
+	_rowUpper.push_back(upper);
+
+	check(
+			Highs_addRow(
+					_highs,
+					lower,
+					upper,
+					_indices.size(),
+					_indices.empty() ? 0 : &_indices[0],
+					_values.empty() ? 0 : &_values[0]),
+			"Highs_addRow");
+}
+
+void
+HighsBackend::setAbsoluteGap(double gap) {
+
+	// HiGHS' default absolute gap
+	if (gap <= 0)
+		gap = 1e-6;
+
+	check(Highs_setDoubleOptionValue(_highs, "mip_abs_gap", gap), "setting mip_abs_gap");
+}
+
+bool
+HighsBackend::solve(Solution& x, double& value, std::string& msg) {
+
+	// HiGHS does not solve problems without variables
+	if (_numVariables == 0) {
+
+		msg   = "Optimal solution found";
+		value = _constant;
+
+		x.resize(0);
+		x.setValue(value);
+		x.setBound(value);
+
+		return true;
+	}
+
+	if (Highs_run(_highs) == kHighsStatusError) {
+
+		msg = "HiGHS failed to solve the problem";
+		return false;
+	}
+
+	HighsInt modelStatus = Highs_getModelStatus(_highs);
+
+	HighsInt primalStatus = kHighsSolutionStatusNone;
+	check(Highs_getIntInfoValue(_highs, "primal_solution_status", &primalStatus), "getting primal_solution_status");
+
+	if (modelStatus == kHighsModelStatusOptimal) {
+
+		msg = "Optimal solution found";
+
+	} else if (primalStatus == kHighsSolutionStatusFeasible) {
+
+		// e.g., the time limit was reached with a feasible solution
+		msg = "WARNING: only suboptimal solution found (" + modelStatusToString(modelStatus) + ")";
+
+	} else {
+
+		msg = "Optimal solution *NOT* found (" + modelStatusToString(modelStatus) + ")";
+		return false;
+	}
+
+	std::vector<double> colValues(_numVariables);
+	std::vector<double> colDuals(_numVariables);
+	std::vector<double> rowValues(Highs_getNumRow(_highs));
+	std::vector<double> rowDuals(rowValues.size());
+
+	check(
+			Highs_getSolution(
+					_highs,
+					&colValues[0],
+					&colDuals[0],
+					rowValues.empty() ? 0 : &rowValues[0],
+					rowDuals.empty() ? 0 : &rowDuals[0]),
+			"Highs_getSolution");
+
+	if (!isFeasible(colValues, rowValues)) {
+
+		msg = "HiGHS returned an infeasible solution (" + modelStatusToString(modelStatus) + ")";
+		return false;
+	}
+
+	x.resize(_numVariables);
+	for (unsigned int i = 0; i < _numVariables; i++)
+		x[i] = colValues[i];
+
+	// HiGHS minimized _sense times the objective
+	value = _sense*Highs_getObjectiveValue(_highs);
+
+	x.setValue(value);
+
+	// the proven bound on the minimum of the MIP, for LPs and QPs the
+	// solution is optimal
+	if (_integer) {
+
+		double bound;
+		check(Highs_getDoubleInfoValue(_highs, "mip_dual_bound", &bound), "getting mip_dual_bound");
+
+		x.setBound(_sense*bound);
+
+	} else {
+
+		x.setBound(value);
+	}
+
+	return true;
+}
+
+void
+HighsBackend::check(HighsInt status, const std::string& call) {
+
+	if (status == kHighsStatusError)
+		BOOST_THROW_EXCEPTION(HighsError() << error_message("HiGHS failed at " + call));
+}
+
+bool
+HighsBackend::isFeasible(const std::vector<double>& colValues, const std::vector<double>& rowValues) {
+
+	// not satisfied by NaNs
+	for (unsigned int i = 0; i < colValues.size(); i++)
+		if (!(colValues[i] >= _colLower[i] - FeasibilityTolerance*(1 + std::abs(_colLower[i])) &&
+		      colValues[i] <= _colUpper[i] + FeasibilityTolerance*(1 + std::abs(_colUpper[i]))))
+			return false;
+
+	for (unsigned int j = 0; j < rowValues.size(); j++)
+		if (!(rowValues[j] >= _rowLower[j] - FeasibilityTolerance*(1 + std::abs(_rowLower[j])) &&
+		      rowValues[j] <= _rowUpper[j] + FeasibilityTolerance*(1 + std::abs(_rowUpper[j]))))
+			return false;
+
+	return true;
+}
+
+void
+HighsBackend::getRowBounds(Relation relation, double value, double& lower, double& upper) {
+
+	lower = (relation == LessEqual    ? -_infinity : value);
+	upper = (relation == GreaterEqual ?  _infinity : value);
+}
+
+void
+HighsBackend::addRowCoefficients(const unsigned int* variables, const double* coefficients, size_t begin, size_t end) {
+
+	bool sorted = true;
+	for (size_t k = begin + 1; k < end; k++)
+		if (variables[k] <= variables[k - 1])
+			sorted = false;
+
+	if (sorted) {
+
+		_indices.insert(_indices.end(), variables + begin, variables + end);
+		_values.insert(_values.end(), coefficients + begin, coefficients + end);
+		return;
+	}
+
+	// HiGHS does not accept a variable twice in a row, sum their
+	// coefficients
+	std::vector<std::pair<unsigned int, double> > row;
+	for (size_t k = begin; k < end; k++)
+		row.push_back(std::make_pair(variables[k], coefficients[k]));
+
+	std::sort(row.begin(), row.end());
+
+	for (size_t k = 0; k < row.size(); k++) {
+
+		if (k > 0 && row[k].first == row[k - 1].first) {
+
+			_values.back() += row[k].second;
+
+		} else {
+
+			_indices.push_back(row[k].first);
+			_values.push_back(row[k].second);
+		}
+	}
+}
+
+std::string
+HighsBackend::modelStatusToString(HighsInt modelStatus) {
+
+	switch (modelStatus) {
+
+		case kHighsModelStatusNotset:                 return "not set";
+		case kHighsModelStatusLoadError:              return "load error";
+		case kHighsModelStatusModelError:             return "model error";
+		case kHighsModelStatusPresolveError:          return "presolve error";
+		case kHighsModelStatusSolveError:             return "solve error";
+		case kHighsModelStatusPostsolveError:         return "postsolve error";
+		case kHighsModelStatusModelEmpty:             return "empty model";
+		case kHighsModelStatusOptimal:                return "optimal";
+		case kHighsModelStatusInfeasible:             return "infeasible";
+		case kHighsModelStatusUnboundedOrInfeasible:  return "unbounded or infeasible";
+		case kHighsModelStatusUnbounded:              return "unbounded";
+		case kHighsModelStatusObjectiveBound:         return "objective bound reached";
+		case kHighsModelStatusObjectiveTarget:        return "objective target reached";
+		case kHighsModelStatusTimeLimit:              return "time limit reached";
+		case kHighsModelStatusIterationLimit:         return "iteration limit reached";
+		default:                                      return "unknown";
+	}
+}
+
+#endif // HAVE_HIGHS
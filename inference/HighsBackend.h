@@ -0,0 +1,119 @@
+#ifndef INFERENCE_HIGHS_BACKEND_H__
+#define INFERENCE_HIGHS_BACKEND_H__
+
+#ifdef HAVE_HIGHS
+
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <interfaces/highs_c_api.h>
+
+#include <util/exceptions.h>
+#include "LinearConstraints.h"
+#include "QuadraticObjective.h"
+#include "QuadraticSolverBackend.h"
+#include "Solution.h"
+
+struct HighsError : virtual Exception {};
+
+/**
+ * Interface to the open-source solver HiGHS (https://highs.dev) to solve the
+ * (mixed integer) linear program or continuous quadratic program
+ *
+ * min  <a,x> + xQx
+ * s.t. Ax  == b
+ *      Cx  <= d
+ *      optionally: x_i \in {0,1} for all i
+ *
+ * HiGHS does not solve quadratic programs with integer variables, setting a
+ * quadratic objective for them throws a HighsError, as do failing calls to
+ * HiGHS. HiGHS is used through its C API, which is stable across versions.
+ */
+class HighsBackend : public QuadraticSolverBackend, public boost::noncopyable {
+
+public:
+
+	HighsBackend();
+
+	~HighsBackend();
+
+	///////////////////////////////////
+	// solver backend implementation //
+	///////////////////////////////////
+
+	void initialize(
+			unsigned int numVariables,
+			VariableType variableType);
+
+	void initialize(
+			unsigned int                                numVariables,
+			VariableType                                defaultVariableType,
+			const std::map<unsigned int, VariableType>& specialVariableTypes);
+
+	void setObjective(const LinearObjective& objective);
+
+	void setObjective(const QuadraticObjective& objective);
+
+	void setConstraints(const LinearConstraints& constraints);
+
+	void addConstraint(const LinearConstraint& constraint);
+
+	void setAbsoluteGap(double gap);
+
+	bool solve(Solution& solution, double& value, std::string& message);
+
+private:
+
+	// throw a HighsError if a call to HiGHS failed
+	void check(HighsInt status, const std::string& call);
+
+	// get the row bounds for a relation
+	void getRowBounds(Relation relation, double value, double& lower, double& upper);
+
+	// check that a solution of HiGHS satisfies the bounds of the variables
+	// and rows, HiGHS' QP solver can report optimality for solutions that
+	// do not
+	bool isFeasible(const std::vector<double>& colValues, const std::vector<double>& rowValues);
+
+	// append the coefficients [begin, end) of a row to the row buffers,
+	// summing the coefficients of variables given several times
+	void addRowCoefficients(const unsigned int* variables, const double* coefficients, size_t begin, size_t end);
+
+	static std::string modelStatusToString(HighsInt modelStatus);
+
+	void* _highs;
+
+	unsigned int _numVariables;
+
+	// whether some variables are integer, i.e., the problem is a MIP
+	bool _integer;
+
+	// whether a Hessian was given to HiGHS
+	bool _quadratic;
+
+	// HiGHS always minimizes, this is -1 to maximize
+	double _sense;
+
+	// the constant of the objective
+	double _constant;
+
+	// HiGHS' value for infinite bounds
+	double _infinity;
+
+	// the bounds of the variables and rows given to HiGHS
+	std::vector<double> _colLower;
+	std::vector<double> _colUpper;
+	std::vector<double> _rowLower;
+	std::vector<double> _rowUpper;
+
+	// buffers for the rows and the Hessian given to HiGHS
+	std::vector<HighsInt> _starts;
+	std::vector<HighsInt> _indices;
+	std::vector<double>   _values;
+};
+
+#endif // HAVE_HIGHS
+
+#endif // INFERENCE_HIGHS_BACKEND_H__
@@ -1,40 +1,258 @@
+#include <algorithm>
+
+#include <boost/static_assert.hpp>
+#include <util/foreach.h>
+#include <io/BinaryDataset.h>
 #include "LinearConstraints.h"
 
-LinearConstraints::LinearConstraints(size_t size) {
+LinearConstraints::LinearConstraints(size_t size, size_t numCoefficients) :
+	_rowStarts(1, 0),
+	_numVariables(0),
+	_haveIndex(false) {
+
+	_rowStarts.reserve(size + 1);
+	_relations.reserve(size);
+	_values.reserve(size);
+	_variables.reserve(numCoefficients);
+	_coefficients.reserve(numCoefficients);
+}
+
+void
+LinearConstraints::clear() {
+
+	_rowStarts.assign(1, 0);
+	_variables.clear();
+	_coefficients.clear();
+	_relations.clear();
+	_values.clear();
+	_numVariables = 0;
 
-	_linearConstraints.resize(size);
+	_index.clear();
+	_haveIndex = false;
 }
 
 void
 LinearConstraints::add(const LinearConstraint& linearConstraint) {
 
-	_linearConstraints.push_back(linearConstraint);
+	typedef std::map<unsigned int, double>::const_iterator coef_iterator;
+
+	const std::map<unsigned int, double>& coefs = linearConstraint.getCoefficients();
+
+	for (coef_iterator i = coefs.begin(); i != coefs.end(); i++)
+		addCoefficient(i->first, i->second);
+
+	finishConstraint(linearConstraint.getRelation(), linearConstraint.getValue());
 }
 
 void
 LinearConstraints::addAll(const LinearConstraints& linearConstraints) {
 
-	_linearConstraints.insert(_linearConstraints.end(), linearConstraints.begin(), linearConstraints.end());
+	// the constraints would be appended to the coefficients of the pending one
+	if (_variables.size() != numCoefficients())
+		BOOST_THROW_EXCEPTION(
+				LinearConstraintsError()
+				<< error_message("can not add constraints while a constraint is under construction"));
+
+	size_t       offset = _rowStarts.back();
+	size_t       end    = linearConstraints.numCoefficients();
+	unsigned int first  = size();
+
+	// the finished constraints of the other set only
+	_variables.insert(_variables.end(), linearConstraints._variables.begin(), linearConstraints._variables.begin() + end);
+	_coefficients.insert(_coefficients.end(), linearConstraints._coefficients.begin(), linearConstraints._coefficients.begin() + end);
+	_relations.insert(_relations.end(), linearConstraints._relations.begin(), linearConstraints._relations.end());
+	_values.insert(_values.end(), linearConstraints._values.begin(), linearConstraints._values.end());
+
+	for (unsigned int i = 1; i <= linearConstraints.size(); i++)
+		_rowStarts.push_back(offset + linearConstraints._rowStarts[i]);
+
+	// not linearConstraints._numVariables, which counts a pending constraint
+	for (size_t k = offset; k < _variables.size(); k++)
+		_numVariables = std::max(_numVariables, _variables[k] + 1);
+
+	if (_haveIndex)
+		for (unsigned int i = first; i < size(); i++)
+			indexConstraint(i);
 }
 
-std::vector<unsigned int>
-LinearConstraints::getConstraints(const std::vector<unsigned int>& variableIds) {
+void
+LinearConstraints::addCoefficient(unsigned int varNum, double coef) {
 
-	std::vector<unsigned int> indices;
+	if (coef == 0)
+		return;
+
+	_variables.push_back(varNum);
+	_coefficients.push_back(coef);
+
+	_numVariables = std::max(_numVariables, varNum + 1);
+}
+
+void
+LinearConstraints::finishConstraint(Relation relation, double value) {
+
+	_rowStarts.push_back(_variables.size());
+	_relations.push_back(relation);
+	_values.push_back(value);
+
+	if (_haveIndex)
+		indexConstraint(size() - 1);
+}
+
+void
+LinearConstraints::remove(const std::vector<bool>& remove) {
+
+	size_t       pos = 0;
+	unsigned int n   = 0;
+
+	_numVariables = 0;
 
 	for (unsigned int i = 0; i < size(); i++) {
 
-		LinearConstraint& constraint = _linearConstraints[i];
+		if (remove[i])
+			continue;
 
-		foreach (unsigned int v, variableIds) {
+		size_t begin = _rowStarts[i];
+		size_t end   = _rowStarts[i + 1];
 
-			if (constraint.getCoefficients().count(v) != 0) {
+		for (size_t k = begin; k < end; k++, pos++) {
 
-				indices.push_back(i);
-				break;
-			}
+			_variables[pos]    = _variables[k];
+			_coefficients[pos] = _coefficients[k];
+			_numVariables      = std::max(_numVariables, _variables[pos] + 1);
 		}
+
+		_relations[n]     = _relations[i];
+		_values[n]        = _values[i];
+		_rowStarts[n + 1] = pos;
+		n++;
 	}
 
+	_rowStarts.resize(n + 1);
+	_relations.resize(n);
+	_values.resize(n);
+	_variables.resize(pos);
+	_coefficients.resize(pos);
+
+	// the constraint ids changed, rebuild on the next query
+	_index.clear();
+	_haveIndex = false;
+}
+
+void
+LinearConstraints::map(const BinaryDataset& dataset) {
+
+	// relations are stored as int32
+	BOOST_STATIC_ASSERT(sizeof(Relation) == sizeof(boost::int32_t));
+
+	size_t numInfo, numRowStarts, numVariables, numCoefficients, numRelations, numValues;
+	const boost::uint64_t* info         = dataset.get<boost::uint64_t>(BinaryDataset::ConstraintsInfo, numInfo);
+	size_t*                rowStarts    = dataset.get<size_t>(BinaryDataset::ConstraintRowStarts, numRowStarts);
+	unsigned int*          variables    = dataset.get<unsigned int>(BinaryDataset::ConstraintVariables, numVariables);
+	double*                coefficients = dataset.get<double>(BinaryDataset::ConstraintCoefficients, numCoefficients);
+	Relation*              relations    = dataset.get<Relation>(BinaryDataset::ConstraintRelations, numRelations);
+	double*                values       = dataset.get<double>(BinaryDataset::ConstraintValues, numValues);
+
+	if (numInfo != 1 ||
+	    numRowStarts != numRelations + 1 ||
+	    numValues != numRelations ||
+	    numCoefficients != numVariables ||
+	    rowStarts[0] != 0 ||
+	    rowStarts[numRelations] != numVariables)
+		BOOST_THROW_EXCEPTION(BinaryDatasetError() << error_message(dataset.getFilename() + ": constraints are corrupted"));
+
+	// the solvers do not check the rows and variables of the constraints
+	for (size_t i = 0; i < numRelations; i++)
+		if (rowStarts[i] > rowStarts[i + 1])
+			BOOST_THROW_EXCEPTION(BinaryDatasetError() << error_message(dataset.getFilename() + ": constraints are corrupted"));
+
+	for (size_t k = 0; k < numVariables; k++)
+		if (variables[k] >= info[0])
+			BOOST_THROW_EXCEPTION(BinaryDatasetError() << error_message(dataset.getFilename() + ": constraints are corrupted"));
+
+	clear();
+
+	_rowStarts.map(rowStarts, numRowStarts, dataset.getOwner());
+	_variables.map(variables, numVariables, dataset.getOwner());
+	_coefficients.map(coefficients, numCoefficients, dataset.getOwner());
+	_relations.map(relations, numRelations, dataset.getOwner());
+	_values.map(values, numValues, dataset.getOwner());
+
+	_numVariables = info[0];
+}
+
+void
+LinearConstraints::write(BinaryDatasetWriter& writer) const {
+
+	boost::uint64_t info = _numVariables;
+
+	// constraints under construction are not written
+	size_t end = numCoefficients();
+
+	writer.add(BinaryDataset::ConstraintsInfo, &info, 1);
+	writer.add(BinaryDataset::ConstraintRowStarts, _rowStarts.data(), _rowStarts.size());
+	writer.add(BinaryDataset::ConstraintVariables, _variables.data(), end);
+	writer.add(BinaryDataset::ConstraintCoefficients, _coefficients.data(), end);
+	writer.add(BinaryDataset::ConstraintRelations, _relations.data(), _relations.size());
+	writer.add(BinaryDataset::ConstraintValues, _values.data(), _values.size());
+}
+
+LinearConstraint
+LinearConstraints::operator[](size_t i) const {
+
+	LinearConstraint constraint;
+
+	for (size_t k = _rowStarts[i]; k < _rowStarts[i + 1]; k++)
+		constraint.setCoefficient(_variables[k], _coefficients[k]);
+	constraint.setRelation(_relations[i]);
+	constraint.setValue(_values[i]);
+
+	return constraint;
+}
+
+std::vector<unsigned int>
+LinearConstraints::getConstraints(const std::vector<unsigned int>& variableIds) {
+
+	if (!_haveIndex)
+		buildIndex();
+
+	std::vector<unsigned int> indices;
+
+	foreach (unsigned int v, variableIds)
+		if (v < _index.size())
+			indices.insert(indices.end(), _index[v].begin(), _index[v].end());
+
+	// constraints using several of the variables are listed only once
+	std::sort(indices.begin(), indices.end());
+	indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+
 	return indices;
 }
+
+void
+LinearConstraints::buildIndex() {
+
+	// count first, to allocate each list only once
+	std::vector<unsigned int> counts(_numVariables, 0);
+	for (size_t k = 0; k < numCoefficients(); k++)
+		counts[_variables[k]]++;
+
+	_index.assign(_numVariables, std::vector<unsigned int>());
+	for (unsigned int v = 0; v < _numVariables; v++)
+		_index[v].reserve(counts[v]);
+
+	_haveIndex = true;
+
+	for (unsigned int i = 0; i < size(); i++)
+		indexConstraint(i);
+}
+
+void
+LinearConstraints::indexConstraint(unsigned int i) {
+
+	if (_index.size() < _numVariables)
+		_index.resize(_numVariables);
+
+	for (size_t k = _rowStarts[i]; k < _rowStarts[i + 1]; k++)
+		_index[_variables[k]].push_back(i);
+}
+
@@ -1,33 +1,53 @@
 #ifndef INFERENCE_LINEAR_CONSTRAINTS_H__
 #define INFERENCE_LINEAR_CONSTRAINTS_H__
 
+#include <vector>
+
 #include <pipeline/all.h>
+#include <util/exceptions.h>
+#include <io/MappableVector.h>
 #include "LinearConstraint.h"
 
+class BinaryDataset;
+class BinaryDatasetWriter;
+
+struct LinearConstraintsError : virtual Exception {};
+
+/**
+ * A set of sparse linear constraints, stored in compressed sparse row (CSR)
+ * format: the variables and coefficients of all constraints are kept in two
+ * flat arrays, the non-zeros of constraint i are the entries
+ * [getRowStart(i), getRowStart(i+1)) of them.
+ *
+ * Constraints are built incrementally, either from a LinearConstraint or
+ * directly from their non-zeros with addCoefficient() and finishConstraint().
+ *
+ * For queries by variable (see getConstraints()), an inverted index from
+ * variables to the constraints using them is built on the first query, and
+ * kept up to date when constraints are added afterwards.
+ *
+ * Constraints read from a BinaryDataset are views on the mapped file, they
+ * are copied only when constraints are added or removed.
+ */
 class LinearConstraints : public pipeline::Data {
 
-	typedef std::vector<LinearConstraint> linear_constraints_type;
-
 public:
 
-	typedef linear_constraints_type::iterator       iterator;
-
-	typedef linear_constraints_type::const_iterator const_iterator;
-
 	/**
-	 * Create a new set of linear constraints and allocate enough memory to hold
-	 * 'size' linear constraints. More or less constraints can be added, but
-	 * memory might be wasted (if more allocated then necessary) or unnecessary
-	 * reallocations might occur (if more added than allocated).
+	 * Create a new set of linear constraints and reserve memory for 'size'
+	 * linear constraints. More or less constraints can be added, but memory
+	 * might be wasted (if more reserved then necessary) or unnecessary
+	 * reallocations might occur (if more added than reserved).
 	 *
 	 * @param size The number of linear constraints to reserve memory for.
+	 * @param numCoefficients The total number of non-zeros to reserve memory for.
 	 */
-	LinearConstraints(size_t size = 0);
+	LinearConstraints(size_t size = 0, size_t numCoefficients = 0);
 
 	/**
 	 * Remove all constraints from this set of linear constraints.
 	 */
-	void clear() { _linearConstraints.clear(); }
+	void clear();
 
 	/**
 	 * Add a linear constraint.
@@ -37,38 +57,118 @@ public:
 	void add(const LinearConstraint& linearConstraint);
 
 	/**
-	 * Add a set of linear constraints.
+	 * Add a set of linear constraints. Only the finished constraints of the
+	 * given set are added. Throws a LinearConstraintsError if this set has a
+	 * constraint under construction.
 	 *
 	 * @param linearConstraints The set of linear constraints to add.
 	 */
 	void addAll(const LinearConstraints& linearConstraints);
 
+	/**
+	 * Add a non-zero coefficient to the constraint under construction. Each
+	 * variable can be given only once per constraint. Zero coefficients are
+	 * ignored, as by LinearConstraint::setCoefficient(): their variables are
+	 * not part of the constraint and do not count for getNumVariables().
+	 */
+	void addCoefficient(unsigned int varNum, double coef);
+
+	/**
+	 * Finish the constraint under construction, i.e., all coefficients added
+	 * since the last call, and add it to this set.
+	 */
+	void finishConstraint(Relation relation, double value);
+
+	/**
+	 * Remove all constraints i with remove[i] == true.
+	 */
+	void remove(const std::vector<bool>& remove);
+
+	/**
+	 * Replace this set with a view on the constraints of a binary dataset.
+	 */
+	void map(const BinaryDataset& dataset);
+
+	/**
+	 * Write the constraints of this set to a binary dataset.
+	 */
+	void write(BinaryDatasetWriter& writer) const;
+
 	/**
 	 * @return The number of linear constraints in this set.
 	 */
-	unsigned int size() const { return _linearConstraints.size(); }
+	unsigned int size() const { return _relations.size(); }
+
+	/**
+	 * @return The number of non-zero coefficients of all constraints.
+	 */
+	size_t numCoefficients() const { return _rowStarts.back(); }
 
-	const const_iterator begin() const { return _linearConstraints.begin(); }
+	/**
+	 * @return One more than the largest variable used in any constraint.
+	 */
+	unsigned int getNumVariables() const { return _numVariables; }
 
-	iterator begin() { return _linearConstraints.begin(); }
+	/**
+	 * The position of the first non-zero of constraint i in the arrays of
+	 * variables and coefficients. getRowStart(size()) is numCoefficients().
+	 */
+	size_t getRowStart(size_t i) const { return _rowStarts[i]; }
 
-	const const_iterator end() const { return _linearConstraints.end(); }
+	/**
+	 * The number of non-zero coefficients of constraint i.
+	 */
+	unsigned int getNumCoefficients(size_t i) const { return _rowStarts[i + 1] - _rowStarts[i]; }
 
-	iterator end() { return _linearConstraints.end(); }
+	/**
+	 * The variables of the non-zero coefficients of all constraints.
+	 */
+	const unsigned int* getVariables() const { return _variables.data(); }
 
-	const LinearConstraint& operator[](size_t i) const { return _linearConstraints[i]; }
+	/**
+	 * The non-zero coefficients of all constraints.
+	 */
+	const double* getCoefficients() const { return _coefficients.data(); }
 
-	LinearConstraint& operator[](size_t i) { return _linearConstraints[i]; }
+	Relation getRelation(size_t i) const { return _relations[i]; }
+
+	double getValue(size_t i) const { return _values[i]; }
 
 	/**
-	 * Get a linst of indices of linear constraints that use the given 
-	 * variables.
+	 * Get a copy of constraint i.
+	 */
+	LinearConstraint operator[](size_t i) const;
+
+	/**
+	 * Get a linst of indices of linear constraints that use the given
+	 * variables, in increasing order.
 	 */
 	std::vector<unsigned int> getConstraints(const std::vector<unsigned int>& variableIds);
 
 private:
 
-	linear_constraints_type _linearConstraints;
+	// create the inverted index for all current constraints
+	void buildIndex();
+
+	// add constraint i to the inverted index
+	void indexConstraint(unsigned int i);
+
+	// the start of each row in _variables and _coefficients, and the end of
+	// the last one
+	MappableVector<size_t> _rowStarts;
+
+	MappableVector<unsigned int> _variables;
+	MappableVector<double>       _coefficients;
+
+	MappableVector<Relation> _relations;
+	MappableVector<double>   _values;
+
+	unsigned int _numVariables;
+
+	// for each variable, the constraints that use it in increasing order,
+	// only if _haveIndex
+	std::vector<std::vector<unsigned int> > _index;
+	bool                                    _haveIndex;
 };
 
 #endif // INFERENCE_LINEAR_CONSTRAINTS_H__
@@ -1,3 +1,5 @@
+#include <limits>
+
 #include <util/Logger.h>
 #include <util/foreach.h>
 #include <util/helpers.hpp>
@@ -101,6 +103,12 @@ LinearSolver::solve() {
 
 	std::string message;
 
+	_solver->setAbsoluteGap(_parameters ? _parameters->getAbsoluteGap() : 0.0);
+	_solver->setMaxThreads(_parameters ? _parameters->getMaxThreads() : 0);
+
+	// backends that do not report a bound solve to optimality
+	_solution->setBound(std::numeric_limits<double>::quiet_NaN());
+
 	if (_solver->solve(*_solution, value, message)) {
 
 		LOG_DEBUG(linearsolverlog) << message << std::endl;
@@ -110,6 +118,9 @@ LinearSolver::solve() {
 		LOG_ERROR(linearsolverlog) << "error: " << message << std::endl;
 	}
 
+	if (_solution->getBound() != _solution->getBound())
+		_solution->setBound(value);
+
 	LOG_ALL(linearsolverlog) << "solution: " << _solution->getVector() << std::endl;
 }
 
@@ -124,11 +135,7 @@ LinearSolver::getNumVariables() {
 	unsigned int numVars = _objective->getCoefficients().size();
 
 	// number of vars in the constraints
-	unsigned int varNum;
-	double coef;
-	foreach (const LinearConstraint& constraint, *_linearConstraints)
-		foreach (boost::tie(varNum, coef), constraint.getCoefficients())
-			numVars = std::max(numVars, varNum + 1);
+	numVars = std::max(numVars, _linearConstraints->getNumVariables());
 
 	LOG_ALL(linearsolverlog)
 			<< "together with the constraints, "
@@ -63,6 +63,28 @@ public:
 	 */
 	virtual void addConstraint(const LinearConstraint& constraint) = 0;
 
+	/**
+	 * Set the absolute optimality gap for subsequent calls to solve(), i.e.,
+	 * the solver may stop as soon as the value of the solution is proven to
+	 * be within gap of the optimal value.
+	 *
+	 * Backends that do not support a gap solve to optimality, which is the
+	 * default implementation.
+	 *
+	 * @param gap The absolute gap, 0 for the default of the solver.
+	 */
+	virtual void setAbsoluteGap(double /*gap*/) {}
+
+	/**
+	 * Limit the number of threads of subsequent calls to solve(), for when
+	 * several problems are solved concurrently. Only backends that use all
+	 * CPUs by default follow the limit, a number of threads given explicitly
+	 * with their program options takes precedence.
+	 *
+	 * @param maxThreads The maximal number of threads, 0 for no limit.
+	 */
+	virtual void setMaxThreads(unsigned int /*maxThreads*/) {}
+
 	/**
 	 * Solve the problem.
 	 *
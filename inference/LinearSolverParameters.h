@@ -10,10 +10,14 @@ struct LinearSolverParameters : pipeline::Data {
 public:
 
 	LinearSolverParameters() :
-		_variableType(Continuous) {};
+		_variableType(Continuous),
+		_absoluteGap(0),
+		_maxThreads(0) {};
 
 	LinearSolverParameters(const VariableType& variableType) :
-		_variableType(variableType) {}
+		_variableType(variableType),
+		_absoluteGap(0),
+		_maxThreads(0) {}
 
 	/**
 	 * Set the default variable type for all variables.
@@ -46,6 +50,35 @@ public:
 		return _variableTypes;
 	}
 
+	/**
+	 * Set the absolute optimality gap up to which to solve. Unlike the
+	 * variable types, the gap is read on every solve and can be changed
+	 * without resetting the solver. 0 uses the default of the solver.
+	 */
+	void setAbsoluteGap(double gap) {
+
+		_absoluteGap = gap;
+	}
+
+	double getAbsoluteGap() const {
+
+		return _absoluteGap;
+	}
+
+	/**
+	 * Limit the number of threads of the solver. Like the gap, the limit can
+	 * be changed without resetting the solver. 0 for no limit.
+	 */
+	void setMaxThreads(unsigned int maxThreads) {
+
+		_maxThreads = maxThreads;
+	}
+
+	unsigned int getMaxThreads() const {
+
+		return _maxThreads;
+	}
+
 private:
 
 	// the default variable type
@@ -53,6 +86,12 @@ private:
 
 	// individual variable types
 	std::map<unsigned int, VariableType> _variableTypes;
+
+	// the absolute optimality gap
+	double _absoluteGap;
+
+	// the maximal number of threads of the solver
+	unsigned int _maxThreads;
 };
 
 #endif // INFERENCE_LINEAR_SOLVER_PARAMETERS_H__
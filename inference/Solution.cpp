@@ -1,6 +1,8 @@
 #include "Solution.h"
 
-Solution::Solution(unsigned int size) {
+Solution::Solution(unsigned int size) :
+	_value(0),
+	_bound(0) {
 
 	resize(size);
 }
@@ -23,11 +23,21 @@ public:
 
 	double getValue() { return _value; }
 
+	/**
+	 * The best bound on the optimal value the solver could prove. Equals the
+	 * value, unless the solver stopped before optimality was proven.
+	 */
+	void setBound(double bound) { _bound = bound; }
+
+	double getBound() { return _bound; }
+
 private:
 
 	std::vector<double> _solution;
 
 	double _value;
+
+	double _bound;
 };
 
 #endif // INFERENCE_SOLUTION_H__
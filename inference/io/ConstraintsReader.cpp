@@ -1,13 +1,15 @@
-#include <fstream>
+#include <algorithm>
+
+#include <boost/bind/bind.hpp>
 
-#include <util/files.h>
 #include <util/Logger.h>
 #include "ConstraintsReader.h"
 
 logger::LogChannel constraintsreaderlog("constraintsreaderlog", "[ConstraintsReader] ");
 
-ConstraintsReader::ConstraintsReader(std::string filename) :
-		_filename(filename) {
+ConstraintsReader::ConstraintsReader(std::string filename, unsigned int numThreads) :
+		_filename(filename),
+		_numThreads(numThreads) {
 
 	registerOutput(_constraints, "linear constraints");
 }
@@ -15,84 +17,131 @@ ConstraintsReader::ConstraintsReader(std::string filename) :
 void
 ConstraintsReader::updateOutputs() {
 
-	std::ifstream in(_filename.c_str());
+	read(*_constraints);
+}
+
+void
+ConstraintsReader::read(LinearConstraints& constraints) {
+
+	if (BinaryDataset::isBinaryDataset(_filename)) {
+
+		constraints.map(BinaryDataset(_filename));
+
+		LOG_DEBUG(constraintsreaderlog) << "mapped " << constraints.size() << " constraints" << std::endl;
+		return;
+	}
+
+	constraints.clear();
+
+	TextFileReader         reader(_filename, _numThreads);
+	std::vector<TextChunk> chunks;
+
+	while (reader.readBlock(chunks)) {
 
-	while (!in.eof() && in.good()) {
+		std::vector<LinearConstraints> chunkConstraints(chunks.size());
 
-		std::string line = readline(in);
+		TextFileReader::parseChunks(
+				chunks,
+				boost::bind(&ConstraintsReader::parseChunk, this, _1, _2, boost::ref(chunkConstraints)));
 
-		if (line.size() > 0)
-			readConstraint(line);
+		for (unsigned int k = 0; k < chunkConstraints.size(); k++)
+			constraints.addAll(chunkConstraints[k]);
 	}
+
+	LOG_DEBUG(constraintsreaderlog) << "read " << constraints.size() << " constraints" << std::endl;
 }
 
 void
-ConstraintsReader::readConstraint(std::string& line) {
-
-	LinearConstraint constraint;
+ConstraintsReader::parseChunk(const TextChunk& chunk, unsigned int k, std::vector<LinearConstraints>& constraints) {
 
-	std::string whitespace = " \t";
-	std::string number = "0123456789.eE-+";
+	TextTokenizer tokenizer(chunk);
 
-	if (line[line.find_first_not_of(whitespace)] == '#')
-		return;
+	// buffer for the coefficients of the current line
+	std::vector<Coefficient> coefficients;
 
-	// position of relation
-	size_t r = line.find_first_of("<>=");
+	while (tokenizer.nextLine()) {
 
-	if (r == std::string::npos) {
+		if (!tokenizer.hasMore())
+			continue;
 
-		LOG_ERROR(constraintsreaderlog) << "found corrupted line" << std::endl;
-		return;
+		if (!readConstraint(tokenizer, coefficients, constraints[k]))
+			LOG_ERROR(constraintsreaderlog)
+					<< _filename << ", line " << tokenizer.getLineNumber()
+					<< ": found corrupted line" << std::endl;
 	}
+}
 
-	// to first coefficient
-	size_t i = line.find_first_not_of(whitespace);
-	size_t j;
+bool
+ConstraintsReader::readConstraint(
+		TextTokenizer&            tokenizer,
+		std::vector<Coefficient>& coefficients,
+		LinearConstraints&        constraints) {
 
-	// read coefficients
-	while (i < r) {
+	coefficients.clear();
 
-		// first after coefficient
-		j = line.find_first_not_of(number, i);
+	Relation relation;
 
-		double coef = boost::lexical_cast<double>(line.substr(i, j - i));
+	// read coefficients up to the relation
+	while (true) {
 
-		// to variable number
-		i = line.find_first_of(number, j);
-		// first after variable number
-		j = line.find_first_not_of(number, i);
+		if (!tokenizer.hasMore())
+			return false;
 
-		unsigned int var = boost::lexical_cast<unsigned int>(line.substr(i, j - i));
+		if (tokenizer.accept("<=")) {
 
-		// to next coefficient
-		i = line.find_first_of(number, j);
+			relation = LessEqual;
+			break;
+		}
 
-		constraint.setCoefficient(var, coef);
-	}
+		if (tokenizer.accept("==")) {
 
-	// read relation
-	i = r;
-	if (line.substr(i, 2) == "<=")
-		constraint.setRelation(LessEqual);
-	else if (line.substr(i, 2) == "==")
-		constraint.setRelation(Equal);
-	else if (line.substr(i, 2) == ">=")
-		constraint.setRelation(GreaterEqual);
-	else
-		LOG_ERROR(constraintsreaderlog) << "unknown relation " << line.substr(i, 2) << std::endl;
+			relation = Equal;
+			break;
+		}
 
-	i = line.find_first_of(number, r);
-	j = line.find_first_not_of(number, i);
+		if (tokenizer.accept(">=")) {
 
-	// read value
-	//LOG_ALL(constraintsreaderlog) << "i = " << i << ", j = " << j << ", substr = " << line.substr(i, j - i) << std::endl;
-	double value = boost::lexical_cast<double>(line.substr(i, j - i));
+			relation = GreaterEqual;
+			break;
+		}
+
+		double       coef;
+		unsigned int var;
 
-	constraint.setValue(value);
+		if (!tokenizer.readDouble(coef) || !tokenizer.accept('*') || !tokenizer.readUnsigned(var))
+			BOOST_THROW_EXCEPTION(
+					ConstraintsError() <<
+							error_message(
+									_filename + ", line " + boost::lexical_cast<std::string>(tokenizer.getLineNumber()) +
+									": expected <coefficient>*<variable> or relation, got '" + tokenizer.getToken() + "'"));
 
-	LOG_ALL(constraintsreaderlog) << "read constraint " << constraint << std::endl;
+		coefficients.push_back(Coefficient(var, coef));
+	}
 
-	// add the constraint
-	_constraints->add(constraint);
+	// read value
+	double value;
+	if (!tokenizer.readDouble(value))
+		BOOST_THROW_EXCEPTION(
+				ConstraintsError() <<
+						error_message(
+								_filename + ", line " + boost::lexical_cast<std::string>(tokenizer.getLineNumber()) +
+								": expected a value after the relation, got '" + tokenizer.getToken() + "'"));
+
+	// order the coefficients by variable, as in a LinearConstraint
+	bool sorted = true;
+	for (unsigned int i = 1; i < coefficients.size(); i++)
+		if (coefficients[i].first <= coefficients[i - 1].first)
+			sorted = false;
+	if (!sorted)
+		std::stable_sort(coefficients.begin(), coefficients.end(), &ConstraintsReader::variableLess);
+
+	// a variable given several times keeps its last coefficient, as with
+	// LinearConstraint::setCoefficient()
+	for (unsigned int i = 0; i < coefficients.size(); i++)
+		if (i + 1 == coefficients.size() || coefficients[i + 1].first != coefficients[i].first)
+			constraints.addCoefficient(coefficients[i].first, coefficients[i].second);
+	constraints.finishConstraint(relation, value);
+
+	return true;
 }
+
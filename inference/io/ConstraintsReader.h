@@ -2,25 +2,72 @@
 #define SBMRM_INFERENCE_IO_CONSTRAINTS_READER_H__
 
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <pipeline/SimpleProcessNode.h>
+#include <io/BinaryDataset.h>
+#include <io/TextFileReader.h>
+#include <io/TextTokenizer.h>
 #include <inference/LinearConstraints.h>
 
+struct ConstraintsError : virtual Exception {};
+
+/**
+ * Reads linear constraints from a file with one constraint per line,
+ *
+ *   <coefficient>*<variable> <coefficient>*<variable> ... <relation> <value>
+ *
+ * where relation is one of <=, ==, or >=. Large files are split into chunks
+ * of lines that are parsed concurrently (see TextFileReader). The file can
+ * also be a BinaryDataset, in which case the constraints are a view on the
+ * mapped file.
+ */
 class ConstraintsReader : public pipeline::SimpleProcessNode<> {
 
 public:
 
-	ConstraintsReader(std::string filename);
+	/**
+	 * Create a constraints reader.
+	 *
+	 * @param filename
+	 *              The file to read the constraints from.
+	 * @param numThreads
+	 *              The number of threads to parse the file with. 0 uses the
+	 *              value of --io.numThreads.
+	 */
+	ConstraintsReader(std::string filename, unsigned int numThreads = 0);
+
+	/**
+	 * Read the constraints directly, without the pipeline.
+	 */
+	void read(LinearConstraints& constraints);
 
 private:
 
 	void updateOutputs();
 
-	void readConstraint(std::string& line);
+	// parse the kth chunk of a block into constraints[k]
+	void parseChunk(const TextChunk& chunk, unsigned int k, std::vector<LinearConstraints>& constraints);
+
+	// a coefficient of a line, and the variable it belongs to
+	typedef std::pair<unsigned int, double> Coefficient;
+
+	// read the constraint on the current line of the tokenizer, returns
+	// false if the line is corrupted
+	bool readConstraint(
+			TextTokenizer&            tokenizer,
+			std::vector<Coefficient>& coefficients,
+			LinearConstraints&        constraints);
+
+	// orders coefficients by their variable
+	static bool variableLess(const Coefficient& a, const Coefficient& b) { return a.first < b.first; }
 
 	pipeline::Output<LinearConstraints> _constraints;
 
 	std::string _filename;
+
+	unsigned int _numThreads;
 };
 
 #endif // SBMRM_INFERENCE_IO_CONSTRAINTS_READER_H__
@@ -0,0 +1,215 @@
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/make_shared.hpp>
+
+#include <util/Logger.h>
+#include "BinaryDataset.h"
+
+logger::LogChannel binarydatasetlog("binarydatasetlog", "[BinaryDataset] ");
+
+namespace {
+
+const char            Magic[8]  = { 'S', 'B', 'M', 'R', 'M', 'D', 'A', 'T' };
+const boost::uint32_t ByteOrder = 0x01020304;
+
+// the alignment of the sections in the file
+const boost::uint64_t SectionAlignment = 64;
+
+struct Header {
+
+	char            magic[8];
+	boost::uint32_t version;
+	boost::uint32_t byteOrder;
+	boost::uint64_t numSections;
+	boost::uint64_t tableOffset;
+};
+
+} // anonymous namespace
+
+const boost::uint32_t BinaryDataset::Version;
+
+bool
+BinaryDataset::isBinaryDataset(const std::string& filename) {
+
+	std::FILE* file = std::fopen(filename.c_str(), "rb");
+
+	if (!file)
+		return false;
+
+	char magic[sizeof(Magic)];
+	bool isBinary = (std::fread(magic, 1, sizeof(Magic), file) == sizeof(Magic) && std::memcmp(magic, Magic, sizeof(Magic)) == 0);
+
+	std::fclose(file);
+
+	return isBinary;
+}
+
+BinaryDataset::BinaryDataset(const std::string& filename) :
+	_file(boost::make_shared<MappedFile>(filename)) {
+
+	if (_file->size() < sizeof(Header))
+		error("file is too small to be a binary dataset");
+
+	Header header;
+	std::memcpy(&header, _file->data(), sizeof(Header));
+
+	if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0)
+		error("not a binary dataset");
+
+	if (header.byteOrder != ByteOrder)
+		error("the dataset was written on a machine with a different byte order");
+
+	if (header.version != Version)
+		error(
+				"unsupported version " + boost::lexical_cast<std::string>(header.version) +
+				" (expected " + boost::lexical_cast<std::string>(Version) + "), convert the dataset again");
+
+	if (header.tableOffset > _file->size() || header.numSections > (_file->size() - header.tableOffset)/sizeof(SectionEntry))
+		error("the section table is truncated");
+
+	_sections.resize(header.numSections);
+	if (!_sections.empty())
+		std::memcpy(&_sections[0], _file->data() + header.tableOffset, _sections.size()*sizeof(SectionEntry));
+
+	for (unsigned int i = 0; i < _sections.size(); i++) {
+
+		const SectionEntry& entry = _sections[i];
+
+		if (entry.elementSize == 0 || entry.offset%SectionAlignment != 0)
+			error("section " + boost::lexical_cast<std::string>(entry.id) + " is corrupted");
+
+		if (entry.offset > _file->size() || entry.count > (_file->size() - entry.offset)/entry.elementSize)
+			error("section " + boost::lexical_cast<std::string>(entry.id) + " is truncated");
+	}
+
+	LOG_DEBUG(binarydatasetlog)
+			<< "mapped " << _file->size() << " bytes with "
+			<< _sections.size() << " sections from " << filename << std::endl;
+}
+
+bool
+BinaryDataset::has(Section section) const {
+
+	return find(section) != 0;
+}
+
+void*
+BinaryDataset::getSection(Section section, size_t elementSize, size_t& count) const {
+
+	const SectionEntry* entry = find(section);
+
+	if (!entry)
+		error("section " + boost::lexical_cast<std::string>(section) + " is missing");
+
+	if (entry->elementSize != elementSize)
+		error(
+				"elements of section " + boost::lexical_cast<std::string>(section) + " have " +
+				boost::lexical_cast<std::string>(entry->elementSize) + " bytes, expected " +
+				boost::lexical_cast<std::string>(elementSize));
+
+	count = entry->count;
+
+	return _file->data() + entry->offset;
+}
+
+const BinaryDataset::SectionEntry*
+BinaryDataset::find(Section section) const {
+
+	for (unsigned int i = 0; i < _sections.size(); i++)
+		if (_sections[i].id == static_cast<boost::uint32_t>(section))
+			return &_sections[i];
+
+	return 0;
+}
+
+void
+BinaryDataset::error(const std::string& message) const {
+
+	BOOST_THROW_EXCEPTION(BinaryDatasetError() << error_message(_file->getFilename() + ": " + message));
+}
+
+BinaryDatasetWriter::BinaryDatasetWriter(const std::string& filename) :
+	_filename(filename),
+	_file(std::fopen(filename.c_str(), "wb")),
+	_size(0) {
+
+	if (!_file)
+		error();
+
+	// a placeholder until the location of the section table is known
+	Header header;
+	std::memset(&header, 0, sizeof(Header));
+	write(&header, sizeof(Header));
+}
+
+BinaryDatasetWriter::~BinaryDatasetWriter() {
+
+	if (_file)
+		std::fclose(_file);
+}
+
+void
+BinaryDatasetWriter::addSection(BinaryDataset::Section section, const void* data, size_t elementSize, size_t count) {
+
+	const char padding[SectionAlignment] = { 0 };
+
+	if (_size%SectionAlignment != 0)
+		write(padding, SectionAlignment - _size%SectionAlignment);
+
+	BinaryDataset::SectionEntry entry;
+	entry.id          = section;
+	entry.elementSize = elementSize;
+	entry.offset      = _size;
+	entry.count       = count;
+
+	write(data, count*elementSize);
+
+	_sections.push_back(entry);
+}
+
+void
+BinaryDatasetWriter::finish() {
+
+	Header header;
+	std::memcpy(header.magic, Magic, sizeof(Magic));
+	header.version     = BinaryDataset::Version;
+	header.byteOrder   = ByteOrder;
+	header.numSections = _sections.size();
+	header.tableOffset = _size;
+
+	if (!_sections.empty())
+		write(&_sections[0], _sections.size()*sizeof(BinaryDataset::SectionEntry));
+
+	if (std::fseek(_file, 0, SEEK_SET) != 0 || std::fwrite(&header, sizeof(Header), 1, _file) != 1)
+		error();
+
+	std::FILE* file = _file;
+	_file = 0;
+
+	if (std::fclose(file) != 0)
+		error();
+
+	LOG_DEBUG(binarydatasetlog)
+			<< "wrote " << _size << " bytes with "
+			<< _sections.size() << " sections to " << _filename << std::endl;
+}
+
+void
+BinaryDatasetWriter::write(const void* data, size_t size) {
+
+	if (size > 0 && std::fwrite(data, size, 1, _file) != 1)
+		error();
+
+	_size += size;
+}
+
+void
+BinaryDatasetWriter::error() {
+
+	BOOST_THROW_EXCEPTION(
+			BinaryDatasetError() <<
+					error_message("could not write " + _filename + ": " + std::strerror(errno)));
+}
@@ -0,0 +1,206 @@
+#ifndef SBMRM_IO_BINARY_DATASET_H__
+#define SBMRM_IO_BINARY_DATASET_H__
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <util/exceptions.h>
+#include "MappedFile.h"
+
+struct BinaryDatasetError : virtual IOError {};
+
+/**
+ * A binary container for the features, labels, constraints and linear costs
+ * of a training sample, which can be used without parsing by mapping it into
+ * memory (see MappedFile). Features and LinearConstraints can be views on
+ * the mapped arrays (see MappableVector), such that loading a sample does
+ * not copy them, and several processes training on the same file share its
+ * pages in the page cache.
+ *
+ * The file starts with a header
+ *
+ *   char[8]  magic "SBMRMDAT"
+ *   uint32   version
+ *   uint32   byte order mark 0x01020304, as written by the host
+ *   uint64   number of sections
+ *   uint64   offset of the section table
+ *
+ * and the sections. The section table at the end of the file has one entry
+ * per section
+ *
+ *   uint32   section id (see Section)
+ *   uint32   size of an element in bytes
+ *   uint64   offset of the first element in the file
+ *   uint64   number of elements
+ *
+ * Sections are arrays of elements in host byte order, starting at 64 byte
+ * aligned offsets. Files are written with sbmrm-convert (see
+ * BinaryDatasetWriter).
+ */
+class BinaryDataset {
+
+public:
+
+	/**
+	 * The current version of the format.
+	 */
+	static const boost::uint32_t Version = 1;
+
+	/**
+	 * The ids of the sections. Sections that are not used by a sample can be
+	 * omitted.
+	 */
+	enum Section {
+
+		// uint64[4]: sparse (0 or 1), number of feature vectors, number of
+		// features, stride of dense features
+		FeaturesInfo = 1,
+
+		// double[number of feature vectors*stride], padded with zeros
+		DenseFeatures = 2,
+
+		// uint64[number of feature vectors + 1], uint32[], double[]: sparse
+		// features in CSR format
+		SparseRowStarts = 3,
+		SparseIndices   = 4,
+		SparseValues    = 5,
+
+		// uint8[]: one label (0 or 1) per component of y
+		Labels = 6,
+
+		// uint64[1]: one more than the largest variable used
+		ConstraintsInfo = 7,
+
+		// uint64[number of constraints + 1], uint32[], double[]: the
+		// coefficients of the constraints in CSR format
+		ConstraintRowStarts    = 8,
+		ConstraintVariables    = 9,
+		ConstraintCoefficients = 10,
+
+		// int32[], double[]: the relation and value of each constraint
+		ConstraintRelations = 11,
+		ConstraintValues    = 12,
+
+		// double[], double[1]: the coefficients and the constant offset of a
+		// linear cost function
+		CostCoefficients = 13,
+		CostConstant     = 14
+	};
+
+	/**
+	 * Check whether the given file starts like a binary dataset.
+	 */
+	static bool isBinaryDataset(const std::string& filename);
+
+	/**
+	 * Map a binary dataset into memory and check its header.
+	 */
+	BinaryDataset(const std::string& filename);
+
+	/**
+	 * Check whether the dataset contains the given section.
+	 */
+	bool has(Section section) const;
+
+	/**
+	 * Get the elements of a section. Throws, if the section does not exist
+	 * or its elements are not of size sizeof(T).
+	 *
+	 * @param section
+	 *              The section to get.
+	 * @param count
+	 *              Set to the number of elements.
+	 * @return The first element, valid as long as the owner of the mapping
+	 *              (see getOwner()) exists.
+	 */
+	template <typename T>
+	T* get(Section section, size_t& count) const {
+
+		return static_cast<T*>(getSection(section, sizeof(T), count));
+	}
+
+	/**
+	 * Get the owner of the memory of all sections, to keep it alive in views
+	 * on them.
+	 */
+	boost::shared_ptr<void> getOwner() const { return _file; }
+
+	const std::string& getFilename() const { return _file->getFilename(); }
+
+private:
+
+	struct SectionEntry {
+
+		boost::uint32_t id;
+		boost::uint32_t elementSize;
+		boost::uint64_t offset;
+		boost::uint64_t count;
+	};
+
+	void* getSection(Section section, size_t elementSize, size_t& count) const;
+
+	const SectionEntry* find(Section section) const;
+
+	// throw a BinaryDatasetError for this file
+	void error(const std::string& message) const;
+
+	boost::shared_ptr<MappedFile> _file;
+
+	std::vector<SectionEntry> _sections;
+
+	friend class BinaryDatasetWriter;
+};
+
+/**
+ * Writes a binary dataset section by section, see BinaryDataset for the
+ * format.
+ */
+class BinaryDatasetWriter : public boost::noncopyable {
+
+public:
+
+	BinaryDatasetWriter(const std::string& filename);
+
+	~BinaryDatasetWriter();
+
+	/**
+	 * Write a section of count elements.
+	 */
+	template <typename T>
+	void add(BinaryDataset::Section section, const T* data, size_t count) {
+
+		addSection(section, data, sizeof(T), count);
+	}
+
+	/**
+	 * Write the section table and close the file. The file is not a valid
+	 * dataset before.
+	 */
+	void finish();
+
+private:
+
+	void addSection(BinaryDataset::Section section, const void* data, size_t elementSize, size_t count);
+
+	void write(const void* data, size_t size);
+
+	// throw a BinaryDatasetError for this file
+	void error();
+
+	std::string _filename;
+
+	std::FILE* _file;
+
+	// the number of bytes written so far
+	boost::uint64_t _size;
+
+	std::vector<BinaryDataset::SectionEntry> _sections;
+};
+
+#endif // SBMRM_IO_BINARY_DATASET_H__
+
@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <zlib.h>
+
+#include <boost/bind/bind.hpp>
+#include <util/Logger.h>
+#include "GzipReader.h"
+
+logger::LogChannel gzipreaderlog("gzipreaderlog", "[GzipReader] ");
+
+// the size of the compressed and decompressed buffers
+static const size_t BufferSize = 1024*1024;
+
+GzipReader::GzipReader(std::FILE* file, const std::string& filename, size_t maxBuffered) :
+	_file(file),
+	_filename(filename),
+	_maxBuffered(maxBuffered),
+	_buffered(0),
+	_position(0),
+	_done(false),
+	_stop(false) {
+
+	LOG_DEBUG(gzipreaderlog) << "decompressing " << filename << std::endl;
+
+	_thread = boost::thread(boost::bind(&GzipReader::decompress, this));
+}
+
+GzipReader::~GzipReader() {
+
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+		_stop = true;
+	}
+
+	_changed.notify_all();
+	_thread.join();
+}
+
+bool
+GzipReader::isGzip(std::FILE* file) {
+
+	int first  = std::fgetc(file);
+	int second = std::fgetc(file);
+
+	std::rewind(file);
+
+	return (first == 0x1f && second == 0x8b);
+}
+
+size_t
+GzipReader::read(char* data, size_t size) {
+
+	size_t read = 0;
+
+	while (read < size) {
+
+		if (_position == _current.size()) {
+
+			boost::mutex::scoped_lock lock(_mutex);
+
+			while (_buffers.empty() && !_done)
+				_changed.wait(lock);
+
+			if (_buffers.empty()) {
+
+				if (_exception)
+					boost::rethrow_exception(_exception);
+
+				break;
+			}
+
+			_current.swap(_buffers.front());
+			_buffers.pop_front();
+			_buffered -= _current.size();
+			_position = 0;
+
+			_changed.notify_all();
+		}
+
+		size_t n = std::min(size - read, _current.size() - _position);
+		std::memcpy(data + read, &_current[_position], n);
+		read      += n;
+		_position += n;
+	}
+
+	return read;
+}
+
+void
+GzipReader::decompress() {
+
+	try {
+
+		inflateFile();
+
+	} catch (...) {
+
+		boost::mutex::scoped_lock lock(_mutex);
+		_exception = boost::current_exception();
+	}
+
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+		_done = true;
+	}
+
+	_changed.notify_all();
+}
+
+void
+GzipReader::inflateFile() {
+
+	z_stream stream;
+	std::memset(&stream, 0, sizeof(stream));
+
+	// expect a gzip header
+	if (inflateInit2(&stream, 15 + 16) != Z_OK)
+		BOOST_THROW_EXCEPTION(GzipError() << error_message("could not initialize zlib"));
+
+	std::vector<char> in(BufferSize);
+	std::vector<char> out(BufferSize);
+
+	// the end of the current gzip stream was reached
+	bool streamEnd = false;
+
+	try {
+
+		while (true) {
+
+			if (stream.avail_in == 0) {
+
+				stream.avail_in = std::fread(&in[0], 1, in.size(), _file);
+				stream.next_in  = reinterpret_cast<Bytef*>(&in[0]);
+
+				if (std::ferror(_file))
+					BOOST_THROW_EXCEPTION(
+							GzipError() <<
+									error_message("could not read from " + _filename + ": " + std::strerror(errno)));
+
+				if (stream.avail_in == 0) {
+
+					if (!streamEnd)
+						BOOST_THROW_EXCEPTION(GzipError() << error_message(_filename + " is truncated"));
+
+					break;
+				}
+			}
+
+			// another stream follows
+			if (streamEnd) {
+
+				inflateReset(&stream);
+				streamEnd = false;
+			}
+
+			stream.next_out  = reinterpret_cast<Bytef*>(&out[0]);
+			stream.avail_out = out.size();
+
+			int result = inflate(&stream, Z_NO_FLUSH);
+
+			if (result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR)
+				BOOST_THROW_EXCEPTION(
+						GzipError() <<
+								error_message(_filename + " is corrupted: " + (stream.msg ? stream.msg : "unknown error")));
+
+			streamEnd = (result == Z_STREAM_END);
+
+			out.resize(out.size() - stream.avail_out);
+
+			if (!out.empty() && !push(out))
+				break;
+
+			out.resize(BufferSize);
+		}
+
+	} catch (...) {
+
+		inflateEnd(&stream);
+		throw;
+	}
+
+	inflateEnd(&stream);
+}
+
+bool
+GzipReader::push(std::vector<char>& buffer) {
+
+	boost::mutex::scoped_lock lock(_mutex);
+
+	while (_buffered >= _maxBuffered && !_stop)
+		_changed.wait(lock);
+
+	if (_stop)
+		return false;
+
+	_buffered += buffer.size();
+	_buffers.push_back(std::vector<char>());
+	_buffers.back().swap(buffer);
+
+	_changed.notify_all();
+
+	return true;
+}
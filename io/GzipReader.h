@@ -0,0 +1,96 @@
+#ifndef SBMRM_IO_GZIP_READER_H__
+#define SBMRM_IO_GZIP_READER_H__
+
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <boost/exception_ptr.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread.hpp>
+
+#include <util/exceptions.h>
+
+struct GzipError : virtual Exception {};
+
+/**
+ * Decompresses a gzip file on a separate thread, such that the decompression
+ * of the next part of the file overlaps with the processing of the current
+ * one. Files consisting of several concatenated gzip streams are
+ * decompressed as one.
+ */
+class GzipReader : public boost::noncopyable {
+
+public:
+
+	/**
+	 * Start decompressing a file.
+	 *
+	 * @param file
+	 *              The file to read from, positioned at the gzip header. Has
+	 *              to stay open while the reader exists.
+	 * @param filename
+	 *              The name of the file, for error messages.
+	 * @param maxBuffered
+	 *              The number of decompressed bytes to buffer ahead of the
+	 *              reads.
+	 */
+	GzipReader(std::FILE* file, const std::string& filename, size_t maxBuffered);
+
+	~GzipReader();
+
+	/**
+	 * Check whether a file starts with the magic bytes of gzip.
+	 */
+	static bool isGzip(std::FILE* file);
+
+	/**
+	 * Read up to size decompressed bytes. Blocks until size bytes were
+	 * decompressed or the end of the file was reached.
+	 *
+	 * @return The number of bytes read, less than size only at the end of
+	 *              the file.
+	 */
+	size_t read(char* data, size_t size);
+
+private:
+
+	// the decompression thread
+	void decompress();
+
+	void inflateFile();
+
+	// hand a buffer of decompressed data to read(), blocks while too much
+	// data is buffered
+	bool push(std::vector<char>& buffer);
+
+	std::FILE*  _file;
+	std::string _filename;
+
+	size_t _maxBuffered;
+
+	// decompressed buffers not read yet, and the total number of bytes in
+	// them
+	std::deque<std::vector<char> > _buffers;
+	size_t                         _buffered;
+
+	// the buffer read() is currently reading from
+	std::vector<char> _current;
+	size_t            _position;
+
+	// set by the decompression thread when it is done
+	bool                  _done;
+	boost::exception_ptr  _exception;
+
+	// set by the destructor to stop the decompression thread
+	bool _stop;
+
+	boost::mutex              _mutex;
+	boost::condition_variable _changed;
+
+	boost::thread _thread;
+};
+
+#endif // SBMRM_IO_GZIP_READER_H__
+
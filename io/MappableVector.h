@@ -0,0 +1,165 @@
+#ifndef SBMRM_IO_MAPPABLE_VECTOR_H__
+#define SBMRM_IO_MAPPABLE_VECTOR_H__
+
+#include <memory>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+/**
+ * A vector that either owns its elements, or is a view on an array in
+ * memory owned by someone else, e.g., a memory mapped file (see
+ * BinaryDataset). Views keep the owner of the memory alive.
+ *
+ * Elements of a view can be changed in place. Operations that change the
+ * size of a view copy the elements into an owned std::vector first.
+ * Copies of a MappableVector always own their elements.
+ */
+template <typename T, typename Allocator = std::allocator<T> >
+class MappableVector {
+
+public:
+
+	typedef T*       iterator;
+	typedef const T* const_iterator;
+
+	MappableVector() :
+		_data(0),
+		_size(0) {}
+
+	MappableVector(size_t size, const T& value) :
+		_owned(size, value) {
+
+		update();
+	}
+
+	MappableVector(const MappableVector& other) :
+		_owned(other.begin(), other.end()) {
+
+		update();
+	}
+
+	MappableVector& operator=(const MappableVector& other) {
+
+		if (&other != this) {
+
+			std::vector<T, Allocator> owned(other.begin(), other.end());
+			_owned.swap(owned);
+			_mapping.reset();
+			update();
+		}
+
+		return *this;
+	}
+
+	/**
+	 * Make this a view on the given array of size elements. The owner of the
+	 * memory is kept alive as long as the view exists.
+	 */
+	void map(T* data, size_t size, boost::shared_ptr<void> owner) {
+
+		std::vector<T, Allocator>().swap(_owned);
+		_mapping = owner;
+		_data    = data;
+		_size    = size;
+	}
+
+	/**
+	 * True, if this is a view on memory owned by someone else.
+	 */
+	bool isMapped() const { return _mapping.get() != 0; }
+
+	size_t size() const { return _size; }
+
+	bool empty() const { return _size == 0; }
+
+	T*       data()       { return _data; }
+	const T* data() const { return _data; }
+
+	iterator       begin()       { return _data; }
+	const_iterator begin() const { return _data; }
+	iterator       end()       { return _data + _size; }
+	const_iterator end() const { return _data + _size; }
+
+	T&       operator[](size_t i)       { return _data[i]; }
+	const T& operator[](size_t i) const { return _data[i]; }
+
+	T&       back()       { return _data[_size - 1]; }
+	const T& back() const { return _data[_size - 1]; }
+
+	void push_back(const T& value) {
+
+		own();
+		_owned.push_back(value);
+		update();
+	}
+
+	template <typename InputIterator>
+	void insert(const_iterator position, InputIterator first, InputIterator last) {
+
+		size_t offset = position - _data;
+
+		own();
+		_owned.insert(_owned.begin() + offset, first, last);
+		update();
+	}
+
+	void resize(size_t size, const T& value = T()) {
+
+		own();
+		_owned.resize(size, value);
+		update();
+	}
+
+	void assign(size_t size, const T& value) {
+
+		_mapping.reset();
+		_owned.assign(size, value);
+		update();
+	}
+
+	void reserve(size_t size) {
+
+		own();
+		_owned.reserve(size);
+		update();
+	}
+
+	void clear() {
+
+		_mapping.reset();
+		_owned.clear();
+		update();
+	}
+
+private:
+
+	// copy the elements of a view into _owned
+	void own() {
+
+		if (!_mapping)
+			return;
+
+		std::vector<T, Allocator> owned(_data, _data + _size);
+		_owned.swap(owned);
+		_mapping.reset();
+		update();
+	}
+
+	void update() {
+
+		_data = (_owned.empty() ? 0 : &_owned[0]);
+		_size = _owned.size();
+	}
+
+	std::vector<T, Allocator> _owned;
+
+	// the owner of the memory of a view, empty if _owned is used
+	boost::shared_ptr<void> _mapping;
+
+	T*     _data;
+	size_t _size;
+};
+
+#endif // SBMRM_IO_MAPPABLE_VECTOR_H__
+
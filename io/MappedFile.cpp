@@ -0,0 +1,62 @@
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "MappedFile.h"
+
+MappedFile::MappedFile(const std::string& filename) :
+	_filename(filename),
+	_data(0),
+	_size(0) {
+
+	int fd = open(filename.c_str(), O_RDONLY);
+
+	if (fd < 0)
+		BOOST_THROW_EXCEPTION(
+				MappedFileError() <<
+						error_message("could not open " + filename + ": " + std::strerror(errno)));
+
+	struct stat status;
+
+	if (fstat(fd, &status) != 0) {
+
+		int error = errno;
+		close(fd);
+
+		BOOST_THROW_EXCEPTION(
+				MappedFileError() <<
+						error_message("could not stat " + filename + ": " + std::strerror(error)));
+	}
+
+	_size = status.st_size;
+
+	if (_size > 0) {
+
+		void* data = mmap(0, _size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+		if (data == MAP_FAILED) {
+
+			int error = errno;
+			close(fd);
+
+			BOOST_THROW_EXCEPTION(
+					MappedFileError() <<
+							error_message("could not map " + filename + ": " + std::strerror(error)));
+		}
+
+		_data = static_cast<char*>(data);
+	}
+
+	// the mapping stays valid without the descriptor
+	close(fd);
+}
+
+MappedFile::~MappedFile() {
+
+	if (_data)
+		munmap(_data, _size);
+}
@@ -0,0 +1,43 @@
+#ifndef SBMRM_IO_MAPPED_FILE_H__
+#define SBMRM_IO_MAPPED_FILE_H__
+
+#include <string>
+
+#include <boost/noncopyable.hpp>
+
+#include <util/exceptions.h>
+
+struct MappedFileError : virtual Exception {};
+
+/**
+ * A file mapped into memory with mmap. The mapping is private and writable:
+ * pages that are only read are shared with the page cache (and all other
+ * processes mapping the same file), pages that are written to are copied
+ * for this process and never written back to the file.
+ */
+class MappedFile : public boost::noncopyable {
+
+public:
+
+	MappedFile(const std::string& filename);
+
+	~MappedFile();
+
+	char* data() { return _data; }
+
+	const char* data() const { return _data; }
+
+	size_t size() const { return _size; }
+
+	const std::string& getFilename() const { return _filename; }
+
+private:
+
+	std::string _filename;
+
+	char*  _data;
+	size_t _size;
+};
+
+#endif // SBMRM_IO_MAPPED_FILE_H__
+
@@ -0,0 +1,249 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+
+#include <sys/stat.h>
+
+#include <boost/bind/bind.hpp>
+#include <boost/thread.hpp>
+
+#include <util/Logger.h>
+#include <util/ProgramOptions.h>
+#include "TextFileReader.h"
+
+logger::LogChannel textfilereaderlog("textfilereaderlog", "[TextFileReader] ");
+
+util::ProgramOption optionIoNumThreads(
+		util::_module           = "io",
+		util::_long_name        = "numThreads",
+		util::_description_text = "The number of threads to parse input files with. 0 uses all available CPUs.",
+		util::_default_value    = 0);
+
+// the number of bytes to read per block, blocks are enlarged for longer
+// lines
+static const size_t BlockSize = 64*1024*1024;
+
+// the first read size for files of unknown size
+static const size_t MinReadSize = 64*1024;
+
+static const size_t UnknownSize = std::numeric_limits<size_t>::max();
+
+TextFileReader::TextFileReader(const std::string& filename, unsigned int numChunks) :
+	_filename(filename),
+	_file(std::fopen(filename.c_str(), "rb")),
+	_numChunks(numChunks),
+	_capacity(0),
+	_remaining(UnknownSize),
+	_readSize(MinReadSize),
+	_nextLine(1) {
+
+	if (!_file)
+		BOOST_THROW_EXCEPTION(
+				TextFileError() <<
+						error_message("could not open " + filename + ": " + std::strerror(errno)));
+
+	if (_numChunks == 0)
+		_numChunks = getNumThreads();
+
+	// decompress the next block while the current one is parsed
+	if (GzipReader::isGzip(_file)) {
+
+		_gzip.reset(new GzipReader(_file, filename, BlockSize));
+
+	} else {
+
+		// read regular files in blocks of at most their size
+		struct stat status;
+		if (fstat(fileno(_file), &status) == 0 && S_ISREG(status.st_mode))
+			_remaining = status.st_size - std::ftell(_file);
+	}
+}
+
+TextFileReader::~TextFileReader() {
+
+	// stop the decompression before closing the file
+	_gzip.reset();
+
+	std::fclose(_file);
+}
+
+unsigned int
+TextFileReader::getNumThreads() {
+
+	unsigned int numThreads = optionIoNumThreads.as<unsigned int>();
+
+	if (numThreads == 0)
+		numThreads = std::max(1u, boost::thread::hardware_concurrency());
+
+	return numThreads;
+}
+
+bool
+TextFileReader::readBlock(std::vector<TextChunk>& chunks) {
+
+	chunks.clear();
+
+	// the block starts with the incomplete last line of the previous one
+	size_t size = _carry.size();
+	reserve(0, size);
+	std::copy(_carry.begin(), _carry.end(), _block.get());
+	_carry.clear();
+
+	// read until the block contains at least one complete line
+	size_t lastNewline;
+	bool   atEnd = false;
+
+	while (true) {
+
+		size_t request = (_remaining == UnknownSize ? _readSize : std::min(BlockSize, _remaining));
+
+		// leave room for a terminating newline and 0
+		reserve(size, size + request + 2);
+
+		size_t read = this->read(_block.get() + size, request);
+		size += read;
+
+		atEnd = (read < request || _remaining == 0);
+
+		if (_remaining == UnknownSize && !atEnd)
+			_readSize = std::min(2*_readSize, BlockSize);
+
+		// the end of the last complete line
+		const char* begin = _block.get();
+		lastNewline = std::find(
+				std::reverse_iterator<const char*>(begin + size),
+				std::reverse_iterator<const char*>(begin),
+				'\n').base() - begin;
+
+		if (lastNewline > 0 || atEnd)
+			break;
+	}
+
+	if (atEnd) {
+
+		// terminate the last line, if the file does not
+		if (size > 0 && _block[size - 1] != '\n') {
+
+			_block[size] = '\n';
+			size++;
+		}
+
+		lastNewline = size;
+	}
+
+	if (size == 0)
+		return false;
+
+	// keep the incomplete last line for the next block
+	_carry.assign(_block.get() + lastNewline, _block.get() + size);
+
+	_block[lastNewline] = 0;
+
+	split(_block.get(), _block.get() + lastNewline, chunks);
+
+	LOG_DEBUG(textfilereaderlog)
+			<< "read " << lastNewline << " bytes from " << _filename
+			<< " in " << chunks.size() << " chunks" << std::endl;
+
+	return true;
+}
+
+size_t
+TextFileReader::read(char* data, size_t size) {
+
+	if (_gzip)
+		return _gzip->read(data, size);
+
+	size_t read = std::fread(data, 1, size, _file);
+
+	if (std::ferror(_file))
+		BOOST_THROW_EXCEPTION(
+				TextFileError() <<
+						error_message("could not read from " + _filename + ": " + std::strerror(errno)));
+
+	if (_remaining != UnknownSize)
+		_remaining -= std::min(_remaining, read);
+
+	return read;
+}
+
+void
+TextFileReader::reserve(size_t size, size_t capacity) {
+
+	if (capacity <= _capacity)
+		return;
+
+	// grow geometrically, such that long lines are copied only a few times
+	capacity = std::max(capacity, 2*_capacity);
+
+	char* block = new char[capacity];
+	std::copy(_block.get(), _block.get() + size, block);
+
+	_block.reset(block);
+	_capacity = capacity;
+}
+
+void
+TextFileReader::split(const char* begin, const char* end, std::vector<TextChunk>& chunks) {
+
+	size_t chunkSize = std::max(static_cast<size_t>(1), static_cast<size_t>(end - begin)/_numChunks);
+
+	while (begin != end) {
+
+		const char* chunkEnd = end;
+
+		if (static_cast<size_t>(end - begin) > chunkSize && chunks.size() + 1 < _numChunks)
+			chunkEnd = std::find(begin + chunkSize, end, '\n') + 1;
+
+		chunkEnd = std::min(chunkEnd, end);
+
+		TextChunk chunk;
+		chunk.begin     = begin;
+		chunk.end       = chunkEnd;
+		chunk.firstLine = _nextLine;
+		chunks.push_back(chunk);
+
+		_nextLine += std::count(begin, chunkEnd, '\n');
+		begin = chunkEnd;
+	}
+}
+
+void
+TextFileReader::parseChunks(
+		const std::vector<TextChunk>&                           chunks,
+		boost::function<void(const TextChunk&, unsigned int)> parse) {
+
+	std::vector<boost::exception_ptr> exceptions(chunks.size());
+
+	// the calling thread parses the first chunk
+	boost::thread_group workers;
+	for (unsigned int k = 1; k < chunks.size(); k++)
+		workers.create_thread(boost::bind(&TextFileReader::parseChunk, parse, boost::cref(chunks[k]), k, boost::ref(exceptions[k])));
+	if (!chunks.empty())
+		parseChunk(parse, chunks[0], 0, exceptions[0]);
+	workers.join_all();
+
+	// report the error of the first line in the file
+	for (unsigned int k = 0; k < chunks.size(); k++)
+		if (exceptions[k])
+			boost::rethrow_exception(exceptions[k]);
+}
+
+void
+TextFileReader::parseChunk(
+		boost::function<void(const TextChunk&, unsigned int)> parse,
+		const TextChunk&                                        chunk,
+		unsigned int                                            k,
+		boost::exception_ptr&                                   exception) {
+
+	try {
+
+		parse(chunk, k);
+
+	} catch (...) {
+
+		exception = boost::current_exception();
+	}
+}
+
@@ -0,0 +1,132 @@
+#ifndef SBMRM_IO_TEXT_FILE_READER_H__
+#define SBMRM_IO_TEXT_FILE_READER_H__
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <boost/exception_ptr.hpp>
+#include <boost/function.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include <util/exceptions.h>
+#include "GzipReader.h"
+
+struct TextFileError : virtual Exception {};
+
+/**
+ * A range of complete lines of a text file.
+ */
+struct TextChunk {
+
+	const char* begin;
+	const char* end;
+
+	// the number of the first line of the chunk, starting at 1
+	unsigned int firstLine;
+};
+
+/**
+ * Reads a text file in large blocks of complete lines, each split into
+ * chunks of similar size that can be parsed concurrently (see
+ * parseChunks()) with a TextTokenizer each. The lines are not copied.
+ *
+ * Every block is terminated by a 0 character, and the last line of a file
+ * is terminated by a newline, even if the file is not.
+ *
+ * Gzip compressed files are recognized by their first bytes and
+ * decompressed on a separate thread while the previous block is parsed (see
+ * GzipReader).
+ */
+class TextFileReader {
+
+public:
+
+	/**
+	 * Open a text file.
+	 *
+	 * @param filename
+	 *              The file to read.
+	 * @param numChunks
+	 *              The number of chunks per block. 0 uses the value of
+	 *              --io.numThreads.
+	 */
+	TextFileReader(const std::string& filename, unsigned int numChunks = 0);
+
+	~TextFileReader();
+
+	/**
+	 * Read the next block of lines from the file. The chunks stay valid until
+	 * the next call.
+	 *
+	 * @return false, if the end of the file was reached.
+	 */
+	bool readBlock(std::vector<TextChunk>& chunks);
+
+	const std::string& getFilename() const { return _filename; }
+
+	/**
+	 * Get the number of threads to parse files with, as given by
+	 * --io.numThreads or the number of CPUs.
+	 */
+	static unsigned int getNumThreads();
+
+	/**
+	 * Call parse(chunk, k) for each chunk k concurrently, one thread per
+	 * chunk. Exceptions thrown by parse are rethrown in the calling thread.
+	 */
+	static void parseChunks(
+			const std::vector<TextChunk>&                           chunks,
+			boost::function<void(const TextChunk&, unsigned int)> parse);
+
+private:
+
+	// the worker for one chunk in parseChunks()
+	static void parseChunk(
+			boost::function<void(const TextChunk&, unsigned int)> parse,
+			const TextChunk&                                        chunk,
+			unsigned int                                            k,
+			boost::exception_ptr&                                   exception);
+
+	// read up to size bytes of the (decompressed) file
+	size_t read(char* data, size_t size);
+
+	// make room for at least capacity bytes in _block, keeping the first
+	// size ones
+	void reserve(size_t size, size_t capacity);
+
+	// split [begin, end) into chunks at line boundaries
+	void split(const char* begin, const char* end, std::vector<TextChunk>& chunks);
+
+	std::string _filename;
+
+	std::FILE* _file;
+
+	// decompresses _file, if it is gzip compressed
+	boost::scoped_ptr<GzipReader> _gzip;
+
+	unsigned int _numChunks;
+
+	// the current block, followed by a 0, and its allocated size (not
+	// initialized beyond the data read)
+	boost::scoped_array<char> _block;
+	size_t                    _capacity;
+
+	// the number of bytes of a regular file not read yet, or -1 for
+	// compressed files and files of unknown size
+	size_t _remaining;
+
+	// the number of bytes to request from files of unknown size, doubled
+	// with every full read up to BlockSize
+	size_t _readSize;
+
+	// the incomplete last line of the previous block
+	std::vector<char> _carry;
+
+	// the number of the next line to read
+	unsigned int _nextLine;
+};
+
+#endif // SBMRM_IO_TEXT_FILE_READER_H__
+
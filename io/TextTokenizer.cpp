@@ -0,0 +1,309 @@
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+
+#include <boost/cstdint.hpp>
+
+#include "TextTokenizer.h"
+
+namespace {
+
+inline bool
+isDigit(char c) {
+
+	return c >= '0' && c <= '9';
+}
+
+inline bool
+isWhitespace(char c) {
+
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+// characters that can start a number
+inline bool
+isNumberStart(char c) {
+
+	return isDigit(c) || c == '.' || c == '-' || c == '+';
+}
+
+// characters that can be part of a number
+inline bool
+isNumberChar(char c) {
+
+	return isNumberStart(c) || c == 'e' || c == 'E';
+}
+
+// the powers of ten that are exactly representable as double
+const double PowersOfTen[] = {
+
+	1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// the number of significant decimal digits that fit into the mantissa
+// accumulator
+const int MaxDigits = 19;
+
+// the largest integer up to which all integers are exactly representable as
+// double
+const boost::uint64_t MaxExactInteger = boost::uint64_t(1) << 53;
+
+} // anonymous namespace
+
+TextTokenizer::TextTokenizer(const TextChunk& chunk) :
+	_pos(chunk.begin),
+	_lineEnd(chunk.begin),
+	_next(chunk.begin),
+	_end(chunk.end),
+	_lineNumber(chunk.firstLine - 1) {}
+
+bool
+TextTokenizer::nextLine() {
+
+	if (_next == _end)
+		return false;
+
+	// every line of a chunk ends with a newline
+	const char* newline = static_cast<const char*>(std::memchr(_next, '\n', _end - _next));
+	if (!newline)
+		newline = _end;
+
+	_pos     = _next;
+	_lineEnd = newline;
+	_next    = (newline == _end ? _end : newline + 1);
+	_lineNumber++;
+
+	const char* comment = static_cast<const char*>(std::memchr(_pos, '#', _lineEnd - _pos));
+	if (comment)
+		_lineEnd = comment;
+
+	return true;
+}
+
+void
+TextTokenizer::skipWhitespace() {
+
+	while (_pos != _lineEnd && isWhitespace(*_pos))
+		_pos++;
+}
+
+bool
+TextTokenizer::hasMore() {
+
+	skipWhitespace();
+
+	return _pos != _lineEnd;
+}
+
+bool
+TextTokenizer::skipToNumber() {
+
+	while (_pos != _lineEnd && !isNumberStart(*_pos))
+		_pos++;
+
+	return _pos != _lineEnd;
+}
+
+bool
+TextTokenizer::readDouble(double& value) {
+
+	/*
+	  Accumulate up to MaxDigits significant digits into an integer mantissa m
+	  and a decimal exponent e. If m ≤ 2^53 and |e| ≤ 22, both m and 10^|e|
+	  are exact doubles and a single multiplication or division gives the
+	  correctly rounded result. Otherwise, fall back to strtod.
+	*/
+
+	skipWhitespace();
+
+	const char* p = _pos;
+
+	bool negative = false;
+	if (p != _lineEnd && (*p == '-' || *p == '+')) {
+
+		negative = (*p == '-');
+		p++;
+	}
+
+	boost::uint64_t mantissa  = 0;
+	int             numDigits = 0;
+	int             exponent  = 0;
+	bool            anyDigits = false;
+	bool            truncated = false;
+
+	for (; p != _lineEnd && isDigit(*p); p++) {
+
+		anyDigits = true;
+
+		if (numDigits < MaxDigits) {
+
+			mantissa = mantissa*10 + (*p - '0');
+			if (mantissa > 0)
+				numDigits++;
+
+		} else {
+
+			exponent++;
+			truncated = true;
+		}
+	}
+
+	if (p != _lineEnd && *p == '.') {
+
+		for (p++; p != _lineEnd && isDigit(*p); p++) {
+
+			anyDigits = true;
+
+			if (numDigits < MaxDigits) {
+
+				mantissa = mantissa*10 + (*p - '0');
+				if (mantissa > 0)
+					numDigits++;
+				exponent--;
+
+			} else {
+
+				truncated = true;
+			}
+		}
+	}
+
+	if (!anyDigits)
+		return false;
+
+	if (p != _lineEnd && (*p == 'e' || *p == 'E')) {
+
+		p++;
+
+		bool negativeExponent = false;
+		if (p != _lineEnd && (*p == '-' || *p == '+')) {
+
+			negativeExponent = (*p == '-');
+			p++;
+		}
+
+		if (p == _lineEnd || !isDigit(*p))
+			return false;
+
+		int e = 0;
+		for (; p != _lineEnd && isDigit(*p); p++)
+			if (e < 100000)
+				e = e*10 + (*p - '0');
+
+		exponent += (negativeExponent ? -e : e);
+	}
+
+	// the number has to end here
+	if (p != _lineEnd && isNumberChar(*p))
+		return false;
+
+	if (!truncated && mantissa <= MaxExactInteger && exponent >= -22 && exponent <= 22) {
+
+		value = static_cast<double>(mantissa);
+		if (exponent < 0)
+			value /= PowersOfTen[-exponent];
+		else
+			value *= PowersOfTen[exponent];
+
+		if (negative)
+			value = -value;
+
+	} else {
+
+		// the number is followed by a character strtod does not accept
+		// either, the line is terminated by a newline or the 0 after the block
+		char* end;
+		value = std::strtod(_pos, &end);
+
+		if (end != p)
+			return false;
+	}
+
+	_pos = p;
+
+	return true;
+}
+
+bool
+TextTokenizer::readUnsigned(unsigned int& value) {
+
+	skipWhitespace();
+
+	const char* p = _pos;
+
+	if (p != _lineEnd && *p == '+')
+		p++;
+
+	if (p == _lineEnd || !isDigit(*p))
+		return false;
+
+	unsigned int v = 0;
+	for (; p != _lineEnd && isDigit(*p); p++) {
+
+		unsigned int digit = *p - '0';
+
+		if (v > (UINT_MAX - digit)/10)
+			return false;
+
+		v = v*10 + digit;
+	}
+
+	if (p != _lineEnd && isNumberChar(*p))
+		return false;
+
+	value = v;
+	_pos  = p;
+
+	return true;
+}
+
+bool
+TextTokenizer::accept(char c) {
+
+	skipWhitespace();
+
+	if (_pos == _lineEnd || *_pos != c)
+		return false;
+
+	_pos++;
+
+	return true;
+}
+
+bool
+TextTokenizer::accept(const char* s) {
+
+	skipWhitespace();
+
+	size_t length = std::strlen(s);
+
+	if (static_cast<size_t>(_lineEnd - _pos) < length || std::strncmp(_pos, s, length) != 0)
+		return false;
+
+	_pos += length;
+
+	return true;
+}
+
+bool
+TextTokenizer::contains(const char* s) const {
+
+	return std::search(_pos, _lineEnd, s, s + std::strlen(s)) != _lineEnd;
+}
+
+std::string
+TextTokenizer::getToken() const {
+
+	const char* begin = _pos;
+	while (begin != _lineEnd && isWhitespace(*begin))
+		begin++;
+
+	const char* end = begin;
+	while (end != _lineEnd && !isWhitespace(*end))
+		end++;
+
+	return std::string(begin, end);
+}
+
@@ -0,0 +1,107 @@
+#ifndef SBMRM_IO_TEXT_TOKENIZER_H__
+#define SBMRM_IO_TEXT_TOKENIZER_H__
+
+#include <string>
+
+#include "TextFileReader.h"
+
+/**
+ * Splits a chunk of a text file into lines and parses numbers in place,
+ * without allocating memory. Everything from a '#' to the end of a line is a
+ * comment and ignored.
+ *
+ * Typical use:
+ *
+ *   TextTokenizer tokenizer(chunk);
+ *   while (tokenizer.nextLine())
+ *     while (tokenizer.hasMore())
+ *       if (!tokenizer.readDouble(value))
+ *         // report error in line tokenizer.getLineNumber()
+ */
+class TextTokenizer {
+
+public:
+
+	TextTokenizer(const TextChunk& chunk);
+
+	/**
+	 * Move to the next line of the chunk.
+	 *
+	 * @return false, if there are no more lines.
+	 */
+	bool nextLine();
+
+	/**
+	 * The number of the current line in the file, starting at 1.
+	 */
+	unsigned int getLineNumber() const { return _lineNumber; }
+
+	/**
+	 * Skip whitespace.
+	 *
+	 * @return true, if the current line has more content.
+	 */
+	bool hasMore();
+
+	/**
+	 * Skip all characters up to the next one that can start a number.
+	 *
+	 * @return true, if there is one on the current line.
+	 */
+	bool skipToNumber();
+
+	/**
+	 * Parse a floating point number at the current position, followed by a
+	 * character that can not be part of a number.
+	 *
+	 * @return false, if there is no valid number. The position is not
+	 * changed in this case.
+	 */
+	bool readDouble(double& value);
+
+	/**
+	 * Same as readDouble() for unsigned integers.
+	 */
+	bool readUnsigned(unsigned int& value);
+
+	/**
+	 * Skip whitespace and consume the given character, if it follows.
+	 *
+	 * @return false, if the next character is a different one.
+	 */
+	bool accept(char c);
+
+	/**
+	 * Same as accept(char) for a string.
+	 */
+	bool accept(const char* s);
+
+	/**
+	 * True, if the rest of the current line contains the given string.
+	 */
+	bool contains(const char* s) const;
+
+	/**
+	 * The whitespace separated token at the current position, for error
+	 * messages.
+	 */
+	std::string getToken() const;
+
+private:
+
+	// skip whitespace on the current line
+	void skipWhitespace();
+
+	// the current position and the end of the content of the current line
+	const char* _pos;
+	const char* _lineEnd;
+
+	// the start of the next line and the end of the chunk
+	const char* _next;
+	const char* _end;
+
+	unsigned int _lineNumber;
+};
+
+#endif // SBMRM_IO_TEXT_TOKENIZER_H__
+
@@ -0,0 +1,80 @@
+#ifndef SBMRM_LOSS_ALIGNED_ALLOCATOR_H__
+#define SBMRM_LOSS_ALIGNED_ALLOCATOR_H__
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+/**
+ * An allocator for std::vector that aligns the memory to Alignment bytes,
+ * such that vector instructions can use aligned loads.
+ */
+template <typename T, std::size_t Alignment = 64>
+class AlignedAllocator {
+
+public:
+
+	typedef T              value_type;
+	typedef T*             pointer;
+	typedef const T*       const_pointer;
+	typedef T&             reference;
+	typedef const T&       const_reference;
+	typedef std::size_t    size_type;
+	typedef std::ptrdiff_t difference_type;
+
+	template <typename U>
+	struct rebind {
+
+		typedef AlignedAllocator<U, Alignment> other;
+	};
+
+	AlignedAllocator() {}
+
+	template <typename U>
+	AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+	pointer address(reference x) const { return &x; }
+
+	const_pointer address(const_reference x) const { return &x; }
+
+	pointer allocate(size_type n, const void* = 0) {
+
+		if (n == 0)
+			return 0;
+
+		void* p;
+		if (posix_memalign(&p, Alignment, n*sizeof(T)) != 0)
+			throw std::bad_alloc();
+
+		return static_cast<pointer>(p);
+	}
+
+	void deallocate(pointer p, size_type) {
+
+		std::free(p);
+	}
+
+	size_type max_size() const {
+
+		return static_cast<size_type>(-1)/sizeof(T);
+	}
+
+	void construct(pointer p, const T& value) {
+
+		new (static_cast<void*>(p)) T(value);
+	}
+
+	void destroy(pointer p) {
+
+		p->~T();
+	}
+};
+
+template <typename T, typename U, std::size_t Alignment>
+bool operator==(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&) { return true; }
+
+template <typename T, typename U, std::size_t Alignment>
+bool operator!=(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&) { return false; }
+
+#endif // SBMRM_LOSS_ALIGNED_ALLOCATOR_H__
+
@@ -0,0 +1,532 @@
+#include <util/Logger.h>
+#include "FeatureKernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SBMRM_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+logger::LogChannel featurekernelslog("featurekernelslog", "[FeatureKernels] ");
+
+namespace {
+
+/*
+  Scalar fallback
+*/
+
+void
+coefficientsScalar(
+		const double* features,
+		unsigned int  numRows,
+		unsigned int  numCols,
+		unsigned int  stride,
+		const double* w,
+		double*       f) {
+
+	for (unsigned int i = 0; i < numRows; i++) {
+
+		const double* row = features + static_cast<size_t>(i)*stride;
+
+		double sum = 0;
+		for (unsigned int j = 0; j < numCols; j++)
+			sum += w[j]*row[j];
+
+		f[i] = sum;
+	}
+}
+
+void
+accumulateScalar(
+		const double*       features,
+		unsigned int        numCols,
+		unsigned int        stride,
+		const unsigned int* rows,
+		const double*       weights,
+		unsigned int        numRows,
+		double*             e) {
+
+	for (unsigned int k = 0; k < numRows; k++) {
+
+		const double* row = features + static_cast<size_t>(rows[k])*stride;
+
+		for (unsigned int j = 0; j < numCols; j++)
+			e[j] += weights[k]*row[j];
+	}
+}
+
+#ifdef SBMRM_X86_KERNELS
+
+/*
+  AVX2
+
+  Four rows are processed at once, such that each chunk of w (or e) is loaded
+  only once for all of them. The accumulation works on a list of rows, such
+  that rows with a weight of 0 never have to be visited.
+*/
+
+__attribute__((target("avx2,fma")))
+void
+coefficientsAvx2(
+		const double* features,
+		unsigned int  numRows,
+		unsigned int  numCols,
+		unsigned int  stride,
+		const double* w,
+		double*       f) {
+
+	unsigned int numChunks = numCols/4*4;
+	unsigned int i = 0;
+
+	for (; i + 4 <= numRows; i += 4) {
+
+		const double* r0 = features + static_cast<size_t>(i)*stride;
+		const double* r1 = r0 + stride;
+		const double* r2 = r1 + stride;
+		const double* r3 = r2 + stride;
+
+		__m256d s0 = _mm256_setzero_pd();
+		__m256d s1 = _mm256_setzero_pd();
+		__m256d s2 = _mm256_setzero_pd();
+		__m256d s3 = _mm256_setzero_pd();
+
+		for (unsigned int j = 0; j < numChunks; j += 4) {
+
+			__m256d x = _mm256_loadu_pd(w + j);
+
+			s0 = _mm256_fmadd_pd(_mm256_load_pd(r0 + j), x, s0);
+			s1 = _mm256_fmadd_pd(_mm256_load_pd(r1 + j), x, s1);
+			s2 = _mm256_fmadd_pd(_mm256_load_pd(r2 + j), x, s2);
+			s3 = _mm256_fmadd_pd(_mm256_load_pd(r3 + j), x, s3);
+		}
+
+		// [s0,s1,s2,s3] horizontally summed into one register
+		__m256d t0  = _mm256_hadd_pd(s0, s1);
+		__m256d t1  = _mm256_hadd_pd(s2, s3);
+		__m256d sum = _mm256_add_pd(
+				_mm256_permute2f128_pd(t0, t1, 0x20),
+				_mm256_permute2f128_pd(t0, t1, 0x31));
+
+		_mm256_storeu_pd(f + i, sum);
+
+		for (unsigned int j = numChunks; j < numCols; j++) {
+
+			f[i    ] += r0[j]*w[j];
+			f[i + 1] += r1[j]*w[j];
+			f[i + 2] += r2[j]*w[j];
+			f[i + 3] += r3[j]*w[j];
+		}
+	}
+
+	for (; i < numRows; i++) {
+
+		const double* row = features + static_cast<size_t>(i)*stride;
+
+		__m256d s = _mm256_setzero_pd();
+		for (unsigned int j = 0; j < numChunks; j += 4)
+			s = _mm256_fmadd_pd(_mm256_load_pd(row + j), _mm256_loadu_pd(w + j), s);
+
+		double parts[4];
+		_mm256_storeu_pd(parts, s);
+
+		f[i] = parts[0] + parts[1] + parts[2] + parts[3];
+		for (unsigned int j = numChunks; j < numCols; j++)
+			f[i] += row[j]*w[j];
+	}
+}
+
+__attribute__((target("avx2,fma")))
+void
+accumulateAvx2(
+		const double*       features,
+		unsigned int        numCols,
+		unsigned int        stride,
+		const unsigned int* rows,
+		const double*       weights,
+		unsigned int        numRows,
+		double*             e) {
+
+	unsigned int numChunks = numCols/4*4;
+
+	for (unsigned int k = 0; k < numRows; k += 4) {
+
+		// pad a partial batch with the first row and a weight of 0
+		const double* r[4];
+		double        y[4];
+
+		for (unsigned int l = 0; l < 4; l++) {
+
+			r[l] = features + static_cast<size_t>(rows[k + l < numRows ? k + l : k])*stride;
+			y[l] = (k + l < numRows ? weights[k + l] : 0);
+		}
+
+		__m256d y0 = _mm256_set1_pd(y[0]);
+		__m256d y1 = _mm256_set1_pd(y[1]);
+		__m256d y2 = _mm256_set1_pd(y[2]);
+		__m256d y3 = _mm256_set1_pd(y[3]);
+
+		for (unsigned int j = 0; j < numChunks; j += 4) {
+
+			__m256d acc = _mm256_loadu_pd(e + j);
+
+			acc = _mm256_fmadd_pd(_mm256_load_pd(r[0] + j), y0, acc);
+			acc = _mm256_fmadd_pd(_mm256_load_pd(r[1] + j), y1, acc);
+			acc = _mm256_fmadd_pd(_mm256_load_pd(r[2] + j), y2, acc);
+			acc = _mm256_fmadd_pd(_mm256_load_pd(r[3] + j), y3, acc);
+
+			_mm256_storeu_pd(e + j, acc);
+		}
+
+		for (unsigned int j = numChunks; j < numCols; j++)
+			e[j] += y[0]*r[0][j] + y[1]*r[1][j] + y[2]*r[2][j] + y[3]*r[3][j];
+	}
+}
+
+/*
+  AVX-512
+
+  Like AVX2, but with twice the width. The last partial chunk of each row is
+  handled with masked loads and stores.
+*/
+
+__attribute__((target("avx512f")))
+void
+coefficientsAvx512(
+		const double* features,
+		unsigned int  numRows,
+		unsigned int  numCols,
+		unsigned int  stride,
+		const double* w,
+		double*       f) {
+
+	unsigned int numChunks = numCols/8*8;
+	__mmask8     tailMask  = static_cast<__mmask8>((1u << (numCols - numChunks)) - 1);
+	unsigned int i = 0;
+
+	for (; i + 4 <= numRows; i += 4) {
+
+		const double* r0 = features + static_cast<size_t>(i)*stride;
+		const double* r1 = r0 + stride;
+		const double* r2 = r1 + stride;
+		const double* r3 = r2 + stride;
+
+		__m512d s0 = _mm512_setzero_pd();
+		__m512d s1 = _mm512_setzero_pd();
+		__m512d s2 = _mm512_setzero_pd();
+		__m512d s3 = _mm512_setzero_pd();
+
+		for (unsigned int j = 0; j < numChunks; j += 8) {
+
+			__m512d x = _mm512_loadu_pd(w + j);
+
+			s0 = _mm512_fmadd_pd(_mm512_load_pd(r0 + j), x, s0);
+			s1 = _mm512_fmadd_pd(_mm512_load_pd(r1 + j), x, s1);
+			s2 = _mm512_fmadd_pd(_mm512_load_pd(r2 + j), x, s2);
+			s3 = _mm512_fmadd_pd(_mm512_load_pd(r3 + j), x, s3);
+		}
+
+		if (tailMask) {
+
+			__m512d x = _mm512_maskz_loadu_pd(tailMask, w + numChunks);
+
+			s0 = _mm512_fmadd_pd(_mm512_maskz_load_pd(tailMask, r0 + numChunks), x, s0);
+			s1 = _mm512_fmadd_pd(_mm512_maskz_load_pd(tailMask, r1 + numChunks), x, s1);
+			s2 = _mm512_fmadd_pd(_mm512_maskz_load_pd(tailMask, r2 + numChunks), x, s2);
+			s3 = _mm512_fmadd_pd(_mm512_maskz_load_pd(tailMask, r3 + numChunks), x, s3);
+		}
+
+		f[i    ] = _mm512_reduce_add_pd(s0);
+		f[i + 1] = _mm512_reduce_add_pd(s1);
+		f[i + 2] = _mm512_reduce_add_pd(s2);
+		f[i + 3] = _mm512_reduce_add_pd(s3);
+	}
+
+	for (; i < numRows; i++) {
+
+		const double* row = features + static_cast<size_t>(i)*stride;
+
+		__m512d s = _mm512_setzero_pd();
+		for (unsigned int j = 0; j < numChunks; j += 8)
+			s = _mm512_fmadd_pd(_mm512_load_pd(row + j), _mm512_loadu_pd(w + j), s);
+
+		if (tailMask)
+			s = _mm512_fmadd_pd(
+					_mm512_maskz_load_pd(tailMask, row + numChunks),
+					_mm512_maskz_loadu_pd(tailMask, w + numChunks),
+					s);
+
+		f[i] = _mm512_reduce_add_pd(s);
+	}
+}
+
+__attribute__((target("avx512f")))
+void
+accumulateAvx512(
+		const double*       features,
+		unsigned int        numCols,
+		unsigned int        stride,
+		const unsigned int* rows,
+		const double*       weights,
+		unsigned int        numRows,
+		double*             e) {
+
+	unsigned int numChunks = numCols/8*8;
+	__mmask8     tailMask  = static_cast<__mmask8>((1u << (numCols - numChunks)) - 1);
+
+	for (unsigned int k = 0; k < numRows; k += 4) {
+
+		// pad a partial batch with the first row and a weight of 0
+		const double* r[4];
+		double        y[4];
+
+		for (unsigned int l = 0; l < 4; l++) {
+
+			r[l] = features + static_cast<size_t>(rows[k + l < numRows ? k + l : k])*stride;
+			y[l] = (k + l < numRows ? weights[k + l] : 0);
+		}
+
+		__m512d y0 = _mm512_set1_pd(y[0]);
+		__m512d y1 = _mm512_set1_pd(y[1]);
+		__m512d y2 = _mm512_set1_pd(y[2]);
+		__m512d y3 = _mm512_set1_pd(y[3]);
+
+		for (unsigned int j = 0; j < numChunks; j += 8) {
+
+			__m512d acc = _mm512_loadu_pd(e + j);
+
+			acc = _mm512_fmadd_pd(_mm512_load_pd(r[0] + j), y0, acc);
+			acc = _mm512_fmadd_pd(_mm512_load_pd(r[1] + j), y1, acc);
+			acc = _mm512_fmadd_pd(_mm512_load_pd(r[2] + j), y2, acc);
+			acc = _mm512_fmadd_pd(_mm512_load_pd(r[3] + j), y3, acc);
+
+			_mm512_storeu_pd(e + j, acc);
+		}
+
+		if (tailMask) {
+
+			__m512d acc = _mm512_maskz_loadu_pd(tailMask, e + numChunks);
+
+			acc = _mm512_fmadd_pd(_mm512_maskz_load_pd(tailMask, r[0] + numChunks), y0, acc);
+			acc = _mm512_fmadd_pd(_mm512_maskz_load_pd(tailMask, r[1] + numChunks), y1, acc);
+			acc = _mm512_fmadd_pd(_mm512_maskz_load_pd(tailMask, r[2] + numChunks), y2, acc);
+			acc = _mm512_fmadd_pd(_mm512_maskz_load_pd(tailMask, r[3] + numChunks), y3, acc);
+
+			_mm512_mask_storeu_pd(e + numChunks, tailMask, acc);
+		}
+	}
+}
+
+#endif // SBMRM_X86_KERNELS
+
+FeatureKernels::InstructionSet
+detectInstructionSet() {
+
+	FeatureKernels::InstructionSet instructionSet = FeatureKernels::Scalar;
+
+	if (FeatureKernels::supported(FeatureKernels::Avx512))
+		instructionSet = FeatureKernels::Avx512;
+	else if (FeatureKernels::supported(FeatureKernels::Avx2))
+		instructionSet = FeatureKernels::Avx2;
+
+	LOG_DEBUG(featurekernelslog)
+			<< "using " << FeatureKernels::name(instructionSet)
+			<< " kernels for feature products" << std::endl;
+
+	return instructionSet;
+}
+
+} // anonymous namespace
+
+FeatureKernels::InstructionSet
+FeatureKernels::best() {
+
+	static InstructionSet instructionSet = detectInstructionSet();
+
+	return instructionSet;
+}
+
+bool
+FeatureKernels::supported(InstructionSet instructionSet) {
+
+	switch (instructionSet) {
+
+		case Scalar:
+			return true;
+
+#ifdef SBMRM_X86_KERNELS
+		case Avx2:
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+
+		case Avx512:
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx512f");
+#endif
+
+		default:
+			return false;
+	}
+}
+
+const char*
+FeatureKernels::name(InstructionSet instructionSet) {
+
+	switch (instructionSet) {
+
+		case Avx2:
+			return "AVX2";
+
+		case Avx512:
+			return "AVX-512";
+
+		default:
+			return "scalar";
+	}
+}
+
+void
+FeatureKernels::coefficients(
+		const double*  features,
+		unsigned int   numRows,
+		unsigned int   numCols,
+		unsigned int   stride,
+		const double*  w,
+		double*        f,
+		InstructionSet instructionSet) {
+
+	switch (instructionSet) {
+
+#ifdef SBMRM_X86_KERNELS
+		case Avx2:
+			coefficientsAvx2(features, numRows, numCols, stride, w, f);
+			break;
+
+		case Avx512:
+			coefficientsAvx512(features, numRows, numCols, stride, w, f);
+			break;
+#endif
+
+		default:
+			coefficientsScalar(features, numRows, numCols, stride, w, f);
+	}
+}
+
+void
+FeatureKernels::accumulate(
+		const double*  features,
+		unsigned int   numRows,
+		unsigned int   numCols,
+		unsigned int   stride,
+		const double*  y,
+		double*        e,
+		InstructionSet instructionSet) {
+
+	// collect the rows with y_i != 0 in batches
+	const unsigned int BatchSize = 256;
+
+	unsigned int rows[BatchSize];
+	double       weights[BatchSize];
+	unsigned int numPending = 0;
+
+	for (unsigned int i = 0; i < numRows; i++) {
+
+		if (y[i] == 0)
+			continue;
+
+		rows[numPending]    = i;
+		weights[numPending] = y[i];
+		numPending++;
+
+		if (numPending == BatchSize) {
+
+			accumulateRows(features, numCols, stride, rows, weights, numPending, e, instructionSet);
+			numPending = 0;
+		}
+	}
+
+	accumulateRows(features, numCols, stride, rows, weights, numPending, e, instructionSet);
+}
+
+void
+FeatureKernels::accumulateRows(
+		const double*       features,
+		unsigned int        numCols,
+		unsigned int        stride,
+		const unsigned int* rows,
+		const double*       weights,
+		unsigned int        numRows,
+		double*             e,
+		InstructionSet      instructionSet) {
+
+	switch (instructionSet) {
+
+#ifdef SBMRM_X86_KERNELS
+		case Avx2:
+			accumulateAvx2(features, numCols, stride, rows, weights, numRows, e);
+			break;
+
+		case Avx512:
+			accumulateAvx512(features, numCols, stride, rows, weights, numRows, e);
+			break;
+#endif
+
+		default:
+			accumulateScalar(features, numCols, stride, rows, weights, numRows, e);
+	}
+}
+
+void
+FeatureKernels::sparseCoefficients(
+		const size_t*       rowStarts,
+		const unsigned int* indices,
+		const double*       values,
+		unsigned int        numRows,
+		const double*       w,
+		double*             f) {
+
+	for (unsigned int i = 0; i < numRows; i++) {
+
+		double sum = 0;
+		for (size_t k = rowStarts[i]; k < rowStarts[i+1]; k++)
+			sum += values[k]*w[indices[k]];
+
+		f[i] = sum;
+	}
+}
+
+void
+FeatureKernels::sparseAccumulate(
+		const size_t*       rowStarts,
+		const unsigned int* indices,
+		const double*       values,
+		unsigned int        numRows,
+		const double*       y,
+		double*             e) {
+
+	for (unsigned int i = 0; i < numRows; i++) {
+
+		if (y[i] == 0)
+			continue;
+
+		for (size_t k = rowStarts[i]; k < rowStarts[i+1]; k++)
+			e[indices[k]] += y[i]*values[k];
+	}
+}
+
+void
+FeatureKernels::sparseAccumulateRows(
+		const size_t*       rowStarts,
+		const unsigned int* indices,
+		const double*       values,
+		const unsigned int* rows,
+		const double*       weights,
+		unsigned int        numRows,
+		double*             e) {
+
+	for (unsigned int l = 0; l < numRows; l++) {
+
+		unsigned int i = rows[l];
+
+		for (size_t k = rowStarts[i]; k < rowStarts[i+1]; k++)
+			e[indices[k]] += weights[l]*values[k];
+	}
+}
@@ -0,0 +1,130 @@
+#ifndef SBMRM_LOSS_FEATURE_KERNELS_H__
+#define SBMRM_LOSS_FEATURE_KERNELS_H__
+
+#include <cstddef>
+
+/**
+ * Matrix-vector products with a dense, row-major feature matrix φ(x'), which
+ * are needed in every evaluation of the loss. Vectorized implementations for
+ * AVX2 and AVX-512 are compiled in on x86 and selected at runtime, depending
+ * on what the CPU supports.
+ *
+ * The rows of the matrix have to start at 64 byte boundaries, i.e., the
+ * matrix has to be 64 byte aligned and the stride between rows has to be a
+ * multiple of RowAlignment. The padding has to be zero.
+ *
+ * For sparse matrices in compressed sparse row format, only scalar kernels
+ * are provided: they are bound by the irregular accesses to w and e, which
+ * vector gathers and scatters do not speed up.
+ */
+class FeatureKernels {
+
+public:
+
+	enum InstructionSet {
+
+		Scalar,
+		Avx2,
+		Avx512
+	};
+
+	/**
+	 * The number of doubles the stride between rows has to be a multiple of.
+	 */
+	static const unsigned int RowAlignment = 8;
+
+	/**
+	 * The fastest instruction set supported by this machine.
+	 */
+	static InstructionSet best();
+
+	/**
+	 * Check whether this machine supports the given instruction set.
+	 */
+	static bool supported(InstructionSet instructionSet);
+
+	/**
+	 * A human readable name of the given instruction set.
+	 */
+	static const char* name(InstructionSet instructionSet);
+
+	/**
+	 * Compute f_i = <φ_i,w> for all rows φ_i of the feature matrix.
+	 */
+	static void coefficients(
+			const double*  features,
+			unsigned int   numRows,
+			unsigned int   numCols,
+			unsigned int   stride,
+			const double*  w,
+			double*        f,
+			InstructionSet instructionSet = best());
+
+	/**
+	 * Compute e += Σ_i y_i φ_i over all rows φ_i of the feature matrix. Rows
+	 * with y_i = 0 are skipped.
+	 */
+	static void accumulate(
+			const double*  features,
+			unsigned int   numRows,
+			unsigned int   numCols,
+			unsigned int   stride,
+			const double*  y,
+			double*        e,
+			InstructionSet instructionSet = best());
+
+	/**
+	 * Compute e += Σ_k weights[k] φ_rows[k] for the given rows of the feature
+	 * matrix.
+	 */
+	static void accumulateRows(
+			const double*       features,
+			unsigned int        numCols,
+			unsigned int        stride,
+			const unsigned int* rows,
+			const double*       weights,
+			unsigned int        numRows,
+			double*             e,
+			InstructionSet      instructionSet = best());
+
+	/**
+	 * Compute f_i = <φ_i,w> for all rows φ_i of a sparse feature matrix, where
+	 * row i consists of the values[k] at indices[k] for rowStarts[i] <= k <
+	 * rowStarts[i+1].
+	 */
+	static void sparseCoefficients(
+			const size_t*       rowStarts,
+			const unsigned int* indices,
+			const double*       values,
+			unsigned int        numRows,
+			const double*       w,
+			double*             f);
+
+	/**
+	 * Compute e += Σ_i y_i φ_i over all rows φ_i of a sparse feature matrix.
+	 * Rows with y_i = 0 are skipped.
+	 */
+	static void sparseAccumulate(
+			const size_t*       rowStarts,
+			const unsigned int* indices,
+			const double*       values,
+			unsigned int        numRows,
+			const double*       y,
+			double*             e);
+
+	/**
+	 * Compute e += Σ_k weights[k] φ_rows[k] for the given rows of a sparse
+	 * feature matrix.
+	 */
+	static void sparseAccumulateRows(
+			const size_t*       rowStarts,
+			const unsigned int* indices,
+			const double*       values,
+			const unsigned int* rows,
+			const double*       weights,
+			unsigned int        numRows,
+			double*             e);
+};
+
+#endif // SBMRM_LOSS_FEATURE_KERNELS_H__
+
@@ -0,0 +1,377 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <boost/lexical_cast.hpp>
+#include <io/BinaryDataset.h>
+#include "FeatureKernels.h"
+#include "Features.h"
+
+Features::Features() :
+	_numFeatures(0),
+	_numFeatureVectors(0),
+	_sparse(false),
+	_stride(0) {
+
+	_rowStarts.push_back(0);
+}
+
+void
+Features::addFeatureVector(const std::vector<double>& f) {
+
+	if (_numFeatureVectors == 0) {
+
+		_sparse      = false;
+		_numFeatures = f.size();
+		_stride      = (_numFeatures + FeatureKernels::RowAlignment - 1)/FeatureKernels::RowAlignment*FeatureKernels::RowAlignment;
+
+	} else {
+
+		if (_sparse)
+			BOOST_THROW_EXCEPTION(FeaturesError() << error_message("can not add a dense feature vector to sparse features"));
+
+		if (f.size() != _numFeatures)
+			BOOST_THROW_EXCEPTION(
+					SizeMismatchError() <<
+							error_message(std::string("number of features added (") +
+							boost::lexical_cast<std::string>(f.size()) +
+							") does not match expected number (" +
+							boost::lexical_cast<std::string>(_numFeatures) + ")"));
+	}
+
+	_features.resize(_features.size() + _stride, 0.0);
+	std::copy(f.begin(), f.end(), _features.end() - _stride);
+	_numFeatureVectors++;
+}
+
+void
+Features::addSparseFeatureVector(const std::vector<unsigned int>& indices, const std::vector<double>& values) {
+
+	if (_numFeatureVectors == 0) {
+
+		_sparse      = true;
+		_numFeatures = 0;
+
+	} else if (!_sparse) {
+
+		BOOST_THROW_EXCEPTION(FeaturesError() << error_message("can not add a sparse feature vector to dense features"));
+	}
+
+	if (indices.size() != values.size())
+		BOOST_THROW_EXCEPTION(
+				SizeMismatchError() <<
+						error_message(std::string("number of indices (") +
+						boost::lexical_cast<std::string>(indices.size()) +
+						") does not match number of values (" +
+						boost::lexical_cast<std::string>(values.size()) + ")"));
+
+	for (unsigned int k = 1; k < indices.size(); k++)
+		if (indices[k] <= indices[k-1])
+			BOOST_THROW_EXCEPTION(
+					FeaturesError() <<
+							error_message(std::string("indices of sparse feature vector are not strictly increasing at index ") +
+							boost::lexical_cast<std::string>(indices[k])));
+
+	if (!indices.empty())
+		_numFeatures = std::max(_numFeatures, indices.back() + 1);
+
+	_indices.insert(_indices.end(), indices.begin(), indices.end());
+	_values.insert(_values.end(), values.begin(), values.end());
+	_rowStarts.push_back(_values.size());
+	_numFeatureVectors++;
+}
+
+void
+Features::append(const Features& features) {
+
+	if (features._numFeatureVectors == 0)
+		return;
+
+	if (_numFeatureVectors == 0) {
+
+		_sparse      = features._sparse;
+		_numFeatures = features._numFeatures;
+		_stride      = features._stride;
+
+	} else if (features._sparse != _sparse) {
+
+		BOOST_THROW_EXCEPTION(FeaturesError() << error_message("can not append sparse and dense features"));
+
+	} else if (!_sparse && features._numFeatures != _numFeatures) {
+
+		BOOST_THROW_EXCEPTION(
+				SizeMismatchError() <<
+						error_message(std::string("number of features appended (") +
+						boost::lexical_cast<std::string>(features._numFeatures) +
+						") does not match expected number (" +
+						boost::lexical_cast<std::string>(_numFeatures) + ")"));
+	}
+
+	if (_sparse) {
+
+		size_t offset = _values.size();
+
+		_indices.insert(_indices.end(), features._indices.begin(), features._indices.end());
+		_values.insert(_values.end(), features._values.begin(), features._values.end());
+		for (unsigned int i = 1; i <= features._numFeatureVectors; i++)
+			_rowStarts.push_back(offset + features._rowStarts[i]);
+
+		_numFeatures = std::max(_numFeatures, features._numFeatures);
+
+	} else {
+
+		_features.insert(_features.end(), features._features.begin(), features._features.end());
+	}
+
+	_numFeatureVectors += features._numFeatureVectors;
+}
+
+void
+Features::map(const BinaryDataset& dataset) {
+
+	size_t numInfo;
+	const boost::uint64_t* info = dataset.get<boost::uint64_t>(BinaryDataset::FeaturesInfo, numInfo);
+
+	if (numInfo != 4)
+		BOOST_THROW_EXCEPTION(BinaryDatasetError() << error_message(dataset.getFilename() + ": invalid features info"));
+
+	bool         sparse            = (info[0] != 0);
+	unsigned int numFeatureVectors = info[1];
+	unsigned int numFeatures       = info[2];
+	unsigned int stride            = info[3];
+
+	clear();
+
+	if (sparse) {
+
+		size_t numRowStarts, numIndices, numValues;
+		size_t*       rowStarts = dataset.get<size_t>(BinaryDataset::SparseRowStarts, numRowStarts);
+		unsigned int* indices   = dataset.get<unsigned int>(BinaryDataset::SparseIndices, numIndices);
+		double*       values    = dataset.get<double>(BinaryDataset::SparseValues, numValues);
+
+		if (numRowStarts != static_cast<size_t>(numFeatureVectors) + 1 ||
+		    numIndices != numValues ||
+		    rowStarts[0] != 0 ||
+		    rowStarts[numFeatureVectors] != numValues)
+			BOOST_THROW_EXCEPTION(BinaryDatasetError() << error_message(dataset.getFilename() + ": sparse features are corrupted"));
+
+		// the products with the features do not check their rows and indices
+		for (unsigned int i = 0; i < numFeatureVectors; i++)
+			if (rowStarts[i] > rowStarts[i + 1])
+				BOOST_THROW_EXCEPTION(BinaryDatasetError() << error_message(dataset.getFilename() + ": sparse features are corrupted"));
+
+		for (size_t k = 0; k < numIndices; k++)
+			if (indices[k] >= numFeatures)
+				BOOST_THROW_EXCEPTION(BinaryDatasetError() << error_message(dataset.getFilename() + ": sparse features are corrupted"));
+
+		_rowStarts.map(rowStarts, numRowStarts, dataset.getOwner());
+		_indices.map(indices, numIndices, dataset.getOwner());
+		_values.map(values, numValues, dataset.getOwner());
+
+	} else {
+
+		size_t  numEntries;
+		double* features = dataset.get<double>(BinaryDataset::DenseFeatures, numEntries);
+
+		if (stride%FeatureKernels::RowAlignment != 0 ||
+		    stride < numFeatures ||
+		    numEntries != static_cast<size_t>(numFeatureVectors)*stride)
+			BOOST_THROW_EXCEPTION(BinaryDatasetError() << error_message(dataset.getFilename() + ": dense features are corrupted"));
+
+		_features.map(features, numEntries, dataset.getOwner());
+	}
+
+	_sparse            = sparse;
+	_numFeatureVectors = numFeatureVectors;
+	_numFeatures       = numFeatures;
+	_stride            = stride;
+}
+
+void
+Features::write(BinaryDatasetWriter& writer) const {
+
+	boost::uint64_t info[4] = { _sparse, _numFeatureVectors, _numFeatures, _stride };
+
+	writer.add(BinaryDataset::FeaturesInfo, info, 4);
+
+	if (_sparse) {
+
+		writer.add(BinaryDataset::SparseRowStarts, _rowStarts.data(), _rowStarts.size());
+		writer.add(BinaryDataset::SparseIndices, _indices.data(), _indices.size());
+		writer.add(BinaryDataset::SparseValues, _values.data(), _values.size());
+
+	} else {
+
+		writer.add(BinaryDataset::DenseFeatures, _features.data(), _features.size());
+	}
+}
+
+void
+Features::setNumFeatures(unsigned int numFeatures) {
+
+	if (numFeatures == _numFeatures)
+		return;
+
+	if (!_sparse || numFeatures < _numFeatures)
+		BOOST_THROW_EXCEPTION(
+				SizeMismatchError() <<
+						error_message(std::string("can not change the number of features from ") +
+						boost::lexical_cast<std::string>(_numFeatures) + " to " +
+						boost::lexical_cast<std::string>(numFeatures)));
+
+	_numFeatures = numFeatures;
+}
+
+void
+Features::getCoefficients(const std::vector<double>& w, std::vector<double>& f) const {
+
+	if (_numFeatureVectors == 0 || (_sparse && _values.empty())) {
+
+		std::fill(f.begin(), f.end(), 0.0);
+		return;
+	}
+
+	if (_sparse)
+		FeatureKernels::sparseCoefficients(&_rowStarts[0], &_indices[0], &_values[0], _numFeatureVectors, &w[0], &f[0]);
+	else
+		FeatureKernels::coefficients(&_features[0], _numFeatureVectors, _numFeatures, _stride, &w[0], &f[0]);
+}
+
+void
+Features::combineFeatures(const std::vector<double>& y, std::vector<double>& e) const {
+
+	std::fill(e.begin(), e.end(), 0.0);
+
+	if (_numFeatureVectors == 0 || (_sparse && _values.empty()))
+		return;
+
+	if (_sparse)
+		FeatureKernels::sparseAccumulate(&_rowStarts[0], &_indices[0], &_values[0], _numFeatureVectors, &y[0], &e[0]);
+	else
+		FeatureKernels::accumulate(&_features[0], _numFeatureVectors, _numFeatures, _stride, &y[0], &e[0]);
+}
+
+void
+Features::combineFeatures(const Labeling& y, std::vector<double>& e) const {
+
+	std::vector<unsigned int> ones;
+	y.getOnes(ones);
+
+	std::fill(e.begin(), e.end(), 0.0);
+	accumulateFeatures(ones, std::vector<double>(ones.size(), 1.0), e);
+}
+
+void
+Features::accumulateFeatures(
+		const std::vector<unsigned int>& components,
+		const std::vector<double>&       weights,
+		std::vector<double>&             e) const {
+
+	if (components.empty() || (_sparse && _values.empty()))
+		return;
+
+	if (_sparse)
+		FeatureKernels::sparseAccumulateRows(&_rowStarts[0], &_indices[0], &_values[0], &components[0], &weights[0], components.size(), &e[0]);
+	else
+		FeatureKernels::accumulateRows(&_features[0], _numFeatures, _stride, &components[0], &weights[0], components.size(), &e[0]);
+}
+
+void
+Features::clear() {
+
+	_features.clear();
+	_rowStarts.assign(1, 0);
+	_indices.clear();
+	_values.clear();
+	_numFeatureVectors = 0;
+}
+
+void
+Features::normalize() {
+
+	std::vector<double> min(_numFeatures, std::numeric_limits<double>::max());
+	std::vector<double> max(_numFeatures, std::numeric_limits<double>::min());
+
+	updateRange(min, max);
+	normalize(min, max);
+}
+
+void
+Features::updateRange(std::vector<double>& min, std::vector<double>& max) const {
+
+	if (!_sparse) {
+
+		for (unsigned int k = 0; k < _numFeatureVectors; k++) {
+
+			const double* f = getFeatureVector(k);
+
+			for (unsigned int i = 0; i < _numFeatures; i++) {
+
+				min[i] = std::min(min[i], f[i]);
+				max[i] = std::max(max[i], f[i]);
+			}
+		}
+
+		return;
+	}
+
+	// features that are not set in every feature vector are 0 somewhere
+	std::vector<unsigned int> numNonZeros(_numFeatures, 0);
+
+	for (size_t k = 0; k < _values.size(); k++) {
+
+		unsigned int i = _indices[k];
+
+		min[i] = std::min(min[i], _values[k]);
+		max[i] = std::max(max[i], _values[k]);
+		numNonZeros[i]++;
+	}
+
+	for (unsigned int i = 0; i < _numFeatures; i++) {
+
+		if (numNonZeros[i] < _numFeatureVectors) {
+
+			min[i] = std::min(min[i], 0.0);
+			max[i] = std::max(max[i], 0.0);
+		}
+	}
+}
+
+void
+Features::normalize(const std::vector<double>& min, const std::vector<double>& max) {
+
+	_min = min;
+	_max = max;
+
+	// scale features
+	if (_sparse) {
+
+		for (size_t k = 0; k < _values.size(); k++)
+			_values[k] /= maxAbs(_indices[k]);
+
+	} else {
+
+		for (unsigned int k = 0; k < _numFeatureVectors; k++) {
+
+			double* f = &_features[static_cast<size_t>(k)*_stride];
+
+			for (unsigned int i = 0; i < _numFeatures; i++)
+				f[i] /= maxAbs(i);
+		}
+	}
+}
+
+void
+Features::normalize(std::vector<double>& f) {
+
+	for (unsigned int i = 0; i < _numFeatures; i++)
+		f[i] /= maxAbs(i);
+}
+
+double
+Features::maxAbs(unsigned int i) const {
+
+	double maxAbs = std::max(std::abs(_min[i]), std::abs(_max[i]));
+
+	return (maxAbs > 0 ? maxAbs : 1.0);
+}
@@ -1,68 +1,125 @@
 #ifndef SBMRM_LOSS_FEATURES_H__
 #define SBMRM_LOSS_FEATURES_H__
 
+#include <vector>
+
 #include <util/exceptions.h>
+#include <io/MappableVector.h>
+#include "AlignedAllocator.h"
+#include "Labeling.h"
+
+class BinaryDataset;
+class BinaryDatasetWriter;
+
+struct FeaturesError : virtual Exception {};
 
 /**
- * The feature matrix φ(x'). Each column is a feature vector for one component 
+ * The feature matrix φ(x'). Each column is a feature vector for one component
  * of y, such that the energy for each y is: E(y) = <w,φ(x')y>.
+ *
+ * Features are either dense or sparse, depending on how the first feature
+ * vector is added. Dense feature vectors are stored in one contiguous,
+ * aligned buffer, each of them padded to a multiple of 64 bytes, such that
+ * the products with φ(x') can be computed with vector instructions (see
+ * FeatureKernels). Sparse feature vectors are stored in compressed sparse
+ * row format (one row per component of y), such that memory and the time
+ * for the products scale with the number of non-zeros.
+ *
+ * Features read from a BinaryDataset are views on the mapped file, they are
+ * copied only when feature vectors are added.
  */
 class Features {
 
 public:
 
+	Features();
+
 	/**
-	 * Add a new feature vector.
+	 * Add a new dense feature vector.
 	 */
-	void addFeatureVector(std::vector<double>& f) {
+	void addFeatureVector(const std::vector<double>& f);
 
-		if (_features.size() == 0)
-			_numFeatures = f.size();
-		else
-			if (f.size() != _numFeatures)
-				BOOST_THROW_EXCEPTION(
-						SizeMismatchError() <<
-								error_message(std::string("number of features added (") +
-								boost::lexical_cast<std::string>(f.size()) +
-								") does not match expected number (" +
-								boost::lexical_cast<std::string>(_numFeatures) + ")"));
+	/**
+	 * Add a new sparse feature vector, given by the strictly increasing
+	 * indices of its non-zero features and their values. The number of
+	 * features grows with the largest index seen.
+	 */
+	void addSparseFeatureVector(const std::vector<unsigned int>& indices, const std::vector<double>& values);
 
-		_features.push_back(f);
-	}
+	/**
+	 * Add all feature vectors of another set, which has to have the same
+	 * format (and the same number of features, if dense).
+	 */
+	void append(const Features& features);
+
+	/**
+	 * Replace these features with a view on the features of a binary
+	 * dataset.
+	 */
+	void map(const BinaryDataset& dataset);
+
+	/**
+	 * Write these features to a binary dataset.
+	 */
+	void write(BinaryDatasetWriter& writer) const;
 
 	/**
-	 * Get the feature vector for the ith component of y.
+	 * True, if the features are stored in sparse format.
 	 */
-	const std::vector<double>& getFeatureVector(unsigned int i) const {
+	bool isSparse() const {
 
-		return _features[i];
+		return _sparse;
 	}
 
 	/**
-	 * For a given set of feature weights w, get the coefficients f := wφ(x'), 
-	 * such that E(y) = <f,y>.
+	 * Set the number of features of sparse features, e.g., to match the
+	 * features of other samples. Can only increase the number of features.
 	 */
-	void getCoefficients(const std::vector<double>& w, std::vector<double>& f) const {
+	void setNumFeatures(unsigned int numFeatures);
 
-		std::fill(f.begin(), f.end(), 0.0);
+	/**
+	 * Get the dense feature vector for the ith component of y. The vector has
+	 * numFeatures() entries.
+	 */
+	const double* getFeatureVector(unsigned int i) const {
 
-		for (unsigned int i = 0; i < _features.size(); i++)
-			for (unsigned int j = 0; j < w.size(); j++)
-				f[i] += w[j]*_features[i][j];
+		return &_features[static_cast<size_t>(i)*_stride];
 	}
 
 	/**
-	 * For a given assignment of y, get the combined feature vector e := φ(x')y, 
+	 * The distance between the starts of two consecutive dense feature
+	 * vectors, see getFeatureVector().
+	 */
+	unsigned int getStride() const {
+
+		return _stride;
+	}
+
+	/**
+	 * For a given set of feature weights w, get the coefficients f := wφ(x'),
+	 * such that E(y) = <f,y>.
+	 */
+	void getCoefficients(const std::vector<double>& w, std::vector<double>& f) const;
+
+	/**
+	 * For a given assignment of y, get the combined feature vector e := φ(x')y,
 	 * such that E(y) = <w,e>.
 	 */
-	void combineFeatures(const std::vector<double>& y, std::vector<double>& e) const {
+	void combineFeatures(const std::vector<double>& y, std::vector<double>& e) const;
 
-		std::fill(e.begin(), e.end(), 0.0);
+	/**
+	 * Same as above for a binary labeling y.
+	 */
+	void combineFeatures(const Labeling& y, std::vector<double>& e) const;
 
-		for (unsigned int i = 0; i < _features.size(); i++)
-			for (unsigned int j = 0; j < e.size(); j++)
-				e[j] += y[i]*_features[i][j];
-	}
+	/**
+	 * Add Σ_k weights[k] φ_components[k] to e, e.g., to update φ(x')y for a
+	 * change of few components of y.
+	 */
+	void accumulateFeatures(
+			const std::vector<unsigned int>& components,
+			const std::vector<double>&       weights,
+			std::vector<double>&             e) const;
 
 	/**
 	 * The number of features per feature vector.
@@ -77,63 +134,72 @@ public:
 	 */
 	unsigned int numFeatureVectors() const {
 
-		return _features.size();
+		return _numFeatureVectors;
 	}
 
 	/**
-	 * Remove all features.
+	 * The number of stored features, i.e., the number of non-zeros for sparse
+	 * features.
 	 */
-	void clear() {
+	size_t numEntries() const {
 
-		_features.clear();
+		return (_sparse ? _values.size() : static_cast<size_t>(_numFeatureVectors)*_numFeatures);
 	}
 
 	/**
-	 * Normalize all features, such that their absolute values are in the range 
-	 * [0,1].
+	 * Remove all features.
 	 */
-	void normalize() {
-
-		_min = std::vector<double>(_numFeatures, std::numeric_limits<double>::max());
-		_max = std::vector<double>(_numFeatures, std::numeric_limits<double>::min());
+	void clear();
 
-		// find min and max
-		foreach (const std::vector<double>& f, _features) {
-
-			for (unsigned int i = 0; i < _numFeatures; i++) {
+	/**
+	 * Normalize all features, such that their absolute values are in the range
+	 * [0,1].
+	 */
+	void normalize();
 
-				_min[i] = std::min(_min[i], f[i]);
-				_max[i] = std::max(_max[i], f[i]);
-			}
-		}
+	/**
+	 * Extend the given per-feature range [min,max] to include the features of
+	 * this set. Use this together with normalize(min, max) to normalize
+	 * several feature sets in the same way.
+	 */
+	void updateRange(std::vector<double>& min, std::vector<double>& max) const;
 
-		// scale features
-		foreach (std::vector<double>& f, _features)
-			normalize(f);
-	}
+	/**
+	 * Normalize all features according to the given range of values, such
+	 * that their absolute values are in the range [0,1].
+	 */
+	void normalize(const std::vector<double>& min, const std::vector<double>& max);
 
 	/**
-	 * Normalize a single feature vector in the same way, the features of this 
-	 * set have been noramlized already (this assumes that noramlize() was 
-	 * called already). Use this to convert the learnt weight vector into the 
+	 * Normalize a single feature vector in the same way, the features of this
+	 * set have been noramlized already (this assumes that noramlize() was
+	 * called already). Use this to convert the learnt weight vector into the
 	 * original feature space.
 	 */
-	inline void normalize(std::vector<double>& f) {
+	void normalize(std::vector<double>& f);
 
-		for (unsigned int i = 0; i < _numFeatures; i++) {
+private:
 
-			double maxAbs = std::max(std::abs(_min[i]), std::abs(_max[i]));
+	// the value to divide feature i by in normalize()
+	double maxAbs(unsigned int i) const;
 
-			if (maxAbs > 0)
-				f[i] = f[i]/maxAbs;
-		}
-	}
+	unsigned int _numFeatures;
 
-private:
+	unsigned int _numFeatureVectors;
 
-	unsigned int _numFeatures;
+	bool _sparse;
+
+	// the distance between two dense feature vectors in _features
+	unsigned int _stride;
+
+	// all dense feature vectors, one after another
+	MappableVector<double, AlignedAllocator<double> > _features;
 
-	std::vector<std::vector<double> > _features;
+	// sparse feature vectors in CSR format: the non-zeros of feature vector i
+	// are _values[k] at _indices[k] for _rowStarts[i] <= k < _rowStarts[i+1]
+	MappableVector<size_t>       _rowStarts;
+	MappableVector<unsigned int> _indices;
+	MappableVector<double>       _values;
 
 	std::vector<double> _min;
 	std::vector<double> _max;
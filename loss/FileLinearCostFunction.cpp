@@ -1,96 +1,146 @@
-#include <fstream>
-#include <boost/lexical_cast.hpp>
-
-#include <util/files.h>
-#include "FileLinearCostFunction.h"
+#include <boost/bind/bind.hpp>
 
+#include <io/TextTokenizer.h>
 #include <util/Logger.h>
-#include <vector>
+#include "FileLinearCostFunction.h"
 
 using namespace logger;
+using namespace boost::placeholders;
 
-FileLinearCostFunction::FileLinearCostFunction(std::string filename) {
-
-	std::string number = "0123456789.eE-+";
+FileLinearCostFunction::FileLinearCostFunction(std::string filename, unsigned int numThreads) :
+	_filename(filename),
+	_c(0) {
 
 	LOG_USER(out) << "Attempting to read from file: " << filename << std::endl;
 
-	std::ifstream in(filename.c_str());
+	if (BinaryDataset::isBinaryDataset(filename)) {
 
-	_l.clear();
+		readBinary();
+		return;
+	}
 
-	unsigned int lineNumber = 1;
+	TextFileReader         reader(filename, numThreads);
+	std::vector<TextChunk> chunks;
 
-	while (!in.eof() && in.good()) {
+	// the first non-empty line has to give the number of variables
+	bool first = true;
 
-		// Read line
-		std::string line = readline(in);
+	while (reader.readBlock(chunks)) {
 
-		// Process line
-		if (line != "") {
+		std::vector<ChunkCosts> costs(chunks.size());
 
-			// Is this the first line? In this case we expect information about the number of variables.
-			if (lineNumber == 1) {
+		TextFileReader::parseChunks(
+				chunks,
+				boost::bind(&FileLinearCostFunction::parseChunk, this, _1, _2, boost::ref(costs)));
 
-				if (line.find("numVar") != std::string::npos) { 	// Line contains information about the number of variables.
-					
-					size_t beginning = line.find_first_of(number);
-					size_t end = line.find('#');
-					int numVar = boost::lexical_cast<int>(line.substr(beginning, end - beginning));
+		for (unsigned int k = 0; k < costs.size(); k++) {
 
-					_l.resize(numVar);
+			const ChunkCosts& chunkCosts = costs[k];
 
-					// initiate vector with zeros, this enables sparse representation of the variables.
-					for ( std::vector<double>::size_type varNum = 0; varNum < _l.size(); varNum++ ) {
-						_l[varNum] = 0;
-					}
+			if (chunkCosts.firstLine == 0)
+				continue;
+
+			if (first) {
+
+				if (chunkCosts.headerLine != chunkCosts.firstLine) {
 
-				}
-				else {
 					LOG_USER(out) << "Could not read variables since the number of variables was not specified in the first line." << std::endl;
-					break;
+					return;
 				}
+
+				// initiate vector with zeros, this enables sparse representation of the variables.
+				_l.assign(chunkCosts.numVar, 0.0);
+				first = false;
+
+			} else if (chunkCosts.headerLine != 0) {
+
+				LOG_USER(out) << "Ignoring the number of variables in line " << chunkCosts.headerLine << "." << std::endl;
 			}
-			else {
-				
-				// Does this line specify a variable or the constant?
-				if (line.find("constant") != std::string::npos) { 	// constant
-
-					// Read constant
-					size_t beginning = line.find_first_of(number);
-					size_t end = line.find('#');
-					double value = boost::lexical_cast<double>(line.substr(beginning, end - beginning));
-
-					// Save
-					_c = value;
-				}
-				else {							// variable
-					// Read variable
-					// The value is assumed to start after the first blank.
-					// An improvement could be made here to make the representation 'sparse'.
-
-					// Read variable number
-					size_t beginningVarNum = line.find_first_of(number);
-					size_t endVarNum = line.find_first_of(" ");
-
-					double varNum = boost::lexical_cast<double>(line.substr(beginningVarNum, endVarNum - beginningVarNum));
-					
-					// Read variable	
-					size_t beginningValue = line.find_first_of(" ") + 1;
-					size_t endValue = line.find('#');
-
-					double value = boost::lexical_cast<double>(line.substr(beginningValue, endValue - beginningValue));
-					
-					// Save
-					if ( varNum >= _l.size() ) {
-						LOG_USER(out) << "Variable number was higher than the number of variables that were specified." << std::endl;
-						_l.resize(varNum+1);
-					}
-					_l[varNum] = value;
+
+			if (chunkCosts.haveConstant)
+				_c = chunkCosts.constant;
+
+			for (unsigned int i = 0; i < chunkCosts.variables.size(); i++) {
+
+				unsigned int varNum = chunkCosts.variables[i];
+
+				if (varNum >= _l.size()) {
+
+					LOG_USER(out) << "Variable number was higher than the number of variables that were specified." << std::endl;
+					_l.resize(varNum + 1, 0.0);
 				}
+
+				_l[varNum] = chunkCosts.values[i];
+			}
+		}
+	}
+}
+
+void
+FileLinearCostFunction::readBinary() {
+
+	BinaryDataset dataset(_filename);
+
+	size_t numCoefficients, numConstants;
+	const double* coefficients = dataset.get<double>(BinaryDataset::CostCoefficients, numCoefficients);
+	const double* constant     = dataset.get<double>(BinaryDataset::CostConstant, numConstants);
+
+	if (numConstants != 1)
+		BOOST_THROW_EXCEPTION(BinaryDatasetError() << error_message(_filename + ": invalid constant offset"));
+
+	_l.assign(coefficients, coefficients + numCoefficients);
+	_c = *constant;
+}
+
+void
+FileLinearCostFunction::parseChunk(const TextChunk& chunk, unsigned int k, std::vector<ChunkCosts>& costs) {
+
+	TextTokenizer tokenizer(chunk);
+
+	ChunkCosts& chunkCosts = costs[k];
+
+	while (tokenizer.nextLine()) {
+
+		if (!tokenizer.hasMore())
+			continue;
+
+		if (chunkCosts.firstLine == 0)
+			chunkCosts.firstLine = tokenizer.getLineNumber();
+
+		bool valid = true;
+
+		if (tokenizer.accept("numVar")) {
+
+			// line contains information about the number of variables
+			chunkCosts.headerLine = tokenizer.getLineNumber();
+			valid = tokenizer.skipToNumber() && tokenizer.readUnsigned(chunkCosts.numVar);
+
+		} else if (tokenizer.accept("constant")) {
+
+			chunkCosts.haveConstant = true;
+			valid = tokenizer.skipToNumber() && tokenizer.readDouble(chunkCosts.constant);
+
+		} else {
+
+			// <variable> <value>
+			unsigned int varNum;
+			double       value;
+
+			valid = tokenizer.readUnsigned(varNum) && tokenizer.readDouble(value);
+
+			if (valid) {
+
+				chunkCosts.variables.push_back(varNum);
+				chunkCosts.values.push_back(value);
 			}
-		
-			lineNumber++;
 		}
+
+		if (!valid)
+			BOOST_THROW_EXCEPTION(
+					LinearCostFunctionError() <<
+							error_message(
+									_filename + ", line " + boost::lexical_cast<std::string>(tokenizer.getLineNumber()) +
+									": could not read '" + tokenizer.getToken() + "'"));
 	}
 }
+
@@ -2,13 +2,39 @@
 #define SBMRM_FILE_LINEAR_COST_FUNCTION_H__
 
 #include <string>
+#include <vector>
+
+#include <io/BinaryDataset.h>
+#include <io/TextFileReader.h>
 #include "LinearCostFunction.h"
 
+struct LinearCostFunctionError : virtual Exception {};
+
+/**
+ * Reads the coefficients of a linear cost function from a file of the form
+ *
+ *   numVar <number of variables>
+ *   <variable> <coefficient>
+ *   ...
+ *   constant <constant offset>
+ *
+ * Variables that are not listed have coefficient 0. The file can also be a
+ * BinaryDataset with linear costs.
+ */
 class FileLinearCostFunction : public LinearCostFunction {
 
 public:
 
-	FileLinearCostFunction(std::string filename);
+	/**
+	 * Read the linear costs from a file.
+	 *
+	 * @param filename
+	 *              The file to read the costs from.
+	 * @param numThreads
+	 *              The number of threads to parse the file with. 0 uses the
+	 *              value of --io.numThreads.
+	 */
+	FileLinearCostFunction(std::string filename, unsigned int numThreads = 0);
 
 	/**
 	 * Get the linear coefficients a(y').
@@ -22,6 +48,35 @@ public:
 
 private:
 
+	// the content of a chunk of the file
+	struct ChunkCosts {
+
+		ChunkCosts() :
+			firstLine(0),
+			headerLine(0),
+			numVar(0),
+			haveConstant(false),
+			constant(0) {}
+
+		// the first non-empty line and the line with the number of variables
+		unsigned int firstLine;
+		unsigned int headerLine;
+		unsigned int numVar;
+
+		bool   haveConstant;
+		double constant;
+
+		std::vector<unsigned int> variables;
+		std::vector<double>       values;
+	};
+
+	void readBinary();
+
+	// parse the kth chunk of a block into costs[k]
+	void parseChunk(const TextChunk& chunk, unsigned int k, std::vector<ChunkCosts>& costs);
+
+	std::string _filename;
+
 	std::vector<double> _l;
 	double              _c;
 };
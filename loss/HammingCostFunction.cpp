@@ -1,7 +1,6 @@
-#include <algorithm>
 #include "HammingCostFunction.h"
 
-HammingCostFunction::HammingCostFunction(const std::vector<double>& groundTruth) {
+HammingCostFunction::HammingCostFunction(const Labeling& groundTruth) {
 
 	// H(y',y) = Σ|y'_i - y_i|
 	//         = Σ_{i:y'_i = 1} (1-y_i) + Σ_{i:y'_i = 0} y_i
@@ -11,9 +10,9 @@ HammingCostFunction::HammingCostFunction(const std::vector<double>& groundTruth)
 	//   with l_i := -1 if y'_i = 1
 	//                1 else
 
-	_c = std::count(groundTruth.begin(), groundTruth.end(), 1.0);
+	_c = groundTruth.count();
 
 	_l.resize(groundTruth.size());
 	for (unsigned int i = 0; i < _l.size(); i++)
-		_l[i] = (groundTruth[i] == 1.0 ? -1 : 1);
+		_l[i] = (groundTruth[i] ? -1 : 1);
 }
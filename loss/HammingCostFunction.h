@@ -1,6 +1,7 @@
 #ifndef SBMRM_LOSS_HAMMING_COST_FUNCTION_H__
 #define SBMRM_LOSS_HAMMING_COST_FUNCTION_H__
 
+#include "Labeling.h"
 #include "LinearCostFunction.h"
 
 class HammingCostFunction : public LinearCostFunction {
@@ -10,7 +11,7 @@ public:
 	/**
 	 * Create a Hamming cost function for the given ground truth vector.
 	 */
-	HammingCostFunction(const std::vector<double>& groundTruth);
+	HammingCostFunction(const Labeling& groundTruth);
 
 	/**
 	 * Get the linear coefficients a(y').
@@ -0,0 +1,160 @@
+#include <io/BinaryDataset.h>
+#include "Labeling.h"
+
+namespace {
+
+inline unsigned int
+popcount(boost::uint64_t word) {
+
+	return __builtin_popcountll(word);
+}
+
+// the index of the lowest set bit of a non-zero word
+inline unsigned int
+lowestBit(boost::uint64_t word) {
+
+	return __builtin_ctzll(word);
+}
+
+} // anonymous namespace
+
+Labeling::Labeling(unsigned int size) :
+	_size(0) {
+
+	resize(size);
+}
+
+Labeling::Labeling(const std::vector<double>& y) :
+	_size(0) {
+
+	assign(y);
+}
+
+void
+Labeling::assign(const std::vector<double>& y) {
+
+	_size = y.size();
+	_words.assign((_size + 63)/64, 0);
+
+	for (unsigned int i = 0; i < _size; i++)
+		if (y[i] > 0.5)
+			_words[i/64] |= (boost::uint64_t(1) << (i%64));
+}
+
+void
+Labeling::resize(unsigned int size) {
+
+	if (size < _size && size%64 != 0 && size/64 < _words.size())
+		// keep the unused bits of the (new) last word 0
+		_words[size/64] &= (boost::uint64_t(1) << (size%64)) - 1;
+
+	_size = size;
+	_words.resize((_size + 63)/64, 0);
+}
+
+void
+Labeling::push_back(bool label) {
+
+	resize(_size + 1);
+	set(_size - 1, label);
+}
+
+unsigned int
+Labeling::count() const {
+
+	unsigned int count = 0;
+	for (unsigned int w = 0; w < _words.size(); w++)
+		count += popcount(_words[w]);
+
+	return count;
+}
+
+unsigned int
+Labeling::hammingDistance(const Labeling& other) const {
+
+	if (other._size != _size)
+		BOOST_THROW_EXCEPTION(SizeMismatchError() << error_message("labelings have different sizes"));
+
+	unsigned int distance = 0;
+	for (unsigned int w = 0; w < _words.size(); w++)
+		distance += popcount(_words[w] ^ other._words[w]);
+
+	return distance;
+}
+
+double
+Labeling::dot(const std::vector<double>& f) const {
+
+	double sum = 0;
+
+	for (unsigned int w = 0; w < _words.size(); w++)
+		for (boost::uint64_t word = _words[w]; word != 0; word &= word - 1)
+			sum += f[w*64 + lowestBit(word)];
+
+	return sum;
+}
+
+void
+Labeling::getOnes(std::vector<unsigned int>& indices) const {
+
+	indices.clear();
+
+	for (unsigned int w = 0; w < _words.size(); w++)
+		for (boost::uint64_t word = _words[w]; word != 0; word &= word - 1)
+			indices.push_back(w*64 + lowestBit(word));
+}
+
+void
+Labeling::getDifferences(const Labeling& other, std::vector<unsigned int>& indices) const {
+
+	if (other._size != _size)
+		BOOST_THROW_EXCEPTION(SizeMismatchError() << error_message("labelings have different sizes"));
+
+	indices.clear();
+
+	for (unsigned int w = 0; w < _words.size(); w++)
+		for (boost::uint64_t word = _words[w] ^ other._words[w]; word != 0; word &= word - 1)
+			indices.push_back(w*64 + lowestBit(word));
+}
+
+void
+Labeling::read(const BinaryDataset& dataset) {
+
+	size_t size;
+	const boost::uint8_t* labels = dataset.get<boost::uint8_t>(BinaryDataset::Labels, size);
+
+	_size = size;
+	_words.assign((_size + 63)/64, 0);
+
+	for (unsigned int i = 0; i < _size; i++) {
+
+		if (labels[i] > 1)
+			BOOST_THROW_EXCEPTION(LabelingError() << error_message(dataset.getFilename() + ": labels have to be 0 or 1"));
+
+		if (labels[i])
+			_words[i/64] |= (boost::uint64_t(1) << (i%64));
+	}
+}
+
+void
+Labeling::write(BinaryDatasetWriter& writer) const {
+
+	std::vector<boost::uint8_t> labels(_size);
+
+	for (unsigned int i = 0; i < _size; i++)
+		labels[i] = (*this)[i];
+
+	writer.add(BinaryDataset::Labels, labels.empty() ? 0 : &labels[0], labels.size());
+}
+
+std::vector<double>
+Labeling::toVector() const {
+
+	std::vector<double> y(_size, 0.0);
+
+	for (unsigned int i = 0; i < _size; i++)
+		if ((*this)[i])
+			y[i] = 1.0;
+
+	return y;
+}
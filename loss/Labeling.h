@@ -0,0 +1,127 @@
+#ifndef SBMRM_LOSS_LABELING_H__
+#define SBMRM_LOSS_LABELING_H__
+
+#include <vector>
+#include <boost/cstdint.hpp>
+
+#include <util/exceptions.h>
+
+class BinaryDataset;
+class BinaryDatasetWriter;
+
+struct LabelingError : virtual Exception {};
+
+/**
+ * A binary labeling y ∈ {0,1}^n, stored as a bitset with one bit per
+ * component. Counting, comparing and summing over labelings work on whole
+ * words of 64 components, using popcount and iterating over the set bits
+ * only.
+ */
+class Labeling {
+
+public:
+
+	explicit Labeling(unsigned int size = 0);
+
+	/**
+	 * Create a labeling from a vector of 0s and 1s, e.g., the solution of an
+	 * ILP. Values are rounded to the closest label.
+	 */
+	explicit Labeling(const std::vector<double>& y);
+
+	/**
+	 * Replace this labeling with the rounded values of y.
+	 */
+	void assign(const std::vector<double>& y);
+
+	/**
+	 * Change the number of components. New components are labeled 0.
+	 */
+	void resize(unsigned int size);
+
+	/**
+	 * Append a component with the given label.
+	 */
+	void push_back(bool label);
+
+	/**
+	 * Remove all components.
+	 */
+	void clear() { _words.clear(); _size = 0; }
+
+	unsigned int size() const { return _size; }
+
+	bool operator[](unsigned int i) const {
+
+		return (_words[i/64] >> (i%64)) & 1;
+	}
+
+	void set(unsigned int i, bool label = true) {
+
+		if (label)
+			_words[i/64] |= (boost::uint64_t(1) << (i%64));
+		else
+			_words[i/64] &= ~(boost::uint64_t(1) << (i%64));
+	}
+
+	bool operator==(const Labeling& other) const {
+
+		return _size == other._size && _words == other._words;
+	}
+
+	bool operator!=(const Labeling& other) const {
+
+		return !(*this == other);
+	}
+
+	/**
+	 * The number of components labeled 1.
+	 */
+	unsigned int count() const;
+
+	/**
+	 * The number of components in which this and the other labeling differ.
+	 */
+	unsigned int hammingDistance(const Labeling& other) const;
+
+	/**
+	 * The dot product <f,y> with a real vector f.
+	 */
+	double dot(const std::vector<double>& f) const;
+
+	/**
+	 * Get the components labeled 1.
+	 */
+	void getOnes(std::vector<unsigned int>& indices) const;
+
+	/**
+	 * Get the components in which this and the other labeling differ.
+	 */
+	void getDifferences(const Labeling& other, std::vector<unsigned int>& indices) const;
+
+	/**
+	 * Convert into a vector of 0s and 1s.
+	 */
+	std::vector<double> toVector() const;
+
+	/**
+	 * Replace this labeling with the labels of a binary dataset.
+	 */
+	void read(const BinaryDataset& dataset);
+
+	/**
+	 * Write this labeling to a binary dataset.
+	 */
+	void write(BinaryDatasetWriter& writer) const;
+
+private:
+
+	unsigned int _size;
+
+	// bit i%64 of word i/64 is the label of component i, unused bits of the
+	// last word are 0
+	std::vector<boost::uint64_t> _words;
+};
+
+#endif // SBMRM_LOSS_LABELING_H__
+
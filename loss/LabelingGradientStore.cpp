@@ -0,0 +1,108 @@
+#include <util/Logger.h>
+#include "LabelingGradientStore.h"
+
+logger::LogChannel labelinggradientstorelog("labelinggradientstorelog", "[LabelingGradientStore] ");
+
+LabelingGradientStore::LabelingGradientStore(SoftMarginLossSum& loss, bool perSample) :
+	_loss(loss),
+	_perSample(perSample) {}
+
+unsigned int
+LabelingGradientStore::add(unsigned int summand) {
+
+	unsigned int id = _entries.size();
+
+	if (_free.empty()) {
+
+		_entries.push_back(Entry());
+
+	} else {
+
+		id = _free.back();
+		_free.pop_back();
+	}
+
+	Entry& entry = _entries[id];
+
+	entry.firstSample = (_perSample ? summand : 0);
+	entry.labelings.resize(_perSample ? 1 : _loss.numSamples());
+
+	for (unsigned int k = 0; k < entry.labelings.size(); k++)
+		entry.labelings[k] = _loss.getSample(entry.firstSample + k).getLastLabeling();
+
+	LOG_ALL(labelinggradientstorelog) << "storing gradient of summand " << summand << " as " << id << std::endl;
+
+	return id;
+}
+
+void
+LabelingGradientStore::remove(unsigned int id) {
+
+	_entries[id].labelings.clear();
+	_free.push_back(id);
+}
+
+void
+LabelingGradientStore::dots(
+		const std::vector<double>&       a,
+		const std::vector<unsigned int>& ids,
+		std::vector<double>&             products) {
+
+	unsigned int numSamples = _loss.numSamples();
+
+	// <a,φ(x')(y' - y)> = offset - <c,y>, computed once for each sample that
+	// is needed, in parallel
+	std::vector<bool> needed(numSamples, false);
+
+	for (unsigned int k = 0; k < ids.size(); k++) {
+
+		const Entry& entry = _entries[ids[k]];
+		for (unsigned int i = 0; i < entry.labelings.size(); i++)
+			needed[entry.firstSample + i] = true;
+	}
+
+	_loss.getGradientCoefficients(a, needed, _offsets, _coefficients);
+
+	products.resize(ids.size());
+
+	for (unsigned int k = 0; k < ids.size(); k++) {
+
+		const Entry& entry = _entries[ids[k]];
+
+		products[k] = 0;
+		for (unsigned int i = 0; i < entry.labelings.size(); i++) {
+
+			unsigned int s = entry.firstSample + i;
+			products[k] += _offsets[s] - entry.labelings[i].dot(_coefficients[s]);
+		}
+	}
+}
+
+void
+LabelingGradientStore::accumulate(
+		const std::vector<unsigned int>& ids,
+		const std::vector<double>&       weights,
+		std::vector<double>&             a) {
+
+	unsigned int numSamples = _loss.numSamples();
+
+	// the labelings and weights per sample
+	std::vector<std::vector<const Labeling*> > labelings(numSamples);
+	std::vector<std::vector<double> >          sampleWeights(numSamples);
+
+	for (unsigned int k = 0; k < ids.size(); k++) {
+
+		const Entry& entry = _entries[ids[k]];
+
+		for (unsigned int i = 0; i < entry.labelings.size(); i++) {
+
+			labelings[entry.firstSample + i].push_back(&entry.labelings[i]);
+			sampleWeights[entry.firstSample + i].push_back(weights[k]);
+		}
+	}
+
+	for (unsigned int s = 0; s < numSamples; s++)
+		if (!labelings[s].empty())
+			_loss.getSample(s).accumulateGradients(labelings[s], sampleWeights[s], a);
+}
+
@@ -0,0 +1,80 @@
+#ifndef SBMRM_LOSS_LABELING_GRADIENT_STORE_H__
+#define SBMRM_LOSS_LABELING_GRADIENT_STORE_H__
+
+#include <vector>
+
+#include <bundle/GradientStore.h>
+#include "Labeling.h"
+#include "SoftMarginLossSum.h"
+
+/**
+ * Stores the gradients of a sum of soft margin losses by the labelings y* they
+ * were computed from. A gradient Σ_s φ(x'_s)(y'_s - y*_s) needs one bit per
+ * component of y*, instead of one double per feature.
+ *
+ * Products with the gradients are computed from the features of the samples
+ * on demand: <a,φ(x')(y' - y*)> needs one product aφ(x') per sample, shared
+ * by all stored gradients. The products of the samples are computed in
+ * parallel by the SoftMarginLossSum.
+ */
+class LabelingGradientStore : public GradientStore {
+
+public:
+
+	/**
+	 * @param loss
+	 *             The sum of losses whose gradients to store.
+	 *
+	 * @param perSample
+	 *             If true, summand s of the bundle method is the loss of
+	 *             sample s (multiple cuts). Otherwise, there is only one
+	 *             summand, the sum of all losses.
+	 */
+	LabelingGradientStore(SoftMarginLossSum& loss, bool perSample);
+
+	unsigned int add(unsigned int summand);
+
+	void remove(unsigned int id);
+
+	void dots(
+			const std::vector<double>&       a,
+			const std::vector<unsigned int>& ids,
+			std::vector<double>&             products);
+
+	void accumulate(
+			const std::vector<unsigned int>& ids,
+			const std::vector<double>&       weights,
+			std::vector<double>&             a);
+
+	/**
+	 * The number of stored gradients.
+	 */
+	unsigned int size() const { return _entries.size() - _free.size(); }
+
+private:
+
+	// a stored gradient, the labelings of the samples firstSample,
+	// firstSample + 1, ...
+	struct Entry {
+
+		unsigned int          firstSample;
+		std::vector<Labeling> labelings;
+	};
+
+	SoftMarginLossSum& _loss;
+
+	bool _perSample;
+
+	std::vector<Entry> _entries;
+
+	// ids of removed entries, to be reused
+	std::vector<unsigned int> _free;
+
+	// the products aφ(x') and <a,φ(x')y'> of each sample in dots(), kept to
+	// reuse the memory
+	std::vector<double>               _offsets;
+	std::vector<std::vector<double> > _coefficients;
+};
+
+#endif // SBMRM_LOSS_LABELING_GRADIENT_STORE_H__
+
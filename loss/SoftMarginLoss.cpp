@@ -1,17 +1,65 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 #include <util/Logger.h>
+#include <util/ProgramOptions.h>
 #include <util/helpers.hpp>
 #include "SoftMarginLoss.h"
 
 logger::LogChannel softmarginlosslog("softmarginlosslog", "[SoftMarginLoss] ");
 
+util::ProgramOption optionMaxCachedLabelings(
+		util::_module           = "loss",
+		util::_long_name        = "maxCachedLabelings",
+		util::_description_text = "The number of maximizers of the soft margin loss to remember per training sample. The "
+		                          "bundle method uses them to find hyperplanes without solving the ILP. 0 disables the cache.",
+		util::_default_value    = 100);
+
+util::ProgramOption optionRecomputeCombinedFeatures(
+		util::_module           = "loss",
+		util::_long_name        = "recomputeCombinedFeatures",
+		util::_description_text = "φ(x')y* is updated with the components of y* that changed since the previous evaluation. "
+		                          "After this many updates, it is recomputed from scratch to limit rounding errors. 0 always "
+		                          "recomputes φ(x')y*.",
+		util::_default_value    = 100);
+
+util::ProgramOption optionForceIlp(
+		util::_module           = "loss",
+		util::_long_name        = "forceIlp",
+		util::_description_text = "Always solve the ILP, even if the constraints only bound the number of ones in disjoint "
+		                          "groups of variables, for which the maximizer is found in closed form otherwise.");
+
+util::ProgramOption optionRelaxFirst(
+		util::_module           = "loss",
+		util::_long_name        = "relaxFirst",
+		util::_description_text = "Solve the linear relaxation of the ILP first and accept its solution if it is integral. "
+		                          "The ILP is only solved if it is not. This is much faster for constraints whose relaxation "
+		                          "is integral, like assignment or interval constraints.");
+
+// how far a component of the relaxed solution can be from 0 or 1 to be
+// considered integral
+static const double IntegralityTolerance = 1e-6;
+
 SoftMarginLoss::SoftMarginLoss(
 		LinearCostFunction&                   costs,
 		pipeline::Value<LinearConstraints>    constraints,
 		pipeline::Value<Features>             features,
-		pipeline::Value<std::vector<double> > groundTruth) :
+		pipeline::Value<Labeling>             groundTruth) :
 
+		_constraints(constraints),
 		_features(features),
-		_groundTruth(groundTruth) {
+		_groundTruth(groundTruth),
+		_forceIlp(optionForceIlp.as<bool>()),
+		_relaxFirst(optionRelaxFirst.as<bool>()),
+		_numSolvedInClosedForm(0),
+		_numSolvedByRelaxation(0),
+		_numSolvedByIlp(0),
+		_recomputeInterval(optionRecomputeCombinedFeatures.as<unsigned int>()),
+		_numUpdates(0),
+		_maxCached(optionMaxCachedLabelings.as<unsigned int>()),
+		_numCached(0),
+		_numEvaluations(0) {
 
 	_f.resize(_groundTruth->size(), 0.0);
 
@@ -46,6 +94,19 @@ SoftMarginLoss::SoftMarginLoss(
 void
 SoftMarginLoss::valueAndGradient(const std::vector<double>& w, double& value, std::vector<double>& gradient) {
 
+	double upperBound;
+
+	inexactValueAndGradient(w, 0.0, value, upperBound, gradient);
+}
+
+void
+SoftMarginLoss::inexactValueAndGradient(
+		const std::vector<double>& w,
+		double                     tolerance,
+		double&                    value,
+		double&                    upperBound,
+		std::vector<double>&       gradient) {
+
 	// L(w) = max_y <w,φ(x')y' - φ(x')y>     + Δ(y',y)
 	//      = max_y <wφ(x'),y'-y>            + Δ(y',y)
 	//      = max_y <wφ(x'),y'> - <wφ(x'),y> + Δ(y',y)
@@ -60,7 +121,7 @@ SoftMarginLoss::valueAndGradient(const std::vector<double>& w, double& value, st
 	//      = max_y <f,y'>  - <f,y> +  Δ(y',y)
 	//      = max_y    a    - <f,y> +  b + <g, y>
 
-	double a = dot(_f, *_groundTruth);
+	double a = _groundTruth->dot(_f);
 
 	//      = max_y (a + b) + <(g - f),y>
 
@@ -71,24 +132,284 @@ SoftMarginLoss::valueAndGradient(const std::vector<double>& w, double& value, st
 
 	LOG_ALL(softmarginlosslog) << "objective is " << *_objective << std::endl;
 
-	// let solver know we changed the objective
-	_solver->setInput("objective", _objective);
+	double relaxedBound = std::numeric_limits<double>::infinity();
+
+	if (!_forceIlp && solveClosedForm(value)) {
+
+		upperBound = value;
+
+	} else if (_relaxFirst && solveRelaxation(value, relaxedBound)) {
 
-	// read optimal value L(w)
-	value = _solution->getValue();
+		upperBound = value;
+
+	} else {
+
+		// the gap is read on every solve, changing it does not reset the
+		// solver
+		_parameters->setAbsoluteGap(tolerance);
+
+		// let solver know we changed the objective
+		_solver->setInput("objective", _objective);
+
+		// read value of y*, which is optimal up to the tolerance
+		value      = _solution->getValue();
+		upperBound = std::max(value, std::min(_solution->getBound(), relaxedBound));
+
+		_y.assign(_solution->getVector());
+
+		_numSolvedByIlp++;
+	}
+
+	LOG_ALL(softmarginlosslog) << "L(w) is in [" << value << ", " << upperBound << "]" << std::endl;
 
 	// ∂L(w)/∂w = φ(x')y' - φ(x')y*
 	//          = d       - e
 
 	// compute gradient
 	gradient = _d;
-	_features->combineFeatures(_solution->getVector(), _e);
+	updateCombinedFeatures(_y);
+	for (unsigned int i = 0; i < gradient.size(); i++)
+		gradient[i] -= _e[i];
+
+	_lastY = _y;
+
+	// the offset of the hyperplane is Δ(y',y*), which does not depend on w
+	addToCache(value - dot(w, gradient), _y);
+}
+
+bool
+SoftMarginLoss::solveClosedForm(double& value) {
+
+	unsigned int n = _groundTruth->size();
+
+	if (!_closedForm)
+		_closedForm.reset(new ClosedFormSolver(n, *_constraints));
+
+	if (!_closedForm->isApplicable())
+		return false;
+
+	value = _closedForm->solve(*_objective, _closedFormSolution);
+
+	_y.resize(n);
+	for (unsigned int i = 0; i < n; i++)
+		_y.set(i, _closedFormSolution[i]);
+
+	_numSolvedInClosedForm++;
+
+	return true;
+}
+
+bool
+SoftMarginLoss::solveRelaxation(double& value, double& relaxedBound) {
+
+	unsigned int               n            = _groundTruth->size();
+	const std::vector<double>& coefficients = _objective->getCoefficients();
+
+	if (!_relaxation)
+		_relaxation.reset(new DualSimplex(n, *_constraints));
+
+	// the relaxation minimizes
+	_relaxedCosts.resize(n);
+	for (unsigned int i = 0; i < n; i++)
+		_relaxedCosts[i] = -coefficients[i];
+
+	_relaxation->setCosts(_relaxedCosts);
+
+	if (_relaxation->solve(std::numeric_limits<double>::infinity()) != DualSimplex::Optimal) {
+
+		LOG_DEBUG(softmarginlosslog) << "linear relaxation could not be solved, solving the ILP" << std::endl;
+		return false;
+	}
+
+	relaxedBound = _objective->getConstant() - _relaxation->getValue();
+
+	for (unsigned int i = 0; i < n; i++) {
+
+		double x = _relaxation->getSolution(i);
+
+		if (std::min(std::abs(x), std::abs(1.0 - x)) > IntegralityTolerance) {
+
+			LOG_DEBUG(softmarginlosslog)
+					<< "linear relaxation is fractional (y_" << i << " = " << x
+					<< "), solving the ILP" << std::endl;
+			return false;
+		}
+	}
+
+	// evaluate the rounded solution exactly
+	_y.resize(n);
+	value = _objective->getConstant();
+
+	for (unsigned int i = 0; i < n; i++) {
+
+		bool one = (_relaxation->getSolution(i) > 0.5);
+
+		_y.set(i, one);
+		if (one)
+			value += coefficients[i];
+	}
+
+	LOG_DEBUG(softmarginlosslog) << "linear relaxation is integral, skipping the ILP" << std::endl;
+
+	_numSolvedByRelaxation++;
+
+	return true;
+}
+
+bool
+SoftMarginLoss::approximateValueAndGradient(const std::vector<double>& w, double& value, std::vector<double>& gradient) {
+
+	if (_numCached == 0)
+		return false;
+
+	unsigned int best = 0;
+
+	_numEvaluations++;
+
+	// <w,φ(x')(y' - y_k)> + b_k = <f,y'> - <f,y_k> + b_k, with f := wφ(x')
+	// computed once for all cached labelings
+	_features->getCoefficients(w, _f);
+
+	double a = _groundTruth->dot(_f);
+
+	for (unsigned int k = 0; k < _numCached; k++) {
+
+		double v = a - _cachedY[k].dot(_f) + _cachedB[k];
+
+		if (k == 0 || v > value) {
+
+			value = v;
+			best  = k;
+		}
+	}
+
+	// only the gradient of the best hyperplane is computed
+	gradient = _d;
+	updateCombinedFeatures(_cachedY[best]);
 	for (unsigned int i = 0; i < gradient.size(); i++)
 		gradient[i] -= _e[i];
+
+	_cacheLastUsed[best] = _numEvaluations;
+	_lastY               = _cachedY[best];
+
+	LOG_ALL(softmarginlosslog) << "best of " << _numCached << " cached hyperplanes has value " << value << std::endl;
+
+	return true;
+}
+
+void
+SoftMarginLoss::getGradientCoefficients(
+		const std::vector<double>& a,
+		double&                    offset,
+		std::vector<double>&       coefficients) const {
+
+	// <a,φ(x')(y' - y)> = <a,d> - <aφ(x'),y>
+
+	offset = 0;
+	for (unsigned int i = 0; i < a.size(); i++)
+		offset += a[i]*_d[i];
+
+	coefficients.resize(_features->numFeatureVectors());
+	_features->getCoefficients(a, coefficients);
+}
+
+void
+SoftMarginLoss::accumulateGradients(
+		const std::vector<const Labeling*>& labelings,
+		const std::vector<double>&          weights,
+		std::vector<double>&                a) const {
+
+	// Σ_k w_k φ(x')(y' - y_k) = (Σ_k w_k) d - φ(x') Σ_k w_k y_k
+
+	double                    sum = 0;
+	std::vector<unsigned int> ones;
+	std::vector<unsigned int> components;
+	std::vector<double>       componentWeights;
+
+	for (unsigned int k = 0; k < labelings.size(); k++) {
+
+		sum += weights[k];
+
+		labelings[k]->getOnes(ones);
+		components.insert(components.end(), ones.begin(), ones.end());
+		componentWeights.resize(components.size(), -weights[k]);
+	}
+
+	for (unsigned int i = 0; i < a.size(); i++)
+		a[i] += sum*_d[i];
+
+	_features->accumulateFeatures(components, componentWeights, a);
+}
+
+void
+SoftMarginLoss::updateCombinedFeatures(const Labeling& y) {
+
+	bool haveDelta = (_previousY.size() == y.size());
+
+	if (haveDelta)
+		_previousY.getDifferences(y, _changed);
+
+	// e = φ(x')y costs O(|y|), an update e += φ(x')(y - _previousY) costs
+	// O(|y - _previousY|)
+	if (!haveDelta || _changed.size() >= y.count() || _numUpdates >= _recomputeInterval) {
+
+		LOG_ALL(softmarginlosslog) << "recomputing φ(x')y*" << std::endl;
+
+		_features->combineFeatures(y, _e);
+		_numUpdates = 0;
+
+	} else if (!_changed.empty()) {
+
+		LOG_ALL(softmarginlosslog) << "updating φ(x')y* for " << _changed.size() << " changed components" << std::endl;
+
+		_weights.resize(_changed.size());
+		for (unsigned int k = 0; k < _changed.size(); k++)
+			_weights[k] = (y[_changed[k]] ? 1.0 : -1.0);
+
+		_features->accumulateFeatures(_changed, _weights, _e);
+		_numUpdates++;
+	}
+
+	_previousY = y;
+}
+
+void
+SoftMarginLoss::addToCache(double b, const Labeling& y) {
+
+	if (_maxCached == 0)
+		return;
+
+	_numEvaluations++;
+
+	for (unsigned int k = 0; k < _numCached; k++)
+		if (_cachedY[k] == y) {
+
+			_cacheLastUsed[k] = _numEvaluations;
+			return;
+		}
+
+	unsigned int k = _numCached;
+
+	if (_numCached < _maxCached) {
+
+		_numCached++;
+		_cachedB.resize(_numCached);
+		_cachedY.resize(_numCached);
+		_cacheLastUsed.resize(_numCached);
+
+	} else {
+
+		// replace the least recently used hyperplane
+		k = std::min_element(_cacheLastUsed.begin(), _cacheLastUsed.end()) - _cacheLastUsed.begin();
+	}
+
+	_cachedB[k]       = b;
+	_cachedY[k]       = y;
+	_cacheLastUsed[k] = _numEvaluations;
 }
 
 double
-SoftMarginLoss::dot(std::vector<double>& a, std::vector<double>& b) {
+SoftMarginLoss::dot(const std::vector<double>& a, const std::vector<double>& b) {
 
 	assert(a.size() == b.size());
 
@@ -1,15 +1,20 @@
 #ifndef SBMRM_LOSS_SOFT_MARGIN_H__
 #define SBMRM_LOSS_SOFT_MARGIN_H__
 
+#include <boost/scoped_ptr.hpp>
+
 #include <pipeline/Value.h>
 #include <pipeline/Process.h>
 
+#include <inference/ClosedFormSolver.h>
+#include <inference/DualSimplex.h>
 #include <inference/LinearConstraints.h>
 #include <inference/LinearObjective.h>
 #include <inference/LinearSolver.h>
 #include <inference/LinearSolverParameters.h>
 #include <inference/Solution.h>
 #include "Features.h"
+#include "Labeling.h"
 #include "LinearCostFunction.h"
 
 /**
@@ -19,6 +24,27 @@
  *
  * for a ground truth y', features φ(x'), and a linear cost function Δ(y', y).  
  * The set of valid ys is given by linear constraints.
+ *
+ * Every maximizer y* found by the ILP defines a hyperplane
+ * <w,φ(x')y' - φ(x')y*> + Δ(y',y*) that bounds L(w) from below for all w.
+ * The most recent of these hyperplanes are cached (as their labelings y* and
+ * offsets Δ(y',y*)), such that a cheap approximation of L(w) is available
+ * without solving the ILP.
+ *
+ * Since all gradients have the form φ(x')(y' - y*), they can be represented
+ * by the labeling y* alone. getLastLabeling() provides it for the most recent
+ * gradient, and getGradientCoefficients() and accumulateGradients() work
+ * with gradients given by their labelings.
+ *
+ * If the constraints only bound the number of ones in disjoint groups of
+ * variables (see ClosedFormSolver), y* is found in closed form instead of
+ * solving the ILP.
+ *
+ * With --loss.relaxFirst, the linear relaxation y ∈ [0,1] of the ILP is
+ * solved first. If its solution is integral (which it always is for totally
+ * unimodular constraints), it is a maximizer of the ILP and the ILP is not
+ * solved. Otherwise, the ILP is solved as usual, and the value of the
+ * relaxation tightens the upper bound.
  */
 class SoftMarginLoss {
 
@@ -43,19 +69,94 @@ public:
 			LinearCostFunction&                   costs,
 			pipeline::Value<LinearConstraints>    constraints,
 			pipeline::Value<Features>             features,
-			pipeline::Value<std::vector<double> > groundTruth);
+			pipeline::Value<Labeling>             groundTruth);
 
 	/**
 	 * Computes the value and gradient of L(w).
 	 */
 	void valueAndGradient(const std::vector<double>& w, double& value, std::vector<double>& gradient);
 
+	/**
+	 * Computes the value and gradient of a hyperplane that bounds L(w) from
+	 * below and is at most tolerance below L(w) at w, by solving the ILP only
+	 * up to an absolute gap of tolerance. upperBound is set to the bound on
+	 * L(w) proven by the solver.
+	 */
+	void inexactValueAndGradient(
+			const std::vector<double>& w,
+			double                     tolerance,
+			double&                    value,
+			double&                    upperBound,
+			std::vector<double>&       gradient);
+
+	/**
+	 * Computes the value and gradient of the best cached hyperplane at w,
+	 * i.e., a lower bound on L(w). Does not solve the ILP.
+	 *
+	 * @return false, if the cache is empty.
+	 */
+	bool approximateValueAndGradient(const std::vector<double>& w, double& value, std::vector<double>& gradient);
+
+	/**
+	 * Limit the number of threads of the ILP solver, for when several losses
+	 * are evaluated concurrently. 0 for no limit.
+	 */
+	void setMaxSolverThreads(unsigned int maxThreads) { _parameters->setMaxThreads(maxThreads); }
+
+	/**
+	 * The labeling y* of the gradient φ(x')(y' - y*) returned by the most
+	 * recent call to any of the value and gradient methods.
+	 */
+	const Labeling& getLastLabeling() const { return _lastY; }
+
+	/**
+	 * For a vector a, get an offset and coefficients c, such that the product
+	 * with the gradient of labeling y is <a,φ(x')(y' - y)> = offset - <c,y>.
+	 */
+	void getGradientCoefficients(
+			const std::vector<double>& a,
+			double&                    offset,
+			std::vector<double>&       coefficients) const;
+
+	/**
+	 * Add Σ_k weights[k] φ(x')(y' - labelings[k]) to a.
+	 */
+	void accumulateGradients(
+			const std::vector<const Labeling*>& labelings,
+			const std::vector<double>&          weights,
+			std::vector<double>&                a) const;
+
+	/**
+	 * The number of maximizers found in closed form, by the linear
+	 * relaxation, and by the ILP so far.
+	 */
+	unsigned int getNumSolvedInClosedForm() const { return _numSolvedInClosedForm; }
+	unsigned int getNumSolvedByRelaxation() const { return _numSolvedByRelaxation; }
+	unsigned int getNumSolvedByIlp() const { return _numSolvedByIlp; }
+
 private:
 
-	inline double dot(std::vector<double>& a, std::vector<double>& b);
+	// find the maximizer _y of the current objective in closed form, if the
+	// constraints allow it
+	bool solveClosedForm(double& value);
+
+	// solve the linear relaxation of the current objective and set _y to its
+	// solution, if it is integral; set relaxedBound to the value of the
+	// relaxation, if it is solved to optimality
+	bool solveRelaxation(double& value, double& relaxedBound);
+
+	// set _e to φ(x')y, using the change of y since the previous call
+	void updateCombinedFeatures(const Labeling& y);
+
+	// add the hyperplane of labeling y with offset b to the cache, unless it
+	// is already present
+	void addToCache(double b, const Labeling& y);
 
+	inline double dot(const std::vector<double>& a, const std::vector<double>& b);
+
+	pipeline::Value<LinearConstraints>      _constraints;
 	pipeline::Value<Features>               _features;
-	pipeline::Value<std::vector<double> >   _groundTruth;
+	pipeline::Value<Labeling>               _groundTruth;
 	pipeline::Value<LinearSolverParameters> _parameters;
 	pipeline::Value<LinearObjective>        _objective;
 	pipeline::Process<LinearSolver>         _solver;
@@ -71,6 +172,46 @@ private:
 	// combined features of the ground truth and current y*
 	std::vector<double> _d;
 	std::vector<double> _e;
+
+	// the current y*, converted from the solution of the ILP
+	Labeling _y;
+
+	// the closed-form solver for the constraints, created on first use
+	bool                                _forceIlp;
+	boost::scoped_ptr<ClosedFormSolver> _closedForm;
+	std::vector<char>                   _closedFormSolution;
+
+	// the linear relaxation of the ILP, created on first use and
+	// warm-started from its previous basis
+	bool                           _relaxFirst;
+	boost::scoped_ptr<DualSimplex> _relaxation;
+	std::vector<double>            _relaxedCosts;
+
+	unsigned int _numSolvedInClosedForm;
+	unsigned int _numSolvedByRelaxation;
+	unsigned int _numSolvedByIlp;
+
+	// the y* _e was computed for, the components of y* that changed since,
+	// and how often _e was updated since it was computed from scratch
+	Labeling                  _previousY;
+	std::vector<unsigned int> _changed;
+	std::vector<double>       _weights;
+	unsigned int              _recomputeInterval;
+	unsigned int              _numUpdates;
+
+	// the y* of the most recently returned gradient
+	Labeling _lastY;
+
+	// the cached hyperplanes <w,φ(x')(y' - y_k)> + b_k, given by their
+	// labelings y_k and offsets b_k
+	unsigned int          _maxCached;
+	unsigned int          _numCached;
+	std::vector<double>   _cachedB;
+	std::vector<Labeling> _cachedY;
+
+	// the evaluation in which each cached hyperplane was last the best one
+	std::vector<unsigned int> _cacheLastUsed;
+	unsigned int              _numEvaluations;
 };
 
 #endif // SBMRM_LOSS_SOFT_MARGIN_H__
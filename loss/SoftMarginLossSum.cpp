@@ -0,0 +1,334 @@
+#include <limits>
+
+#include <boost/bind/bind.hpp>
+#include <boost/thread.hpp>
+
+#include <util/Logger.h>
+#include "SoftMarginLossSum.h"
+
+logger::LogChannel softmarginlosssumlog("softmarginlosssumlog", "[SoftMarginLossSum] ");
+
+SoftMarginLossSum::SoftMarginLossSum(unsigned int numThreads) :
+	_numThreads(numThreads),
+	_round(0),
+	_nextSample(0),
+	_numBusy(0),
+	_stop(false) {
+
+	if (_numThreads == 0)
+		_numThreads = std::max(1u, boost::thread::hardware_concurrency());
+}
+
+SoftMarginLossSum::~SoftMarginLossSum() {
+
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+		_stop = true;
+	}
+
+	_wakeUp.notify_all();
+	_workers.join_all();
+}
+
+void
+SoftMarginLossSum::addSample(boost::shared_ptr<SoftMarginLoss> loss) {
+
+	_samples.push_back(loss);
+}
+
+void
+SoftMarginLossSum::valueAndGradient(const std::vector<double>& w, double& value, std::vector<double>& gradient) {
+
+	double upperBound;
+
+	inexactValueAndGradient(w, 0.0, value, upperBound, gradient);
+}
+
+void
+SoftMarginLossSum::valuesAndGradients(const std::vector<double>& w, std::vector<double>& values, std::vector<std::vector<double> >& gradients) {
+
+	std::vector<double> upperBounds;
+
+	inexactValuesAndGradients(w, 0.0, values, upperBounds, gradients);
+}
+
+void
+SoftMarginLossSum::inexactValueAndGradient(
+		const std::vector<double>& w,
+		double                     tolerance,
+		double&                    value,
+		double&                    upperBound,
+		std::vector<double>&       gradient) {
+
+	Request request;
+	request.tolerance = tolerance/std::max(1u, numSamples());
+
+	evaluate(w, request);
+
+	gradient.resize(w.size());
+	reduce(value, upperBound, gradient);
+}
+
+void
+SoftMarginLossSum::inexactValuesAndGradients(
+		const std::vector<double>&         w,
+		double                             tolerance,
+		std::vector<double>&               values,
+		std::vector<double>&               upperBounds,
+		std::vector<std::vector<double> >& gradients) {
+
+	values.resize(numSamples());
+	upperBounds.resize(numSamples());
+	gradients.resize(numSamples());
+
+	Request request;
+	request.tolerance   = tolerance/std::max(1u, numSamples());
+	request.values      = &values;
+	request.upperBounds = &upperBounds;
+	request.gradients   = &gradients;
+
+	evaluate(w, request);
+}
+
+bool
+SoftMarginLossSum::approximateValueAndGradient(const std::vector<double>& w, double& value, std::vector<double>& gradient) {
+
+	Request request;
+	request.approximate = true;
+
+	if (!evaluate(w, request))
+		return false;
+
+	double upperBound;
+
+	gradient.resize(w.size());
+	reduce(value, upperBound, gradient);
+
+	return true;
+}
+
+bool
+SoftMarginLossSum::approximateValuesAndGradients(const std::vector<double>& w, std::vector<double>& values, std::vector<std::vector<double> >& gradients) {
+
+	std::vector<double> upperBounds(numSamples());
+
+	values.resize(numSamples());
+	gradients.resize(numSamples());
+
+	Request request;
+	request.approximate = true;
+	request.values      = &values;
+	request.upperBounds = &upperBounds;
+	request.gradients   = &gradients;
+
+	return evaluate(w, request);
+}
+
+bool
+SoftMarginLossSum::evaluate(const std::vector<double>& w, const Request& request) {
+
+	unsigned int numWorkers = std::min(_numThreads, numSamples());
+
+	LOG_DEBUG(softmarginlosssumlog)
+			<< (request.approximate ? "approximating " : "evaluating ") << numSamples() << " samples with "
+			<< numWorkers << " threads" << std::endl;
+
+	// workers that get no sample contribute 0
+	_values.assign(numWorkers, 0.0);
+	_upperBounds.assign(numWorkers, 0.0);
+	_gradients.assign(numWorkers, std::vector<double>(w.size(), 0.0));
+	_numMissing.assign(numWorkers, 0);
+
+	run(boost::bind(&SoftMarginLossSum::evaluateSample, this, _1, _2, boost::cref(w), boost::cref(request)));
+
+	unsigned int numMissing = 0;
+	for (unsigned int k = 0; k < numWorkers; k++)
+		numMissing += _numMissing[k];
+
+	return (numMissing == 0);
+}
+
+void
+SoftMarginLossSum::getGradientCoefficients(
+		const std::vector<double>&         a,
+		const std::vector<bool>&           needed,
+		std::vector<double>&               offsets,
+		std::vector<std::vector<double> >& coefficients) {
+
+	offsets.resize(numSamples());
+	coefficients.resize(numSamples());
+
+	run(
+			boost::bind(
+					&SoftMarginLossSum::getGradientCoefficientsOfSample,
+					this, _2, boost::cref(a), boost::cref(needed), boost::ref(offsets), boost::ref(coefficients)));
+}
+
+void
+SoftMarginLossSum::run(boost::function<void(unsigned int, unsigned int)> task) {
+
+	unsigned int numWorkers = std::min(_numThreads, numSamples());
+
+	if (numWorkers == 0)
+		return;
+
+	// share the CPUs between the samples that are solved concurrently
+	unsigned int solverThreads = (numWorkers > 1 ? std::max(1u, boost::thread::hardware_concurrency()/numWorkers) : 0);
+	for (unsigned int s = 0; s < numSamples(); s++)
+		_samples[s]->setMaxSolverThreads(solverThreads);
+
+	_exceptions.assign(numWorkers, boost::exception_ptr());
+
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+
+		// start the missing worker threads, they wait for the next round
+		while (_workers.size() + 1 < numWorkers)
+			_workers.create_thread(boost::bind(&SoftMarginLossSum::waitForTasks, this, _workers.size() + 1, _round));
+
+		_task       = task;
+		_nextSample = 0;
+		_numBusy    = _workers.size();
+		_round++;
+	}
+
+	_wakeUp.notify_all();
+
+	// the calling thread is worker 0
+	work(0);
+
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+
+		while (_numBusy > 0)
+			_done.wait(lock);
+	}
+
+	for (unsigned int k = 0; k < numWorkers; k++)
+		if (_exceptions[k])
+			boost::rethrow_exception(_exceptions[k]);
+}
+
+void
+SoftMarginLossSum::waitForTasks(unsigned int worker, unsigned int round) {
+
+	while (true) {
+
+		{
+			boost::mutex::scoped_lock lock(_mutex);
+
+			while (!_stop && _round == round)
+				_wakeUp.wait(lock);
+
+			if (_stop)
+				return;
+
+			round = _round;
+		}
+
+		work(worker);
+
+		{
+			boost::mutex::scoped_lock lock(_mutex);
+
+			if (--_numBusy == 0)
+				_done.notify_all();
+		}
+	}
+}
+
+void
+SoftMarginLossSum::work(unsigned int worker) {
+
+	while (true) {
+
+		unsigned int s;
+
+		{
+			boost::mutex::scoped_lock lock(_mutex);
+
+			if (_nextSample == numSamples())
+				return;
+
+			s = _nextSample++;
+		}
+
+		try {
+
+			_task(worker, s);
+
+		} catch (...) {
+
+			_exceptions[worker] = boost::current_exception();
+		}
+	}
+}
+
+void
+SoftMarginLossSum::reduce(double& value, double& upperBound, std::vector<double>& gradient) {
+
+	// reduce in a fixed order; which samples are in the partial sums of
+	// each worker varies between calls, the result can therefore differ in
+	// the last digits
+	value      = 0;
+	upperBound = 0;
+	std::fill(gradient.begin(), gradient.end(), 0.0);
+	for (unsigned int k = 0; k < _values.size(); k++) {
+
+		value      += _values[k];
+		upperBound += _upperBounds[k];
+		for (unsigned int i = 0; i < gradient.size(); i++)
+			gradient[i] += _gradients[k][i];
+	}
+}
+
+void
+SoftMarginLossSum::evaluateSample(unsigned int worker, unsigned int s, const std::vector<double>& w, const Request& request) {
+
+	double              value;
+	double              upperBound;
+	std::vector<double> gradient(w.size());
+
+	if (request.approximate) {
+
+		if (!_samples[s]->approximateValueAndGradient(w, value, gradient)) {
+
+			_numMissing[worker]++;
+			return;
+		}
+
+		// there is no upper bound without solving the ILP
+		upperBound = std::numeric_limits<double>::infinity();
+
+	} else {
+
+		_samples[s]->inexactValueAndGradient(w, request.tolerance, value, upperBound, gradient);
+	}
+
+	// each sample is written by exactly one worker
+	if (request.values) {
+
+		(*request.values)[s]      = value;
+		(*request.upperBounds)[s] = upperBound;
+		(*request.gradients)[s]   = gradient;
+		return;
+	}
+
+	_values[worker]      += value;
+	_upperBounds[worker] += upperBound;
+	for (unsigned int i = 0; i < gradient.size(); i++)
+		_gradients[worker][i] += gradient[i];
+}
+
+void
+SoftMarginLossSum::getGradientCoefficientsOfSample(
+		unsigned int                       s,
+		const std::vector<double>&         a,
+		const std::vector<bool>&           needed,
+		std::vector<double>&               offsets,
+		std::vector<std::vector<double> >& coefficients) {
+
+	// each sample is written by exactly one worker
+	if (needed[s])
+		_samples[s]->getGradientCoefficients(a, offsets[s], coefficients[s]);
+}
@@ -0,0 +1,202 @@
+#ifndef SBMRM_LOSS_SOFT_MARGIN_LOSS_SUM_H__
+#define SBMRM_LOSS_SOFT_MARGIN_LOSS_SUM_H__
+
+#include <vector>
+
+#include <boost/exception_ptr.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include "SoftMarginLoss.h"
+
+/**
+ * The sum of the soft margin losses of several independent training samples,
+ *
+ *   L(w) = Σ_s L_s(w).
+ *
+ * The samples are evaluated concurrently by a pool of worker threads, which
+ * is started with the first evaluation and kept for all further ones. Idle
+ * workers take the next sample that was not evaluated yet. Each sample keeps
+ * its own LinearSolver backend, which is used by one worker at a time and
+ * limited to an equal share of the CPUs (see
+ * SoftMarginLoss::setMaxSolverThreads()).
+ */
+class SoftMarginLossSum {
+
+public:
+
+	/**
+	 * Create an empty sum of soft margin losses.
+	 *
+	 * @param numThreads
+	 *             The number of threads to use for the evaluation of the
+	 *             samples. 0 uses all available CPUs.
+	 */
+	SoftMarginLossSum(unsigned int numThreads = 0);
+
+	/**
+	 * Stops the worker threads.
+	 */
+	~SoftMarginLossSum();
+
+	/**
+	 * Add the loss of a training sample.
+	 */
+	void addSample(boost::shared_ptr<SoftMarginLoss> loss);
+
+	/**
+	 * The number of training samples.
+	 */
+	unsigned int numSamples() const { return _samples.size(); }
+
+	/**
+	 * The loss of training sample s.
+	 */
+	SoftMarginLoss& getSample(unsigned int s) { return *_samples[s]; }
+
+	/**
+	 * Computes the value and gradient of L(w).
+	 */
+	void valueAndGradient(const std::vector<double>& w, double& value, std::vector<double>& gradient);
+
+	/**
+	 * Computes the values and gradients of each L_s(w) individually.
+	 */
+	void valuesAndGradients(const std::vector<double>& w, std::vector<double>& values, std::vector<std::vector<double> >& gradients);
+
+	/**
+	 * Computes a hyperplane that bounds L(w) from below and is at most
+	 * tolerance below L(w) at w, and an upper bound on L(w). The tolerance is
+	 * split evenly between the samples.
+	 */
+	void inexactValueAndGradient(
+			const std::vector<double>& w,
+			double                     tolerance,
+			double&                    value,
+			double&                    upperBound,
+			std::vector<double>&       gradient);
+
+	/**
+	 * Same as above, for each L_s(w) individually. The values of all samples
+	 * together are at most tolerance below L(w).
+	 */
+	void inexactValuesAndGradients(
+			const std::vector<double>&         w,
+			double                             tolerance,
+			std::vector<double>&               values,
+			std::vector<double>&               upperBounds,
+			std::vector<std::vector<double> >& gradients);
+
+	/**
+	 * Computes a lower bound on L(w) and its gradient from the cached
+	 * hyperplanes of each sample, without solving any ILP.
+	 *
+	 * @return false, if the cache of any sample is empty.
+	 */
+	bool approximateValueAndGradient(const std::vector<double>& w, double& value, std::vector<double>& gradient);
+
+	/**
+	 * Computes lower bounds on each L_s(w) and their gradients from the
+	 * cached hyperplanes of each sample, without solving any ILP.
+	 *
+	 * @return false, if the cache of any sample is empty.
+	 */
+	bool approximateValuesAndGradients(const std::vector<double>& w, std::vector<double>& values, std::vector<std::vector<double> >& gradients);
+
+	/**
+	 * Calls SoftMarginLoss::getGradientCoefficients() of each sample s with
+	 * needed[s], concurrently on the same threads as the evaluation.
+	 */
+	void getGradientCoefficients(
+			const std::vector<double>&         a,
+			const std::vector<bool>&           needed,
+			std::vector<double>&               offsets,
+			std::vector<std::vector<double> >& coefficients);
+
+private:
+
+	// what to compute for each sample and where to store it
+	struct Request {
+
+		Request() :
+			tolerance(0),
+			approximate(false),
+			values(0),
+			upperBounds(0),
+			gradients(0) {}
+
+		// the tolerance per sample
+		double tolerance;
+
+		// use the cached hyperplanes instead of solving the ILP
+		bool approximate;
+
+		// if given, store the individual results here instead of summing
+		// them
+		std::vector<double>*               values;
+		std::vector<double>*               upperBounds;
+		std::vector<std::vector<double> >* gradients;
+	};
+
+	// evaluate all samples concurrently, returns false if an approximation
+	// was not possible for all samples
+	bool evaluate(const std::vector<double>& w, const Request& request);
+
+	// evaluate sample s on the given worker
+	void evaluateSample(unsigned int worker, unsigned int s, const std::vector<double>& w, const Request& request);
+
+	// get the gradient coefficients of sample s, if needed
+	void getGradientCoefficientsOfSample(
+			unsigned int                       s,
+			const std::vector<double>&         a,
+			const std::vector<bool>&           needed,
+			std::vector<double>&               offsets,
+			std::vector<std::vector<double> >& coefficients);
+
+	// call task(worker, s) for each sample s on the worker threads and the
+	// calling thread (worker 0)
+	void run(boost::function<void(unsigned int, unsigned int)> task);
+
+	// the main loop of the worker threads
+	void waitForTasks(unsigned int worker, unsigned int round);
+
+	// process samples with the current task until none is left
+	void work(unsigned int worker);
+
+	// sum the partial values and gradients of the workers
+	void reduce(double& value, double& upperBound, std::vector<double>& gradient);
+
+	std::vector<boost::shared_ptr<SoftMarginLoss> > _samples;
+
+	unsigned int _numThreads;
+
+	// the worker threads (without the calling thread)
+	boost::thread_group _workers;
+
+	// the current task, the number of calls to run() so far, the next sample
+	// to process, and the number of worker threads still busy with the
+	// current task
+	boost::function<void(unsigned int, unsigned int)> _task;
+	unsigned int                                      _round;
+	unsigned int                                      _nextSample;
+	unsigned int                                      _numBusy;
+	bool                                              _stop;
+
+	boost::mutex              _mutex;
+	boost::condition_variable _wakeUp;
+	boost::condition_variable _done;
+
+	// the partial values, upper bounds, and gradients of each worker, and
+	// the last exception of each worker
+	std::vector<double>                _values;
+	std::vector<double>                _upperBounds;
+	std::vector<std::vector<double> >  _gradients;
+	std::vector<boost::exception_ptr>  _exceptions;
+
+	// the number of samples without approximation per worker
+	std::vector<unsigned int>          _numMissing;
+};
+
+#endif // SBMRM_LOSS_SOFT_MARGIN_LOSS_SUM_H__
+
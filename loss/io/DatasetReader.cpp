@@ -0,0 +1,99 @@
+#include <fstream>
+#include <sstream>
+
+#include <boost/lexical_cast.hpp>
+
+#include <io/BinaryDataset.h>
+#include <util/Logger.h>
+#include <util/files.h>
+#include "DatasetReader.h"
+
+logger::LogChannel datasetreaderlog("datasetreaderlog", "[DatasetReader] ");
+
+DatasetReader::DatasetReader(std::string filename) {
+
+	if (BinaryDataset::isBinaryDataset(filename)) {
+
+		_samples.push_back(binarySample(filename));
+		return;
+	}
+
+	size_t slash = filename.find_last_of('/');
+	if (slash != std::string::npos)
+		_directory = filename.substr(0, slash + 1);
+
+	std::ifstream in(filename.c_str());
+
+	if (!in.good())
+		BOOST_THROW_EXCEPTION(DatasetError() << error_message("could not open " + filename));
+
+	unsigned int lineNumber = 0;
+
+	while (!in.eof() && in.good()) {
+
+		std::string line = readline(in);
+		lineNumber++;
+
+		// strip comments
+		line = line.substr(0, line.find('#'));
+
+		std::istringstream tokens(line);
+		std::vector<std::string> paths;
+		std::string path;
+		while (tokens >> path)
+			paths.push_back(resolve(path));
+
+		if (paths.size() == 0)
+			continue;
+
+		if (paths.size() == 1 && BinaryDataset::isBinaryDataset(paths[0])) {
+
+			_samples.push_back(binarySample(paths[0]));
+			continue;
+		}
+
+		if (paths.size() < 3 || paths.size() > 4)
+			BOOST_THROW_EXCEPTION(
+					DatasetError() <<
+							error_message(
+									filename + ", line " + boost::lexical_cast<std::string>(lineNumber) +
+									": expected <labels> <features> <constraints> [<linear costs>] or <binary dataset>"));
+
+		SampleFiles sample;
+		sample.labels      = paths[0];
+		sample.features    = paths[1];
+		sample.constraints = paths[2];
+		if (paths.size() == 4)
+			sample.linearCosts = paths[3];
+
+		_samples.push_back(sample);
+	}
+
+	if (_samples.empty())
+		BOOST_THROW_EXCEPTION(DatasetError() << error_message(filename + " does not list any samples"));
+
+	LOG_DEBUG(datasetreaderlog) << "found " << _samples.size() << " samples in " << filename << std::endl;
+}
+
+SampleFiles
+DatasetReader::binarySample(const std::string& path) {
+
+	SampleFiles sample;
+	sample.labels      = path;
+	sample.features    = path;
+	sample.constraints = path;
+
+	if (BinaryDataset(path).has(BinaryDataset::CostCoefficients))
+		sample.linearCosts = path;
+
+	return sample;
+}
+
+std::string
+DatasetReader::resolve(const std::string& path) {
+
+	if (path[0] == '/')
+		return path;
+
+	return _directory + path;
+}
@@ -0,0 +1,59 @@
+#ifndef SBMRM_LOSS_IO_DATASET_READER_H__
+#define SBMRM_LOSS_IO_DATASET_READER_H__
+
+#include <string>
+#include <vector>
+
+#include <util/exceptions.h>
+
+struct DatasetError : virtual IOError {};
+
+/**
+ * The files describing a single training sample.
+ */
+struct SampleFiles {
+
+	std::string labels;
+	std::string features;
+	std::string constraints;
+
+	// optional, Hamming costs are used if empty
+	std::string linearCosts;
+};
+
+/**
+ * Reads a dataset manifest, which lists the files of one training sample per
+ * line:
+ *
+ *   <labels> <features> <constraints> [<linear costs>]
+ *
+ * or a single BinaryDataset per line, which contains all of them. Relative
+ * paths are interpreted relative to the directory of the manifest.
+ * Everything after a '#' is ignored.
+ *
+ * The manifest itself can also be a BinaryDataset, for a single training
+ * sample. Throws a DatasetError if the manifest can not be read, a line is
+ * malformed, or no sample is listed.
+ */
+class DatasetReader {
+
+public:
+
+	DatasetReader(std::string filename);
+
+	const std::vector<SampleFiles>& getSampleFiles() const { return _samples; }
+
+private:
+
+	std::string resolve(const std::string& path);
+
+	// the files of a sample stored in a binary dataset
+	SampleFiles binarySample(const std::string& path);
+
+	std::string _directory;
+
+	std::vector<SampleFiles> _samples;
+};
+
+#endif // SBMRM_LOSS_IO_DATASET_READER_H__
+
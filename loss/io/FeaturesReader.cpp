@@ -1,15 +1,15 @@
-#include <fstream>
+#include <boost/bind/bind.hpp>
 
 #include <util/Logger.h>
-#include <util/files.h>
 #include <util/helpers.hpp>
 #include "FeaturesReader.h"
 
 logger::LogChannel featuresreaderlog("featuresreaderlog", "[FeaturesReader] ");
 
-FeaturesReader::FeaturesReader(std::string filename, bool normalize) :
+FeaturesReader::FeaturesReader(std::string filename, bool normalize, unsigned int numThreads) :
 	_filename(filename),
-	_normalize(normalize) {
+	_normalize(normalize),
+	_numThreads(numThreads) {
 
 	registerOutput(_features, "features");
 }
@@ -17,49 +17,178 @@ FeaturesReader::FeaturesReader(std::string filename, bool normalize) :
 void
 FeaturesReader::updateOutputs() {
 
-	std::string number = "0123456789.eE-+";
+	read(*_features);
+}
+
+void
+FeaturesReader::read(Features& features) {
+
+	if (BinaryDataset::isBinaryDataset(_filename)) {
 
-	std::ifstream in(_filename.c_str());
+		features.map(BinaryDataset(_filename));
+
+		LOG_DEBUG(featuresreaderlog)
+				<< "mapped " << features.numFeatureVectors() << " feature vectors with "
+				<< features.numFeatures() << " features" << std::endl;
+
+	} else {
+
+		readText(features);
+	}
 
-	_features->clear();
+	if (_normalize) {
+
+		LOG_DEBUG(featuresreaderlog) << "normalizing features" << std::endl;
+		features.normalize();
+	}
+}
+
+void
+FeaturesReader::readText(Features& features) {
 
-	while (!in.eof() && in.good()) {
+	features.clear();
 
-		std::string line = readline(in);
+	TextFileReader         reader(_filename, _numThreads);
+	std::vector<TextChunk> chunks;
 
-		LOG_ALL(featuresreaderlog) << "reading line: " << line << std::endl;
+	// the format is given by the first feature vector
+	bool formatKnown = false;
+	bool sparse      = false;
 
-		if (line != "") {
+	while (reader.readBlock(chunks)) {
 
-			std::vector<double> f;
+		std::vector<ChunkFeatures> chunkFeatures(chunks.size());
 
-			size_t i = line.find_first_of(number);
-			size_t end = line.find('#');
+		TextFileReader::parseChunks(
+				chunks,
+				boost::bind(&FeaturesReader::parseChunk, this, _1, _2, boost::ref(chunkFeatures)));
 
-			LOG_ALL(featuresreaderlog) << "end of line is at " << end << std::endl;
-			LOG_ALL(featuresreaderlog) << "first number is at " << i << std::endl;
+		// append in the order of the file
+		for (unsigned int k = 0; k < chunkFeatures.size(); k++) {
 
-			while (i < end) {
+			const Features& chunk = chunkFeatures[k].features;
 
-				size_t j = line.find_first_not_of(number, i);
-				LOG_ALL(featuresreaderlog) << "number stops at " << j << std::endl;
-				f.push_back(boost::lexical_cast<double>(line.substr(i, j - i)));
+			if (chunk.numFeatureVectors() == 0)
+				continue;
 
-				i = line.find_first_of(number, j);
+			if (!formatKnown) {
 
-				LOG_ALL(featuresreaderlog) << "next number is at " << i << std::endl;
+				sparse      = chunk.isSparse();
+				formatKnown = true;
+
+				LOG_DEBUG(featuresreaderlog) << "reading " << (sparse ? "sparse" : "dense") << " features" << std::endl;
+
+			} else if (chunk.isSparse() != sparse) {
+
+				error(chunkFeatures[k].firstLine, "mix of dense and sparse feature vectors");
 			}
 
-			LOG_ALL(featuresreaderlog) << "adding feature vector " << f << std::endl;
+			if (!sparse && chunk.numFeatures() != features.numFeatures() && features.numFeatureVectors() > 0)
+				error(
+						chunkFeatures[k].firstLine,
+						"expected " + boost::lexical_cast<std::string>(features.numFeatures()) +
+						" features, got " + boost::lexical_cast<std::string>(chunk.numFeatures()));
 
-			if (f.size() > 0)
-				_features->addFeatureVector(f);
+			features.append(chunk);
 		}
 	}
 
-	if (_normalize) {
+	LOG_DEBUG(featuresreaderlog)
+			<< "read " << features.numFeatureVectors() << " feature vectors with "
+			<< features.numFeatures() << " features" << std::endl;
+}
 
-		LOG_DEBUG(featuresreaderlog) << "normalizing features" << std::endl;
-		_features->normalize();
+void
+FeaturesReader::parseChunk(const TextChunk& chunk, unsigned int k, std::vector<ChunkFeatures>& chunkFeatures) {
+
+	TextTokenizer tokenizer(chunk);
+
+	Features& features = chunkFeatures[k].features;
+
+	// buffers for the current feature vector, reused for every line
+	std::vector<double>       f;
+	std::vector<unsigned int> indices;
+	std::vector<double>       values;
+
+	while (tokenizer.nextLine()) {
+
+		if (!tokenizer.hasMore())
+			continue;
+
+		bool sparseLine = tokenizer.contains(":");
+
+		if (features.numFeatureVectors() == 0)
+			chunkFeatures[k].firstLine = tokenizer.getLineNumber();
+		else if (sparseLine != features.isSparse())
+			error(tokenizer.getLineNumber(), "mix of dense and sparse feature vectors");
+
+		if (sparseLine)
+			readSparseFeatureVector(tokenizer, indices, values, features);
+		else
+			readDenseFeatureVector(tokenizer, f, features);
+	}
+}
+
+void
+FeaturesReader::readDenseFeatureVector(TextTokenizer& tokenizer, std::vector<double>& f, Features& features) {
+
+	f.clear();
+
+	// numbers can be separated by anything but other numbers
+	while (tokenizer.skipToNumber()) {
+
+		double value;
+		if (!tokenizer.readDouble(value))
+			error(tokenizer.getLineNumber(), "expected a number, got '" + tokenizer.getToken() + "'");
+
+		f.push_back(value);
+	}
+
+	if (f.size() == 0)
+		return;
+
+	if (features.numFeatureVectors() > 0 && f.size() != features.numFeatures())
+		error(
+				tokenizer.getLineNumber(),
+				"expected " + boost::lexical_cast<std::string>(features.numFeatures()) +
+				" features, got " + boost::lexical_cast<std::string>(f.size()));
+
+	features.addFeatureVector(f);
+}
+
+void
+FeaturesReader::readSparseFeatureVector(
+		TextTokenizer&             tokenizer,
+		std::vector<unsigned int>& indices,
+		std::vector<double>&       values,
+		Features&                  features) {
+
+	indices.clear();
+	values.clear();
+
+	while (tokenizer.hasMore()) {
+
+		unsigned int index;
+		double       value;
+
+		if (!tokenizer.readUnsigned(index) || !tokenizer.accept(':') || !tokenizer.readDouble(value))
+			error(tokenizer.getLineNumber(), "expected <index>:<value>, got '" + tokenizer.getToken() + "'");
+
+		if (!indices.empty() && index <= indices.back())
+			error(tokenizer.getLineNumber(), "indices are not strictly increasing at index " + boost::lexical_cast<std::string>(index));
+
+		indices.push_back(index);
+		values.push_back(value);
 	}
+
+	features.addSparseFeatureVector(indices, values);
 }
+
+void
+FeaturesReader::error(unsigned int lineNumber, const std::string& message) {
+
+	BOOST_THROW_EXCEPTION(
+			FeaturesError() <<
+					error_message(_filename + ", line " + boost::lexical_cast<std::string>(lineNumber) + ": " + message));
+}
+
@@ -2,8 +2,28 @@
 #define SBMRM_LOSS_IO_FEATURES_READER_H__
 
 #include <pipeline/SimpleProcessNode.h>
+#include <io/BinaryDataset.h>
+#include <io/TextFileReader.h>
+#include <io/TextTokenizer.h>
 #include <loss/Features.h>
 
+/**
+ * Reads features from a file with one feature vector per line, either dense
+ *
+ *   <value> <value> ...
+ *
+ * or sparse
+ *
+ *   <index>:<value> <index>:<value> ...
+ *
+ * with indices starting at 0 in increasing order, as in the format of
+ * libsvm (without the label). The format is determined by the first feature
+ * vector. A sparse feature vector without non-zeros can be written as 0:0.
+ *
+ * Large files are split into chunks of lines that are parsed concurrently
+ * (see TextFileReader). The file can also be a BinaryDataset, in which case
+ * the features are a view on the mapped file.
+ */
 class FeaturesReader : public pipeline::SimpleProcessNode<> {
 
 public:
@@ -17,18 +37,55 @@ public:
 	 *              Normalize the features after reading, such that their 
 	 *              absolute values are in the range [0,1]. If you do that, make 
 	 *              sure to denormalize the learnt weights accordingly.
+	 * @param numThreads
+	 *              The number of threads to parse the file with. 0 uses the
+	 *              value of --io.numThreads.
 	 */
-	FeaturesReader(std::string filename, bool normalize = false);
+	FeaturesReader(std::string filename, bool normalize = false, unsigned int numThreads = 0);
+
+	/**
+	 * Read the features directly, without the pipeline.
+	 */
+	void read(Features& features);
 
 private:
 
+	// the features of a chunk of the file
+	struct ChunkFeatures {
+
+		ChunkFeatures() : firstLine(0) {}
+
+		Features features;
+
+		// the line of the first feature vector in the chunk
+		unsigned int firstLine;
+	};
+
 	void updateOutputs();
 
+	void readText(Features& features);
+
+	// parse the kth chunk of a block into chunkFeatures[k]
+	void parseChunk(const TextChunk& chunk, unsigned int k, std::vector<ChunkFeatures>& chunkFeatures);
+
+	void readDenseFeatureVector(TextTokenizer& tokenizer, std::vector<double>& f, Features& features);
+
+	void readSparseFeatureVector(
+			TextTokenizer&             tokenizer,
+			std::vector<unsigned int>& indices,
+			std::vector<double>&       values,
+			Features&                  features);
+
+	// throw a FeaturesError for the given line
+	void error(unsigned int lineNumber, const std::string& message);
+
 	pipeline::Output<Features> _features;
 
 	std::string _filename;
 
 	bool _normalize;
+
+	unsigned int _numThreads;
 };
 
 #endif // SBMRM_LOSS_IO_FEATURES_READER_H__
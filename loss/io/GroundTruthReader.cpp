@@ -1,10 +1,12 @@
-#include <fstream>
+#include <boost/bind/bind.hpp>
 
-#include <util/files.h>
+#include <io/BinaryDataset.h>
+#include <io/TextTokenizer.h>
 #include "GroundTruthReader.h"
 
-GroundTruthReader::GroundTruthReader(std::string filename) :
-	_filename(filename) {
+GroundTruthReader::GroundTruthReader(std::string filename, unsigned int numThreads) :
+	_filename(filename),
+	_numThreads(numThreads) {
 
 	registerOutput(_groundTruth, "ground truth");
 }
@@ -12,30 +14,64 @@ GroundTruthReader::GroundTruthReader(std::string filename) :
 void
 GroundTruthReader::updateOutputs() {
 
-	std::string number = "0123456789.eE-+";
+	read(*_groundTruth);
+}
+
+void
+GroundTruthReader::read(Labeling& groundTruth) {
+
+	if (BinaryDataset::isBinaryDataset(_filename)) {
+
+		groundTruth.read(BinaryDataset(_filename));
+		return;
+	}
+
+	groundTruth.clear();
 
-	std::ifstream in(_filename.c_str());
+	TextFileReader         reader(_filename, _numThreads);
+	std::vector<TextChunk> chunks;
 
-	_groundTruth->clear();
+	while (reader.readBlock(chunks)) {
 
-	while (!in.eof() && in.good()) {
+		std::vector<Labeling> labelings(chunks.size());
 
-		std::string line = readline(in);
+		TextFileReader::parseChunks(
+				chunks,
+				boost::bind(&GroundTruthReader::parseChunk, this, _1, _2, boost::ref(labelings)));
 
-		if (line != "") {
+		for (unsigned int k = 0; k < labelings.size(); k++)
+			for (unsigned int i = 0; i < labelings[k].size(); i++)
+				groundTruth.push_back(labelings[k][i]);
+	}
+}
+
+void
+GroundTruthReader::parseChunk(const TextChunk& chunk, unsigned int k, std::vector<Labeling>& labelings) {
 
-			std::vector<double> f;
+	TextTokenizer tokenizer(chunk);
 
-			size_t i = line.find_first_of(number);
-			size_t end = line.find('#');
+	while (tokenizer.nextLine()) {
 
-			while (i < end) {
+		while (tokenizer.skipToNumber()) {
 
-				size_t j = line.find_first_not_of(number, i);
-				_groundTruth->push_back(boost::lexical_cast<double>(line.substr(i, j - i)));
+			double label;
 
-				i = line.find_first_of(number, j);
-			}
+			if (!tokenizer.readDouble(label))
+				BOOST_THROW_EXCEPTION(
+						LabelingError() <<
+								error_message(
+										_filename + ", line " + boost::lexical_cast<std::string>(tokenizer.getLineNumber()) +
+										": labels have to be 0 or 1, got " + tokenizer.getToken()));
+
+			if (label != 0 && label != 1)
+				BOOST_THROW_EXCEPTION(
+						LabelingError() <<
+								error_message(
+										_filename + ", line " + boost::lexical_cast<std::string>(tokenizer.getLineNumber()) +
+										": labels have to be 0 or 1, got " + boost::lexical_cast<std::string>(label)));
+
+			labelings[k].push_back(label == 1);
 		}
 	}
 }
+
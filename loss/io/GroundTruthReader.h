@@ -2,20 +2,45 @@
 #define SBMRM_LOSS_IO_GROUND_TRUTH_READER_H__
 
 #include <pipeline/SimpleProcessNode.h>
+#include <io/TextFileReader.h>
+#include <loss/Labeling.h>
 
+/**
+ * Reads a binary ground truth labeling, one or more labels (0 or 1) per line,
+ * or from a BinaryDataset.
+ */
 class GroundTruthReader : public pipeline::SimpleProcessNode<> {
 
 public:
 
-	GroundTruthReader(std::string filename);
+	/**
+	 * Create a ground truth reader.
+	 *
+	 * @param filename
+	 *              The file to read the labeling from.
+	 * @param numThreads
+	 *              The number of threads to parse the file with. 0 uses the
+	 *              value of --io.numThreads.
+	 */
+	GroundTruthReader(std::string filename, unsigned int numThreads = 0);
+
+	/**
+	 * Read the labeling directly, without the pipeline.
+	 */
+	void read(Labeling& groundTruth);
 
 private:
 
 	void updateOutputs();
 
-	pipeline::Output<std::vector<double> > _groundTruth;
+	// parse the kth chunk of a block into labelings[k]
+	void parseChunk(const TextChunk& chunk, unsigned int k, std::vector<Labeling>& labelings);
+
+	pipeline::Output<Labeling> _groundTruth;
 
 	std::string _filename;
+
+	unsigned int _numThreads;
 };
 
 #endif // SBMRM_LOSS_IO_GROUND_TRUTH_READER_H__
@@ -0,0 +1,183 @@
+#include <algorithm>
+
+#include <boost/bind/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/make_shared.hpp>
+
+#include <util/Logger.h>
+#include <util/ProgramOptions.h>
+#include <util/foreach.h>
+#include <inference/io/ConstraintsReader.h>
+#include <loss/FileLinearCostFunction.h>
+#include <loss/HammingCostFunction.h>
+#include "FeaturesReader.h"
+#include "GroundTruthReader.h"
+#include "SampleLoader.h"
+
+using namespace boost::placeholders;
+
+logger::LogChannel sampleloaderlog("sampleloaderlog", "[SampleLoader] ");
+
+util::ProgramOption optionIoNumFiles(
+		util::_module           = "io",
+		util::_long_name        = "numFiles",
+		util::_description_text = "The number of input files of a dataset to read at the same time. 0 reads as many files "
+		                          "at the same time as there are CPUs.",
+		util::_default_value    = 0);
+
+SampleLoader::SampleLoader(unsigned int numThreads) :
+	_numThreads(numThreads),
+	_nextTask(0) {
+
+	if (_numThreads == 0)
+		_numThreads = optionIoNumFiles.as<unsigned int>();
+
+	if (_numThreads == 0)
+		_numThreads = std::max(1u, boost::thread::hardware_concurrency());
+}
+
+std::vector<boost::shared_ptr<Sample> >
+SampleLoader::load(const std::vector<SampleFiles>& sampleFiles) {
+
+	size_t numFiles = 0;
+	foreach (const SampleFiles& files, sampleFiles)
+		numFiles += (files.linearCosts.empty() ? 3 : 4);
+
+	unsigned int numThreads = std::min<size_t>(_numThreads, numFiles);
+
+	// the files read at the same time share the threads to parse them
+	unsigned int numChunks = std::max(1u, TextFileReader::getNumThreads()/std::max(1u, numThreads));
+
+	std::vector<boost::shared_ptr<Sample> > samples;
+	std::vector<boost::function<void()> >  tasks;
+
+	foreach (const SampleFiles& files, sampleFiles) {
+
+		boost::shared_ptr<Sample> sample = boost::make_shared<Sample>();
+
+		tasks.push_back(boost::bind(&SampleLoader::readConstraints, files.constraints, numChunks, boost::ref(*sample->constraints)));
+		tasks.push_back(boost::bind(&SampleLoader::readFeatures, files.features, numChunks, boost::ref(*sample->features)));
+		tasks.push_back(boost::bind(&SampleLoader::readGroundTruth, files.labels, numChunks, boost::ref(*sample->groundTruth)));
+
+		if (!files.linearCosts.empty())
+			tasks.push_back(boost::bind(&SampleLoader::readLinearCosts, files.linearCosts, numChunks, boost::ref(sample->costs)));
+
+		samples.push_back(sample);
+	}
+
+	LOG_DEBUG(sampleloaderlog)
+			<< "reading " << tasks.size() << " files of " << samples.size()
+			<< " samples with " << numThreads << " threads and " << numChunks
+			<< " chunks per file" << std::endl;
+
+	std::vector<boost::exception_ptr> exceptions(tasks.size());
+
+	// the calling thread reads as well
+	_nextTask = 0;
+	boost::thread_group workers;
+	for (unsigned int i = 1; i < numThreads; i++)
+		workers.create_thread(boost::bind(&SampleLoader::work, this, boost::cref(tasks), boost::ref(exceptions)));
+	work(tasks, exceptions);
+	workers.join_all();
+
+	// report the errors in the order of the files
+	for (unsigned int i = 0; i < exceptions.size(); i++)
+		if (exceptions[i])
+			boost::rethrow_exception(exceptions[i]);
+
+	for (unsigned int s = 0; s < samples.size(); s++) {
+
+		if (!samples[s]->costs)
+			samples[s]->costs = boost::make_shared<HammingCostFunction>(*samples[s]->groundTruth);
+
+		check(sampleFiles[s], *samples[s]);
+	}
+
+	return samples;
+}
+
+void
+SampleLoader::work(
+		const std::vector<boost::function<void()> >& tasks,
+		std::vector<boost::exception_ptr>&           exceptions) {
+
+	while (true) {
+
+		unsigned int i;
+
+		{
+			boost::mutex::scoped_lock lock(_mutex);
+
+			if (_nextTask == tasks.size())
+				return;
+
+			i = _nextTask++;
+		}
+
+		try {
+
+			tasks[i]();
+
+		} catch (...) {
+
+			exceptions[i] = boost::current_exception();
+		}
+	}
+}
+
+void
+SampleLoader::readConstraints(const std::string& filename, unsigned int numChunks, LinearConstraints& constraints) {
+
+	ConstraintsReader(filename, numChunks).read(constraints);
+}
+
+void
+SampleLoader::readFeatures(const std::string& filename, unsigned int numChunks, Features& features) {
+
+	FeaturesReader(filename, false, numChunks).read(features);
+}
+
+void
+SampleLoader::readGroundTruth(const std::string& filename, unsigned int numChunks, Labeling& groundTruth) {
+
+	GroundTruthReader(filename, numChunks).read(groundTruth);
+}
+
+void
+SampleLoader::readLinearCosts(const std::string& filename, unsigned int numChunks, boost::shared_ptr<LinearCostFunction>& costs) {
+
+	costs = boost::make_shared<FileLinearCostFunction>(filename, numChunks);
+}
+
+void
+SampleLoader::check(const SampleFiles& files, Sample& sample) {
+
+	unsigned int size = sample.groundTruth->size();
+
+	if (sample.features->numFeatureVectors() != size)
+		BOOST_THROW_EXCEPTION(
+				SizeMismatchError() <<
+						error_message(
+								files.features + " has " +
+								boost::lexical_cast<std::string>(sample.features->numFeatureVectors()) +
+								" feature vectors, but " + files.labels + " has " +
+								boost::lexical_cast<std::string>(size) + " labels"));
+
+	if (sample.constraints->getNumVariables() > size)
+		BOOST_THROW_EXCEPTION(
+				SizeMismatchError() <<
+						error_message(
+								files.constraints + " uses variable " +
+								boost::lexical_cast<std::string>(sample.constraints->getNumVariables() - 1) +
+								", but " + files.labels + " has only " +
+								boost::lexical_cast<std::string>(size) + " labels"));
+
+	if (sample.costs->getCoefficients().size() != size)
+		BOOST_THROW_EXCEPTION(
+				SizeMismatchError() <<
+						error_message(
+								files.linearCosts + " has " +
+								boost::lexical_cast<std::string>(sample.costs->getCoefficients().size()) +
+								" coefficients, but " + files.labels + " has " +
+								boost::lexical_cast<std::string>(size) + " labels"));
+}
@@ -0,0 +1,84 @@
+#ifndef SBMRM_LOSS_IO_SAMPLE_LOADER_H__
+#define SBMRM_LOSS_IO_SAMPLE_LOADER_H__
+
+#include <string>
+#include <vector>
+
+#include <boost/exception_ptr.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include <pipeline/Value.h>
+#include <inference/LinearConstraints.h>
+#include <loss/Features.h>
+#include <loss/Labeling.h>
+#include <loss/LinearCostFunction.h>
+#include "DatasetReader.h"
+
+/**
+ * The data of a single training sample.
+ */
+struct Sample {
+
+	pipeline::Value<LinearConstraints>    constraints;
+	pipeline::Value<Features>             features;
+	pipeline::Value<Labeling>             groundTruth;
+
+	boost::shared_ptr<LinearCostFunction> costs;
+};
+
+/**
+ * Reads the files of training samples concurrently on a limited number of
+ * threads, such that loading takes about as long as the slowest file instead
+ * of the sum over all files. The files read at the same time get an equal
+ * share of the threads to parse files with (see TextFileReader). Once all
+ * files are read, the sizes of the labels, features, constraints and linear
+ * costs of each sample are checked against each other.
+ */
+class SampleLoader {
+
+public:
+
+	/**
+	 * @param numThreads
+	 *              The number of files to read at the same time. 0 uses the
+	 *              value of --io.numFiles, or the number of CPUs if that is 0
+	 *              as well.
+	 */
+	SampleLoader(unsigned int numThreads = 0);
+
+	/**
+	 * Read the given training samples. Samples without linear costs get
+	 * Hamming costs.
+	 */
+	std::vector<boost::shared_ptr<Sample> > load(const std::vector<SampleFiles>& sampleFiles);
+
+private:
+
+	// read the files of the tasks until none are left
+	void work(
+			const std::vector<boost::function<void()> >& tasks,
+			std::vector<boost::exception_ptr>&           exceptions);
+
+	// the readers of the files, parsing each file with numChunks threads
+	static void readConstraints(const std::string& filename, unsigned int numChunks, LinearConstraints& constraints);
+
+	static void readFeatures(const std::string& filename, unsigned int numChunks, Features& features);
+
+	static void readGroundTruth(const std::string& filename, unsigned int numChunks, Labeling& groundTruth);
+
+	static void readLinearCosts(const std::string& filename, unsigned int numChunks, boost::shared_ptr<LinearCostFunction>& costs);
+
+	// check that the sizes of the files of a sample agree
+	static void check(const SampleFiles& files, Sample& sample);
+
+	unsigned int _numThreads;
+
+	// the next task for work()
+	unsigned int _nextTask;
+	boost::mutex _mutex;
+};
+
+#endif // SBMRM_LOSS_IO_SAMPLE_LOADER_H__
+